@@ -755,10 +755,8 @@ void area_data::generate_blockmap() {
     bmap.n_rows =
         ceil((max_coords.y - min_coords.y) / GEOMETRY::BLOCKMAP_BLOCK_SIZE) + 1;
         
-    bmap.edges.assign(
-        bmap.n_cols, vector<vector<edge*> >(bmap.n_rows, vector<edge*>())
-    );
-    bmap.sectors.assign(
+    //Candidate sectors of each block. Only needed while generating.
+    vector<vector<unordered_set<sector*> > > block_sectors(
         bmap.n_cols, vector<unordered_set<sector*> >(
             bmap.n_rows, unordered_set<sector*>()
         )
@@ -766,7 +764,7 @@ void area_data::generate_blockmap() {
     
     
     //Now, add a list of edges to each block.
-    generate_edges_blockmap(edges);
+    generate_edges_blockmap(edges, block_sectors);
     
     
     /* If at this point, there's any block that's missing a sector,
@@ -785,40 +783,161 @@ void area_data::generate_blockmap() {
     for(size_t bx = 0; bx < bmap.n_cols; bx++) {
         for(size_t by = 0; by < bmap.n_rows; by++) {
         
-            if(!bmap.sectors[bx][by].empty()) continue;
+            if(!block_sectors[bx][by].empty()) continue;
             
             if(
                 bx == 0 || by == 0 ||
                 bx == bmap.n_cols - 1 || by == bmap.n_rows - 1
             ) {
-                bmap.sectors[bx][by].insert(nullptr);
+                block_sectors[bx][by].insert(nullptr);
                 continue;
             }
             
-            if(bmap.sectors[bx - 1][by].size() == 1) {
-                bmap.sectors[bx][by].insert(*bmap.sectors[bx - 1][by].begin());
+            if(block_sectors[bx - 1][by].size() == 1) {
+                block_sectors[bx][by].insert(
+                    *block_sectors[bx - 1][by].begin()
+                );
                 continue;
             }
-            if(bmap.sectors[bx + 1][by].size() == 1) {
-                bmap.sectors[bx][by].insert(*bmap.sectors[bx + 1][by].begin());
+            if(block_sectors[bx + 1][by].size() == 1) {
+                block_sectors[bx][by].insert(
+                    *block_sectors[bx + 1][by].begin()
+                );
                 continue;
             }
-            if(bmap.sectors[bx][by - 1].size() == 1) {
-                bmap.sectors[bx][by].insert(*bmap.sectors[bx][by - 1].begin());
+            if(block_sectors[bx][by - 1].size() == 1) {
+                block_sectors[bx][by].insert(
+                    *block_sectors[bx][by - 1].begin()
+                );
                 continue;
             }
-            if(bmap.sectors[bx][by + 1].size() == 1) {
-                bmap.sectors[bx][by].insert(*bmap.sectors[bx][by + 1].begin());
+            if(block_sectors[bx][by + 1].size() == 1) {
+                block_sectors[bx][by].insert(
+                    *block_sectors[bx][by + 1].begin()
+                );
                 continue;
             }
             
             point corner = bmap.get_top_left_corner(bx, by);
             corner += GEOMETRY::BLOCKMAP_BLOCK_SIZE * 0.5;
-            bmap.sectors[bx][by].insert(
+            block_sectors[bx][by].insert(
                 get_sector(corner, nullptr, false)
             );
         }
     }
+    
+    
+    /* Gather every sector triangle in the area, and find which triangles
+     * are beside one another. Triangles that share a side also share the
+     * side's two vertexes, so sorting the sides by their vertexes puts
+     * each pair of neighbors together.
+     */
+    vector<std::pair<std::pair<vertex*, vertex*>, size_t> > tri_sides;
+    for(size_t s = 0; s < sectors.size(); s++) {
+        sector* s_ptr = sectors[s];
+        for(size_t t = 0; t < s_ptr->triangles.size(); t++) {
+            const triangle &t_ref = s_ptr->triangles[t];
+            blockmap_triangle tri;
+            tri.sector_ptr = s_ptr;
+            tri.idx = bmap.all_triangles.size();
+            for(size_t p = 0; p < 3; p++) {
+                tri.points[p] = point(t_ref.points[p]->x, t_ref.points[p]->y);
+                vertex* v1 = t_ref.points[p];
+                vertex* v2 = t_ref.points[(p + 1) % 3];
+                if(std::less<vertex*>()(v2, v1)) std::swap(v1, v2);
+                tri_sides.push_back(
+                    std::make_pair(std::make_pair(v1, v2), tri.idx * 3 + p)
+                );
+            }
+            bmap.all_triangles.push_back(tri);
+        }
+    }
+    
+    std::sort(tri_sides.begin(), tri_sides.end());
+    bmap.triangle_neighbors.assign(bmap.all_triangles.size() * 3, INVALID);
+    for(size_t s = 0; s + 1 < tri_sides.size(); s++) {
+        if(tri_sides[s].first != tri_sides[s + 1].first) continue;
+        size_t side_1 = tri_sides[s].second;
+        size_t side_2 = tri_sides[s + 1].second;
+        bmap.triangle_neighbors[side_1] = side_2 / 3;
+        bmap.triangle_neighbors[side_2] = side_1 / 3;
+        s++;
+    }
+    
+    
+    /* Finally, flatten everything into contiguous lists. Blocks with only
+     * one sector just keep it, since any point in them belongs to it.
+     * The others get a copy of each triangle that overlaps them, so
+     * checking which sector a point is in only needs to go through a
+     * handful of triangles. The triangles are added in the area's sector
+     * order, so that points right on a boundary always give the same result.
+     * This is done in two passes: one to count how many triangles each
+     * block gets, and another to fill them in.
+     */
+    size_t nr_blocks = bmap.n_cols * bmap.n_rows;
+    bmap.block_sectors.assign(nr_blocks, nullptr);
+    bmap.triangle_starts.assign(nr_blocks + 1, 0);
+    for(size_t bx = 0; bx < bmap.n_cols; bx++) {
+        for(size_t by = 0; by < bmap.n_rows; by++) {
+            if(block_sectors[bx][by].size() == 1) {
+                bmap.block_sectors[by * bmap.n_cols + bx] =
+                    *block_sectors[bx][by].begin();
+            }
+        }
+    }
+    
+    vector<size_t> fill_positions;
+    for(unsigned char pass = 0; pass < 2; pass++) {
+        if(pass == 1) {
+            //Turn the counts into starting positions.
+            for(size_t b = 0; b < nr_blocks; b++) {
+                bmap.triangle_starts[b + 1] += bmap.triangle_starts[b];
+            }
+            bmap.triangles.resize(bmap.triangle_starts[nr_blocks]);
+            fill_positions.assign(
+                bmap.triangle_starts.begin(), bmap.triangle_starts.end() - 1
+            );
+        }
+        
+        for(size_t t = 0; t < bmap.all_triangles.size(); t++) {
+            const blockmap_triangle &tri = bmap.all_triangles[t];
+            
+            point tri_min = tri.points[0];
+            point tri_max = tri.points[0];
+            for(size_t p = 1; p < 3; p++) {
+                tri_min.x = std::min(tri_min.x, tri.points[p].x);
+                tri_min.y = std::min(tri_min.y, tri.points[p].y);
+                tri_max.x = std::max(tri_max.x, tri.points[p].x);
+                tri_max.y = std::max(tri_max.y, tri.points[p].y);
+            }
+            size_t bx1 = bmap.get_col(tri_min.x);
+            size_t bx2 = bmap.get_col(tri_max.x);
+            size_t by1 = bmap.get_row(tri_min.y);
+            size_t by2 = bmap.get_row(tri_max.y);
+            if(bx1 == INVALID) bx1 = 0;
+            if(by1 == INVALID) by1 = 0;
+            if(bx2 == INVALID) bx2 = bmap.n_cols - 1;
+            if(by2 == INVALID) by2 = bmap.n_rows - 1;
+            
+            for(size_t bx = bx1; bx <= bx2; bx++) {
+                for(size_t by = by1; by <= by2; by++) {
+                    if(block_sectors[bx][by].size() <= 1) continue;
+                    if(block_sectors[bx][by].count(tri.sector_ptr) == 0) {
+                        continue;
+                    }
+                    if(!bmap.is_triangle_in_block(tri, bx, by)) continue;
+                    
+                    size_t b = by * bmap.n_cols + bx;
+                    if(pass == 0) {
+                        bmap.triangle_starts[b + 1]++;
+                    } else {
+                        bmap.triangles[fill_positions[b]] = tri;
+                        fill_positions[b]++;
+                    }
+                }
+            }
+        }
+    }
 }
 
 
@@ -826,8 +945,16 @@ void area_data::generate_blockmap() {
  * @brief Generates the blockmap for a set of edges.
  *
  * @param edge_list Edges to generate the blockmap around.
+ * @param block_sectors The sectors of these edges are added to the
+ * candidate sectors of each block they pass through.
  */
-void area_data::generate_edges_blockmap(const vector<edge*> &edge_list) {
+void area_data::generate_edges_blockmap(
+    const vector<edge*> &edge_list,
+    vector<vector<unordered_set<sector*> > > &block_sectors
+) {
+    //Numbers of the edges in each block, stored row by row.
+    vector<vector<size_t> > block_edge_nrs(bmap.n_cols * bmap.n_rows);
+    
     for(size_t e = 0; e < edge_list.size(); e++) {
     
         //Get which blocks this edge belongs to, via bounding-box,
@@ -881,16 +1008,49 @@ void area_data::generate_edges_blockmap(const vector<edge*> &edge_list) {
                         }
                     }
                     
-                    if(add_edge) bmap.edges[bx][by].push_back(e_ptr);
+                    if(add_edge) {
+                        //An edge gets its number the first time it's added.
+                        if(
+                            bmap.edges.empty() ||
+                            bmap.edges.back() != e_ptr
+                        ) {
+                            bmap.edges.push_back(e_ptr);
+                        }
+                        block_edge_nrs[by * bmap.n_cols + bx].push_back(
+                            bmap.edges.size() - 1
+                        );
+                    }
                     
                     if(e_ptr->sectors[0] || e_ptr->sectors[1]) {
-                        bmap.sectors[bx][by].insert(e_ptr->sectors[0]);
-                        bmap.sectors[bx][by].insert(e_ptr->sectors[1]);
+                        block_sectors[bx][by].insert(e_ptr->sectors[0]);
+                        block_sectors[bx][by].insert(e_ptr->sectors[1]);
                     }
                 }
             }
         }
     }
+    
+    //Flatten the lists.
+    size_t max_block_edges = 0;
+    bmap.edge_starts.assign(block_edge_nrs.size() + 1, 0);
+    for(size_t b = 0; b < block_edge_nrs.size(); b++) {
+        bmap.edge_starts[b + 1] =
+            bmap.edge_starts[b] + block_edge_nrs[b].size();
+        bmap.edge_nrs.insert(
+            bmap.edge_nrs.end(),
+            block_edge_nrs[b].begin(), block_edge_nrs[b].end()
+        );
+        max_block_edges = std::max(max_block_edges, block_edge_nrs[b].size());
+    }
+    for(size_t e = 0; e < bmap.edge_nrs.size(); e++) {
+        const edge* e_ptr = bmap.edges[bmap.edge_nrs[e]];
+        bmap.edge_x1s.push_back(e_ptr->vertexes[0]->x);
+        bmap.edge_y1s.push_back(e_ptr->vertexes[0]->y);
+        bmap.edge_x2s.push_back(e_ptr->vertexes[1]->x);
+        bmap.edge_y2s.push_back(e_ptr->vertexes[1]->y);
+    }
+    bmap.edge_check_results.assign(max_block_edges, 0);
+    bmap.edge_query_stamps.assign(bmap.edges.size(), 0);
 }
 
 
@@ -2374,13 +2534,117 @@ void area_data::save_thumbnail(bool to_backup) {
 }
 
 
+/**
+ * @brief Adds the edges of a block to a list, skipping the ones that
+ * the current query already found.
+ *
+ * @param col Column of the block.
+ * @param row Row of the block.
+ * @param out_edges Vector to add the edges to.
+ */
+void blockmap::add_block_edges(
+    size_t col, size_t row, vector<edge*> &out_edges
+) {
+    size_t b = row * n_cols + col;
+    for(size_t e = edge_starts[b]; e < edge_starts[b + 1]; e++) {
+        size_t e_nr = edge_nrs[e];
+        if(edge_query_stamps[e_nr] == cur_edge_query_stamp) continue;
+        edge_query_stamps[e_nr] = cur_edge_query_stamp;
+        out_edges.push_back(edges[e_nr]);
+    }
+}
+
+
+/**
+ * @brief Adds the edges of a block that a line segment crosses to a list,
+ * skipping the ones that the current query already found.
+ *
+ * @param col Column of the block.
+ * @param row Row of the block.
+ * @param p1 Starting point of the line segment.
+ * @param p2 Ending point of the line segment.
+ * @param out_edges Vector to add the edges to.
+ */
+void blockmap::add_block_edges_crossing_line_seg(
+    size_t col, size_t row, const point &p1, const point &p2,
+    vector<edge*> &out_edges
+) {
+    size_t b = row * n_cols + col;
+    size_t start = edge_starts[b];
+    size_t n = edge_starts[b + 1] - start;
+    if(n == 0) return;
+    
+    line_seg_intersects_line_segs(
+        p1, p2,
+        edge_x1s.data() + start, edge_y1s.data() + start,
+        edge_x2s.data() + start, edge_y2s.data() + start,
+        n, edge_check_results.data()
+    );
+    for(size_t e = 0; e < n; e++) {
+        if(!edge_check_results[e]) continue;
+        size_t e_nr = edge_nrs[start + e];
+        if(edge_query_stamps[e_nr] == cur_edge_query_stamp) continue;
+        edge_query_stamps[e_nr] = cur_edge_query_stamp;
+        out_edges.push_back(edges[e_nr]);
+    }
+}
+
+
+/**
+ * @brief Adds the edges of a block that a circle touches to a list,
+ * skipping the ones that the current query already found.
+ *
+ * @param col Column of the block.
+ * @param row Row of the block.
+ * @param center Center of the circle.
+ * @param radius Radius of the circle.
+ * @param out_edges Vector to add the edges to.
+ */
+void blockmap::add_block_edges_touching_circle(
+    size_t col, size_t row, const point &center, float radius,
+    vector<edge*> &out_edges
+) {
+    size_t b = row * n_cols + col;
+    size_t start = edge_starts[b];
+    size_t n = edge_starts[b + 1] - start;
+    if(n == 0) return;
+    
+    circle_intersects_line_segs(
+        center, radius,
+        edge_x1s.data() + start, edge_y1s.data() + start,
+        edge_x2s.data() + start, edge_y2s.data() + start,
+        n, edge_check_results.data()
+    );
+    for(size_t e = 0; e < n; e++) {
+        if(!edge_check_results[e]) continue;
+        size_t e_nr = edge_nrs[start + e];
+        if(edge_query_stamps[e_nr] == cur_edge_query_stamp) continue;
+        edge_query_stamps[e_nr] = cur_edge_query_stamp;
+        out_edges.push_back(edges[e_nr]);
+    }
+}
+
+
 /**
  * @brief Clears the info of the blockmap.
  */
 void blockmap::clear() {
     top_left_corner = point();
     edges.clear();
-    sectors.clear();
+    edge_starts.clear();
+    edge_nrs.clear();
+    edge_x1s.clear();
+    edge_y1s.clear();
+    edge_x2s.clear();
+    edge_y2s.clear();
+    edge_check_results.clear();
+    edge_query_stamps.clear();
+    cur_edge_query_stamp = 0;
+    block_sectors.clear();
+    triangle_starts.clear();
+    triangles.clear();
+    all_triangles.clear();
+    triangle_neighbors.clear();
     n_cols = 0;
     n_rows = 0;
 }
@@ -2400,19 +2664,126 @@ size_t blockmap::get_col(float x) const {
 }
 
 
+/**
+ * @brief Obtains a list of edges that a line segment crosses.
+ * Only the blocks the segment goes through are visited, instead of every
+ * block in the segment's bounding box, which matters a lot for long
+ * diagonal lines.
+ *
+ * @param p1 Starting point of the line segment.
+ * @param p2 Ending point of the line segment.
+ * @param out_edges Vector to fill the edges into. It is cleared first.
+ * Each edge only shows up once, and the edges of the blocks closer to
+ * the starting point come first.
+ * @return Whether it succeeded.
+ */
+bool blockmap::get_edges_crossing_line_seg(
+    const point &p1, const point &p2, vector<edge*> &out_edges
+) {
+    out_edges.clear();
+    
+    size_t col = get_col(p1.x);
+    size_t row = get_row(p1.y);
+    size_t end_col = get_col(p2.x);
+    size_t end_row = get_row(p2.y);
+    
+    if(
+        col == INVALID || row == INVALID ||
+        end_col == INVALID || end_row == INVALID
+    ) {
+        //Out of bounds.
+        return false;
+    }
+    
+    start_edge_query();
+    
+    /* Walk from block to block, like in "A Fast Voxel Traversal Algorithm
+     * for Ray Tracing", by Amanatides and Woo. The "t" values are how far
+     * along the segment the next column or row boundary is, from 0 to 1.
+     * If the segment crosses both boundaries at about the same spot,
+     * the two blocks beside that corner are checked too, so rounding errors
+     * can't make the walk skip past a block the segment touches.
+     */
+    point delta = p2 - p1;
+    float corner_t_tolerance =
+        GEOMETRY::BLOCKMAP_CORNER_TOLERANCE / dist(p1, p2).to_float();
+    int step_x = delta.x > 0.0f ? 1 : delta.x < 0.0f ? -1 : 0;
+    int step_y = delta.y > 0.0f ? 1 : delta.y < 0.0f ? -1 : 0;
+    float t_max_x = FLT_MAX;
+    float t_max_y = FLT_MAX;
+    float t_delta_x = FLT_MAX;
+    float t_delta_y = FLT_MAX;
+    if(step_x != 0) {
+        float boundary_x =
+            get_top_left_corner(col + (step_x > 0 ? 1 : 0), 0).x;
+        t_max_x = (boundary_x - p1.x) / delta.x;
+        t_delta_x = GEOMETRY::BLOCKMAP_BLOCK_SIZE / fabs(delta.x);
+    }
+    if(step_y != 0) {
+        float boundary_y =
+            get_top_left_corner(0, row + (step_y > 0 ? 1 : 0)).y;
+        t_max_y = (boundary_y - p1.y) / delta.y;
+        t_delta_y = GEOMETRY::BLOCKMAP_BLOCK_SIZE / fabs(delta.y);
+    }
+    
+    while(true) {
+        add_block_edges_crossing_line_seg(col, row, p1, p2, out_edges);
+        
+        if(col == end_col && row == end_row) break;
+        if(std::min(t_max_x, t_max_y) > 1.0f) break;
+        
+        bool corner = fabs(t_max_x - t_max_y) <= corner_t_tolerance;
+        bool next_is_col = t_max_x <= t_max_y;
+        size_t next_col = col;
+        size_t next_row = row;
+        if(next_is_col || corner) {
+            next_col += step_x;
+            t_max_x += t_delta_x;
+        }
+        if(!next_is_col || corner) {
+            next_row += step_y;
+            t_max_y += t_delta_y;
+        }
+        if(next_col >= n_cols || next_row >= n_rows) break;
+        
+        if(corner) {
+            add_block_edges_crossing_line_seg(
+                next_col, row, p1, p2, out_edges
+            );
+            add_block_edges_crossing_line_seg(
+                col, next_row, p1, p2, out_edges
+            );
+        }
+        col = next_col;
+        row = next_row;
+    }
+    
+    //Rounding errors could've stopped the walk a bit early.
+    add_block_edges_crossing_line_seg(
+        end_col, end_row, p1, p2, out_edges
+    );
+    
+    return true;
+}
+
+
 /**
  * @brief Obtains a list of edges that are within the specified
  * rectangular region.
  *
  * @param tl Top-left coordinates of the region.
  * @param br Bottom-right coordinates of the region.
- * @param out_edges Set to fill the edges into.
+ * @param out_edges Vector to fill the edges into. It is cleared first.
+ * Each edge only shows up once. Reusing the same vector across calls
+ * avoids allocating memory.
  * @return Whether it succeeded.
  */
 bool blockmap::get_edges_in_region(
-    const point &tl, const point &br, set<edge*> &out_edges
-) const {
+    const point &tl, const point &br, vector<edge*> &out_edges
+) {
 
+    out_edges.clear();
+    
     size_t bx1 = get_col(tl.x);
     size_t bx2 = get_col(br.x);
     size_t by1 = get_row(tl.y);
@@ -2426,14 +2797,52 @@ bool blockmap::get_edges_in_region(
         return false;
     }
     
-    for(size_t bx = bx1; bx <= bx2; bx++) {
-        for(size_t by = by1; by <= by2; by++) {
-        
-            const vector<edge*> &block_edges = edges[bx][by];
-            
-            for(size_t e = 0; e < block_edges.size(); e++) {
-                out_edges.insert(block_edges[e]);
-            }
+    start_edge_query();
+    
+    for(size_t by = by1; by <= by2; by++) {
+        for(size_t bx = bx1; bx <= bx2; bx++) {
+            add_block_edges(bx, by, out_edges);
+        }
+    }
+    
+    return true;
+}
+
+
+/**
+ * @brief Obtains a list of edges that a circle touches.
+ *
+ * @param center Center of the circle.
+ * @param radius Radius of the circle.
+ * @param out_edges Vector to fill the edges into. It is cleared first.
+ * Each edge only shows up once. Reusing the same vector across calls
+ * avoids allocating memory.
+ * @return Whether it succeeded.
+ */
+bool blockmap::get_edges_touching_circle(
+    const point &center, float radius, vector<edge*> &out_edges
+) {
+
+    out_edges.clear();
+    
+    size_t bx1 = get_col(center.x - radius);
+    size_t bx2 = get_col(center.x + radius);
+    size_t by1 = get_row(center.y - radius);
+    size_t by2 = get_row(center.y + radius);
+    
+    if(
+        bx1 == INVALID || bx2 == INVALID ||
+        by1 == INVALID || by2 == INVALID
+    ) {
+        //Out of bounds.
+        return false;
+    }
+    
+    start_edge_query();
+    
+    for(size_t by = by1; by <= by2; by++) {
+        for(size_t bx = bx1; bx <= bx2; bx++) {
+            add_block_edges_touching_circle(bx, by, center, radius, out_edges);
         }
     }
     
@@ -2455,6 +2864,57 @@ size_t blockmap::get_row(float y) const {
 }
 
 
+/**
+ * @brief Returns which sector the specified point belongs to.
+ *
+ * @param p Coordinates of the point.
+ * @param triangle_idx If not nullptr, this should hold the index of the
+ * triangle (in the list of all triangles) where the point was last found,
+ * or INVALID. Things usually don't move much between checks, so that
+ * triangle and the ones beside it are checked first.
+ * The index of the triangle the point is in is returned here, if known.
+ * @return The sector, or nullptr if none.
+ */
+sector* blockmap::get_sector(const point &p, size_t* triangle_idx) const {
+    if(triangle_idx && *triangle_idx < all_triangles.size()) {
+        size_t last_idx = *triangle_idx;
+        if(all_triangles[last_idx].is_point_inside(p)) {
+            return all_triangles[last_idx].sector_ptr;
+        }
+        for(size_t n = 0; n < 3; n++) {
+            size_t n_idx = triangle_neighbors[last_idx * 3 + n];
+            if(n_idx == INVALID) continue;
+            if(all_triangles[n_idx].is_point_inside(p)) {
+                *triangle_idx = n_idx;
+                return all_triangles[n_idx].sector_ptr;
+            }
+        }
+    }
+    
+    size_t col = get_col(p.x);
+    size_t row = get_row(p.y);
+    if(triangle_idx) *triangle_idx = INVALID;
+    if(col == INVALID || row == INVALID) return nullptr;
+    
+    size_t b = row * n_cols + col;
+    size_t t_end = triangle_starts[b + 1];
+    if(triangle_starts[b] == t_end) {
+        //No need to remember a triangle, since this is just as fast.
+        return block_sectors[b];
+    }
+    
+    for(size_t t = triangle_starts[b]; t < t_end; t++) {
+        const blockmap_triangle &tri = triangles[t];
+        if(tri.is_point_inside(p)) {
+            if(triangle_idx) *triangle_idx = tri.idx;
+            return tri.sector_ptr;
+        }
+    }
+    
+    return nullptr;
+}
+
+
 /**
  * @brief Returns the top-left coordinates for the specified column and row.
  *
@@ -2471,6 +2931,67 @@ point blockmap::get_top_left_corner(size_t col, size_t row) const {
 }
 
 
+/**
+ * @brief Returns whether a triangle overlaps with a block, even if only
+ * barely.
+ *
+ * @param tri Triangle to check.
+ * @param col Column of the block.
+ * @param row Row of the block.
+ * @return Whether it overlaps.
+ */
+bool blockmap::is_triangle_in_block(
+    const blockmap_triangle &tri, size_t col, size_t row
+) const {
+    //Pad the block a bit, so that rounding errors don't leave out
+    //triangles that only touch it.
+    point tl = get_top_left_corner(col, row) - 1.0f;
+    point br = tl + (GEOMETRY::BLOCKMAP_BLOCK_SIZE + 2.0f);
+    
+    for(size_t p = 0; p < 3; p++) {
+        if(
+            line_seg_intersects_rectangle(
+                tl, br, tri.points[p], tri.points[(p + 1) % 3]
+            )
+        ) {
+            return true;
+        }
+    }
+    
+    //No side goes through the block, but the block could be entirely
+    //inside the triangle.
+    return
+        is_point_in_triangle(
+            tl, tri.points[0], tri.points[1], tri.points[2], true
+        );
+}
+
+
+/**
+ * @brief Starts a new edge query, so that edges found by previous queries
+ * no longer count as found.
+ */
+void blockmap::start_edge_query() {
+    cur_edge_query_stamp++;
+    if(cur_edge_query_stamp == 0) {
+        //Wrapped around. Older stamps could now match, so reset them all.
+        edge_query_stamps.assign(edge_query_stamps.size(), 0);
+        cur_edge_query_stamp = 1;
+    }
+}
+
+
+/**
+ * @brief Returns whether a point is inside the triangle.
+ *
+ * @param p Point to check.
+ * @return Whether it's inside.
+ */
+bool blockmap_triangle::is_point_inside(const point &p) const {
+    return is_point_in_triangle(p, points[0], points[1], points[2], false);
+}
+
+
 /**
  * @brief Constructs a new mob generator object.
  *
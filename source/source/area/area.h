@@ -43,6 +43,32 @@ extern const unsigned char DEF_DIFFICULTY;
 };
 
 
+/**
+ * @brief A sector triangle, as stored in a blockmap block. The coordinates
+ * are copied over, so checking if a point is inside doesn't need to
+ * go through the vertexes.
+ */
+struct blockmap_triangle {
+
+    //--- Members ---
+    
+    //Coordinates of the three points.
+    point points[3];
+    
+    //Sector it belongs to.
+    sector* sector_ptr = nullptr;
+    
+    //Index in the blockmap's list of all triangles.
+    size_t idx = INVALID;
+    
+    
+    //--- Function declarations ---
+    
+    bool is_point_inside(const point &p) const;
+    
+};
+
+
 /**
  * @brief Info about dividing the area in a grid.
  *
@@ -61,11 +87,59 @@ struct blockmap {
     //Top-left corner of the blockmap.
     point top_left_corner;
     
-    //Specifies a list of edges in each block.
-    vector<vector<vector<edge*> > > edges;
+    //Every edge in the blockmap, by number.
+    vector<edge*> edges;
+    
+    //Where each block's edges start in the list of edge numbers. A block's
+    //edges end where the next one's start. Blocks are stored row by row.
+    vector<size_t> edge_starts;
+    
+    //Numbers of the edges in each block, one block after the other.
+    vector<size_t> edge_nrs;
+    
+    //Starting X coordinate of each edge in the list of edge numbers.
+    //Each coordinate gets its own list, so that several edges
+    //can be checked at once.
+    vector<float> edge_x1s;
+    
+    //Starting Y coordinate of each edge in the list of edge numbers.
+    vector<float> edge_y1s;
+    
+    //Ending X coordinate of each edge in the list of edge numbers.
+    vector<float> edge_x2s;
     
-    //Specifies a list of sectors in each block.
-    vector<vector<unordered_set<sector*> > >  sectors;
+    //Ending Y coordinate of each edge in the list of edge numbers.
+    vector<float> edge_y2s;
+    
+    //Results of checking the edges of one block. Cache for performance.
+    vector<unsigned char> edge_check_results;
+    
+    //For each edge, the number of the last query that found it.
+    //This way, a query can skip edges it already found in another block
+    //without needing a set.
+    vector<size_t> edge_query_stamps;
+    
+    //Number of the current edge query.
+    size_t cur_edge_query_stamp = 0;
+    
+    //Sector of each block, if the whole block belongs to the same one,
+    //or to none. Blocks are stored row by row.
+    vector<sector*> block_sectors;
+    
+    //Where each block's triangles start in the list of triangles. A block's
+    //triangles end where the next one's start. Blocks are stored row by row.
+    vector<size_t> triangle_starts;
+    
+    //Triangles that overlap each block with more than one sector.
+    vector<blockmap_triangle> triangles;
+    
+    //Every sector triangle in the area.
+    vector<blockmap_triangle> all_triangles;
+    
+    //For each triangle in the list of all triangles, the indexes of the
+    //triangles beside each of its three sides, or INVALID if none.
+    //The side of each point goes from it to the next point.
+    vector<size_t> triangle_neighbors;
     
     //Number of columns.
     size_t n_cols = 0;
@@ -78,12 +152,37 @@ struct blockmap {
     
     size_t get_col(float x) const;
     size_t get_row(float y) const;
+    bool get_edges_crossing_line_seg(
+        const point &p1, const point &p2, vector<edge*> &out_edges
+    );
     bool get_edges_in_region(
-        const point &tl, const point &br, set<edge*> &edges
-    ) const;
+        const point &tl, const point &br, vector<edge*> &out_edges
+    );
+    bool get_edges_touching_circle(
+        const point &center, float radius, vector<edge*> &out_edges
+    );
     point get_top_left_corner(size_t col, size_t row) const;
+    sector* get_sector(const point &p, size_t* triangle_idx = nullptr) const;
+    bool is_triangle_in_block(
+        const blockmap_triangle &tri, size_t col, size_t row
+    ) const;
     void clear();
     
+    private:
+    
+    //--- Function declarations ---
+    
+    void add_block_edges(size_t col, size_t row, vector<edge*> &out_edges);
+    void add_block_edges_crossing_line_seg(
+        size_t col, size_t row, const point &p1, const point &p2,
+        vector<edge*> &out_edges
+    );
+    void add_block_edges_touching_circle(
+        size_t col, size_t row, const point &center, float radius,
+        vector<edge*> &out_edges
+    );
+    void start_edge_query();
+    
 };
 
 
@@ -281,7 +380,10 @@ struct area_data : public content {
     void fix_vertex_idxs(vertex* v_ptr);
     void fix_vertex_pointers(vertex* v_ptr);
     void generate_blockmap();
-    void generate_edges_blockmap(const vector<edge*> &edges);
+    void generate_edges_blockmap(
+        const vector<edge*> &edges,
+        vector<vector<unordered_set<sector*> > > &block_sectors
+    );
     size_t get_nr_path_links();
     void load_main_data_from_data_node(
         data_node* node, CONTENT_LOAD_LEVEL level
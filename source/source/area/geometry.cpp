@@ -35,6 +35,10 @@ const float AREA_CELL_SIZE = 128;
 //Area blockmap blocks have this width and height.
 const float BLOCKMAP_BLOCK_SIZE = 128;
 
+//A line that passes this close to a blockmap block's corner also
+//checks the blocks beside the corner, to be safe from rounding errors.
+const float BLOCKMAP_CORNER_TOLERANCE = 0.01f;
+
 //Default sector brightness.
 const unsigned char DEF_SECTOR_BRIGHTNESS = 255;
 
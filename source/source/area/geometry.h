@@ -32,6 +32,7 @@ struct vertex;
 namespace GEOMETRY {
 extern const float AREA_CELL_SIZE;
 extern const float BLOCKMAP_BLOCK_SIZE;
+extern const float BLOCKMAP_CORNER_TOLERANCE;
 extern const unsigned char DEF_SECTOR_BRIGHTNESS;
 extern const float STEP_HEIGHT;
 extern const float LIQUID_DRAIN_DURATION;
@@ -313,26 +313,7 @@ sector* get_sector(
 
     if(use_blockmap) {
     
-        size_t col = game.cur_area_data->bmap.get_col(p.x);
-        size_t row = game.cur_area_data->bmap.get_row(p.y);
-        if(col == INVALID || row == INVALID) return nullptr;
-        
-        unordered_set<sector*>* sectors =
-            &game.cur_area_data->bmap.sectors[col][row];
-            
-        if(sectors->size() == 1) return *sectors->begin();
-        
-        for(auto &s : (*sectors)) {
-        
-            if(!s) {
-                continue;
-            }
-            if(s->is_point_in_sector(p)) {
-                return s;
-            }
-        }
-        
-        return nullptr;
+        return game.cur_area_data->bmap.get_sector(p);
         
     } else {
     
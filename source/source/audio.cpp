@@ -9,6 +9,7 @@
  */
 
 #include <algorithm>
+#include <ctime>
 
 #include "audio.h"
 
@@ -201,13 +202,13 @@ size_t audio_manager::create_world_pos_sound_source(
  * @brief Destroys the audio manager.
  */
 void audio_manager::destroy() {
-    al_detach_voice(voice);
+    if(voice) al_detach_voice(voice);
     al_destroy_mixer(world_sound_mixer);
     al_destroy_mixer(music_mixer);
     al_destroy_mixer(world_ambiance_sound_mixer);
     al_destroy_mixer(ui_sound_mixer);
     al_destroy_mixer(master_mixer);
-    al_destroy_voice(voice);
+    if(voice) al_destroy_voice(voice);
 }
 
 
@@ -351,7 +352,8 @@ bool audio_manager::emit(size_t source_id) {
         playback_ptr->base_gain +=
             randomf(
                 -source_ptr->config.gain_deviation,
-                source_ptr->config.gain_deviation
+                source_ptr->config.gain_deviation,
+                &rng_state
             );
         playback_ptr->base_gain =
             clamp(playback_ptr->base_gain, 0.0f, 1.0f);
@@ -392,7 +394,8 @@ bool audio_manager::emit(size_t source_id) {
         speed +=
             randomf(
                 -source_ptr->config.speed_deviation,
-                source_ptr->config.speed_deviation
+                source_ptr->config.speed_deviation,
+                &rng_state
             );
     }
     speed = std::max(0.0f, speed);
@@ -548,6 +551,8 @@ void audio_manager::init(
     float master_volume, float world_sound_volume, float music_volume,
     float ambiance_volume, float ui_sound_volume
 ) {
+    rng_state = (uint32_t) time(nullptr);
+    
     //Main voice.
     voice =
         al_create_voice(
@@ -559,7 +564,9 @@ void audio_manager::init(
         al_create_mixer(
             44100, ALLEGRO_AUDIO_DEPTH_FLOAT32, ALLEGRO_CHANNEL_CONF_2
         );
-    al_attach_mixer_to_voice(master_mixer, voice);
+    if(voice) {
+        al_attach_mixer_to_voice(master_mixer, voice);
+    }
     
     //World sound effects mixer.
     world_sound_mixer =
@@ -652,7 +659,7 @@ bool audio_manager::schedule_emission(size_t source_id, bool first) {
     source_ptr->emit_time_left = first ? 0.0f : source_ptr->config.interval;
     if(first || source_ptr->config.interval > 0.0f) {
         source_ptr->emit_time_left +=
-            randomf(0, source_ptr->config.random_delay);
+            randomf(0, source_ptr->config.random_delay, &rng_state);
     }
     
     return true;
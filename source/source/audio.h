@@ -442,6 +442,10 @@ private:
     //Bottom-right camera coordinates.
     point cam_br;
     
+    //State of the random number generator used for sound variations.
+    //Gameplay has its own, so that sounds don't change the simulation.
+    uint32_t rng_state = 1;
+    
     
     //--- Function declarations ---
     
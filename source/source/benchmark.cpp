@@ -0,0 +1,500 @@
+/*
+ * Copyright (c) Andre 'Espyo' Silva 2013.
+ * The following source file belongs to the open-source project Pikifen.
+ * Please read the included README and LICENSE files for more information.
+ * Pikmin is copyright (c) Nintendo.
+ *
+ * === FILE DESCRIPTION ===
+ * Benchmark suite class and related functions.
+ */
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "benchmark.h"
+
+#include "functions.h"
+#include "game.h"
+#include "mobs/mob_utils.h"
+#include "pathing.h"
+#include "utils/math_utils.h"
+#include "utils/string_utils.h"
+
+
+namespace BENCHMARK {
+
+//How many enemies the enemy horde scenario adds.
+const size_t ENEMY_HORDE_AMOUNT = 300;
+
+//How many frames each area scenario runs for.
+const size_t NR_FRAMES = 600;
+
+//Maximum number of particles in the particle storm scenario.
+const size_t PARTICLE_STORM_MAX_PARTICLES = 10000;
+
+//How many path queries the path scenario makes.
+const size_t PATH_QUERIES_AMOUNT = 2000;
+
+//How many Pikmin the Pikmin swarm scenario adds.
+const size_t PIKMIN_SWARM_AMOUNT = 1000;
+
+//Seed for the random number generator, so every run is the same.
+const unsigned int RANDOM_SEED = 1;
+
+//How many sectors wide and tall the dense sector scenario's grid is.
+const size_t SECTOR_GRID_SIZE = 100;
+
+//Width and height of each sector in the dense sector scenario's grid.
+const float SECTOR_GRID_CELL_SIZE = 64.0f;
+
+//How many point queries the dense sector scenario makes.
+const size_t SECTOR_QUERIES_AMOUNT = 100000;
+
+//Objects are added this far away from the leader, at most.
+const float SPAWN_RADIUS = 400.0f;
+
+//How many random spots to try when looking for where to add an object.
+const size_t SPAWN_TRIES = 10;
+
+}
+
+
+/**
+ * @brief Adds a horde of enemies around the current leader,
+ * using every enemy type in turn.
+ */
+void benchmark_suite::add_enemy_horde() {
+    auto &enemy_types = game.content.mob_types.list.enemy;
+    if(enemy_types.empty()) return;
+    
+    point center =
+        game.states.gameplay->cur_leader_ptr ?
+        game.states.gameplay->cur_leader_ptr->pos :
+        game.cam.pos;
+    auto type_it = enemy_types.begin();
+    
+    for(size_t e = 0; e < BENCHMARK::ENEMY_HORDE_AMOUNT; e++) {
+        create_mob(
+            game.mob_categories.get(MOB_CATEGORY_ENEMIES),
+            get_spawn_point(center), type_it->second,
+            randomf(0, TAU), ""
+        );
+        ++type_it;
+        if(type_it == enemy_types.end()) type_it = enemy_types.begin();
+    }
+}
+
+
+/**
+ * @brief Adds a swarm of flowered Pikmin around the current leader,
+ * using every Pikmin type in turn, and has them all join the leader's group.
+ */
+void benchmark_suite::add_pikmin_swarm() {
+    auto &pikmin_types = game.content.mob_types.list.pikmin;
+    if(pikmin_types.empty()) return;
+    
+    leader* leader_ptr = game.states.gameplay->cur_leader_ptr;
+    point center = leader_ptr ? leader_ptr->pos : game.cam.pos;
+    auto type_it = pikmin_types.begin();
+    
+    for(size_t p = 0; p < BENCHMARK::PIKMIN_SWARM_AMOUNT; p++) {
+        mob* new_pikmin =
+            create_mob(
+                game.mob_categories.get(MOB_CATEGORY_PIKMIN),
+                get_spawn_point(center), type_it->second,
+                randomf(0, TAU), "maturity=2"
+            );
+        if(leader_ptr) {
+            new_pikmin->fsm.run_event(MOB_EV_WHISTLED, (void*) leader_ptr);
+        }
+        ++type_it;
+        if(type_it == pikmin_types.end()) type_it = pikmin_types.begin();
+    }
+}
+
+
+/**
+ * @brief Returns a random spot near the given center that has a sector
+ * under it. If none can be found, the center is returned.
+ *
+ * @param center Center of the area to pick the spot from.
+ * @return The spot.
+ */
+point benchmark_suite::get_spawn_point(const point &center) const {
+    for(size_t t = 0; t < BENCHMARK::SPAWN_TRIES; t++) {
+        point p =
+            center +
+            angle_to_coordinates(
+                randomf(0, TAU), randomf(0, BENCHMARK::SPAWN_RADIUS)
+            );
+        if(get_sector(p, nullptr, true)) return p;
+    }
+    return center;
+}
+
+
+/**
+ * @brief Runs every scenario and saves the results.
+ *
+ * @param area_path Path to the area most scenarios are built on.
+ * This is the same as the one used by the "play" auto-start maker tool.
+ * @param output_path Path to the file to save the results to.
+ * @return 0 if everything went well, or an error number otherwise.
+ */
+int benchmark_suite::run(const string &area_path, const string &output_path) {
+    this->area_path = area_path;
+    results.clear();
+    
+    run_sector_scenario();
+    
+    if(!run_area_scenario("baseline", nullptr)) {
+        std::cout <<
+                  "Could not load the area \"" << area_path << "\"!" <<
+                  std::endl;
+        return 1;
+    }
+    run_path_scenario();
+    
+    run_area_scenario(
+        "pikmin_swarm", [this] () { add_pikmin_swarm(); }
+    );
+    run_area_scenario(
+        "enemy_horde", [this] () { add_enemy_horde(); }
+    );
+    run_area_scenario(
+        "particle_storm",
+    [] () {
+        game.states.gameplay->particles =
+            particle_manager(BENCHMARK::PARTICLE_STORM_MAX_PARTICLES);
+    },
+    [this] () {
+        for(auto &g : game.content.custom_particle_gen.list) {
+            particle_generator gen_copy = g.second;
+            gen_copy.base_particle.pos = get_spawn_point(game.cam.pos);
+            gen_copy.emit(game.states.gameplay->particles);
+        }
+    }
+    );
+    game.states.gameplay->particles =
+        particle_manager(game.options.max_particles);
+        
+    for(size_t r = 0; r < results.size(); r++) {
+        std::cout <<
+                  results[r].name << ": " <<
+                  results[r].nr_iterations << " iterations, " <<
+                  f2s(results[r].avg_iteration_time * 1000.0) <<
+                  "ms average." << std::endl;
+    }
+    
+    if(!save_results(output_path)) {
+        std::cout <<
+                  "Could not save the results to \"" << output_path << "\"!" <<
+                  std::endl;
+        return 1;
+    }
+    std::cout << "Results saved to \"" << output_path << "\"." << std::endl;
+    
+    return 0;
+}
+
+
+/**
+ * @brief Loads the area into gameplay, prepares the scenario, and runs
+ * a fixed number of frames. The timings come from the performance monitor,
+ * so the same parts of the frame as in its log are reported.
+ *
+ * @param name Name of the scenario.
+ * @param setup Code to run after the area loads, if any.
+ * @param frame_setup Code to run before every frame, if any.
+ * @return Whether the area could be loaded.
+ */
+bool benchmark_suite::run_area_scenario(
+    const string &name, const std::function<void()> &setup,
+    const std::function<void()> &frame_setup
+) {
+    srand(BENCHMARK::RANDOM_SEED);
+    
+    if(
+        game.cur_area_data &&
+        game.get_cur_state_name() != game.states.gameplay->get_name()
+    ) {
+        //The previous scenario ended up in another state, like the
+        //results menu, but the area it played is still loaded.
+        game.unload_loaded_state(game.states.gameplay);
+    }
+    
+    game.states.gameplay->path_of_area_to_load = area_path;
+    game.change_state(game.states.gameplay);
+    if(game.get_cur_state_name() != game.states.gameplay->get_name()) {
+        return false;
+    }
+    
+    if(setup) setup();
+    
+    benchmark_result_t result;
+    result.name = name;
+    
+    double start_time = al_get_time();
+    while(result.nr_iterations < BENCHMARK::NR_FRAMES) {
+        if(frame_setup) frame_setup();
+        result.nr_iterations++;
+        if(!game.do_headless_frame()) break;
+    }
+    result.total_time = al_get_time() - start_time;
+    
+    result.nr_objects = game.states.gameplay->mobs.all.size();
+    game.perf_mon->get_results(
+        PERF_MON_STATE_FRAME,
+        &result.avg_iteration_time, &result.measurements
+    );
+    
+    results.push_back(result);
+    return true;
+}
+
+
+/**
+ * @brief Finds paths between random pairs of path stops in the
+ * currently loaded area.
+ */
+void benchmark_suite::run_path_scenario() {
+    srand(BENCHMARK::RANDOM_SEED);
+    
+    benchmark_result_t result;
+    result.name = "path_queries";
+    
+    vector<path_stop*> &stops = game.cur_area_data->path_stops;
+    if(!stops.empty()) {
+        path_follow_settings settings;
+        vector<path_stop*> full_path;
+        float total_dist;
+        path_stop* start_stop;
+        path_stop* end_stop;
+        
+        double start_time = al_get_time();
+        for(size_t q = 0; q < BENCHMARK::PATH_QUERIES_AMOUNT; q++) {
+            path_stop* start = stops[randomi(0, (int) stops.size() - 1)];
+            path_stop* end = stops[randomi(0, (int) stops.size() - 1)];
+            full_path.clear();
+            get_path(
+                start->pos, end->pos, settings,
+                full_path, &total_dist, &start_stop, &end_stop
+            );
+        }
+        result.total_time = al_get_time() - start_time;
+        result.nr_iterations = BENCHMARK::PATH_QUERIES_AMOUNT;
+        result.avg_iteration_time =
+            result.total_time / result.nr_iterations;
+        result.measurements.push_back(
+            std::make_pair("Paths -- Queries", result.avg_iteration_time)
+        );
+    }
+    
+    result.nr_objects = stops.size();
+    results.push_back(result);
+}
+
+
+/**
+ * @brief Builds a synthetic area made of a big grid of square sectors,
+ * and measures how long its geometry takes to load, as well as how long
+ * it takes to find the sector under random points.
+ *
+ * Gameplay can only load areas from the disk, so this area is only
+ * loaded on its own, outside of gameplay.
+ */
+void benchmark_suite::run_sector_scenario() {
+    srand(BENCHMARK::RANDOM_SEED);
+    
+    const size_t grid_size = BENCHMARK::SECTOR_GRID_SIZE;
+    const float cell_size = BENCHMARK::SECTOR_GRID_CELL_SIZE;
+    const int void_idx = -1;
+    
+    //Any texture will do.
+    string texture_name;
+    for(auto &b : game.content.bitmaps.manifests) {
+        if(str_peek(b.first, 0, "textures/")) {
+            texture_name = b.first;
+            break;
+        }
+    }
+    
+    auto vertex_idx = [grid_size] (size_t x, size_t y) {
+        return (int) (y * (grid_size + 1) + x);
+    };
+    auto sector_idx = [grid_size] (size_t x, size_t y) {
+        return (int) (y * grid_size + x);
+    };
+    
+    //Vertexes.
+    data_node geometry_node("", "");
+    data_node* vertexes_node = new data_node("vertexes", "");
+    geometry_node.add(vertexes_node);
+    for(size_t y = 0; y <= grid_size; y++) {
+        for(size_t x = 0; x <= grid_size; x++) {
+            vertexes_node->add(
+                new data_node(
+                    "v", f2s(x * cell_size) + " " + f2s(y * cell_size)
+                )
+            );
+        }
+    }
+    
+    //Edges. First the horizontal ones, then the vertical ones.
+    data_node* edges_node = new data_node("edges", "");
+    geometry_node.add(edges_node);
+    for(size_t y = 0; y <= grid_size; y++) {
+        for(size_t x = 0; x < grid_size; x++) {
+            data_node* edge_node = new data_node("e", "");
+            edge_node->add(
+                new data_node(
+                    "s",
+                    i2s(y > 0 ? sector_idx(x, y - 1) : void_idx) + " " +
+                    i2s(y < grid_size ? sector_idx(x, y) : void_idx)
+                )
+            );
+            edge_node->add(
+                new data_node(
+                    "v",
+                    i2s(vertex_idx(x, y)) + " " + i2s(vertex_idx(x + 1, y))
+                )
+            );
+            edges_node->add(edge_node);
+        }
+    }
+    for(size_t y = 0; y < grid_size; y++) {
+        for(size_t x = 0; x <= grid_size; x++) {
+            data_node* edge_node = new data_node("e", "");
+            edge_node->add(
+                new data_node(
+                    "s",
+                    i2s(x > 0 ? sector_idx(x - 1, y) : void_idx) + " " +
+                    i2s(x < grid_size ? sector_idx(x, y) : void_idx)
+                )
+            );
+            edge_node->add(
+                new data_node(
+                    "v",
+                    i2s(vertex_idx(x, y)) + " " + i2s(vertex_idx(x, y + 1))
+                )
+            );
+            edges_node->add(edge_node);
+        }
+    }
+    
+    //Sectors. Give them a few different heights, so that there are
+    //walls between them, like in a real area.
+    data_node* sectors_node = new data_node("sectors", "");
+    geometry_node.add(sectors_node);
+    for(size_t y = 0; y < grid_size; y++) {
+        for(size_t x = 0; x < grid_size; x++) {
+            data_node* sector_node = new data_node("s", "");
+            sector_node->add(new data_node("z", i2s(((x + y) % 4) * 16)));
+            sector_node->add(new data_node("texture", texture_name));
+            sectors_node->add(sector_node);
+        }
+    }
+    
+    //Load it.
+    game.cur_area_data = new area_data();
+    game.perf_mon->reset();
+    game.perf_mon->enter_state(PERF_MON_STATE_LOADING);
+    game.perf_mon->set_paused(false);
+    double load_start_time = al_get_time();
+    
+    game.cur_area_data->load_geometry_from_data_node(
+        &geometry_node, CONTENT_LOAD_LEVEL_FULL
+    );
+    
+    benchmark_result_t load_result;
+    load_result.name = "dense_sectors_load";
+    load_result.total_time = al_get_time() - load_start_time;
+    load_result.nr_iterations = 1;
+    load_result.nr_objects = game.cur_area_data->sectors.size();
+    game.perf_mon->leave_state();
+    double unused_duration;
+    game.perf_mon->get_results(
+        PERF_MON_STATE_LOADING, &unused_duration, &load_result.measurements
+    );
+    load_result.avg_iteration_time = load_result.total_time;
+    results.push_back(load_result);
+    
+    //Query it.
+    benchmark_result_t query_result;
+    query_result.name = "dense_sectors_queries";
+    query_result.nr_objects = game.cur_area_data->sectors.size();
+    double query_start_time = al_get_time();
+    
+    for(size_t q = 0; q < BENCHMARK::SECTOR_QUERIES_AMOUNT; q++) {
+        point p(
+            randomf(0, grid_size * cell_size),
+            randomf(0, grid_size * cell_size)
+        );
+        get_sector(p, nullptr, true);
+    }
+    
+    query_result.total_time = al_get_time() - query_start_time;
+    query_result.nr_iterations = BENCHMARK::SECTOR_QUERIES_AMOUNT;
+    query_result.avg_iteration_time =
+        query_result.total_time / query_result.nr_iterations;
+    query_result.measurements.push_back(
+        std::make_pair(
+            "Sectors -- Point queries", query_result.avg_iteration_time
+        )
+    );
+    results.push_back(query_result);
+    
+    game.content.unload_current_area(CONTENT_LOAD_LEVEL_FULL);
+}
+
+
+/**
+ * @brief Saves the results of the scenarios to a JSON file.
+ *
+ * @param output_path Path to the file to save to.
+ * @return Whether it succeeded.
+ */
+bool benchmark_suite::save_results(const string &output_path) const {
+    string s =
+        "{\n"
+        "  \"engine_version\": " +
+        to_json_string(get_engine_version_string()) + ",\n"
+        "  \"game_version\": " +
+        to_json_string(game.config.version) + ",\n"
+        "  \"area\": " + to_json_string(area_path) + ",\n"
+        "  \"scenarios\": [";
+        
+    for(size_t r = 0; r < results.size(); r++) {
+        const benchmark_result_t &res = results[r];
+        s +=
+            string(r == 0 ? "" : ",") + "\n"
+            "    {\n"
+            "      \"name\": " + to_json_string(res.name) + ",\n"
+            "      \"iterations\": " + i2s(res.nr_iterations) + ",\n"
+            "      \"objects\": " + i2s(res.nr_objects) + ",\n"
+            "      \"total_time\": " +
+            to_json_number(res.total_time) + ",\n"
+            "      \"avg_iteration_time\": " +
+            to_json_number(res.avg_iteration_time) + ",\n"
+            "      \"measurements\": {";
+        for(size_t m = 0; m < res.measurements.size(); m++) {
+            s +=
+                string(m == 0 ? "" : ",") + "\n"
+                "        " + to_json_string(res.measurements[m].first) +
+                ": " + to_json_number(res.measurements[m].second);
+        }
+        s +=
+            string(res.measurements.empty() ? "" : "\n      ") + "}\n"
+            "    }";
+    }
+    
+    s += "\n  ]\n}\n";
+    
+    ALLEGRO_FILE* file = al_fopen(output_path.c_str(), "w");
+    if(!file) return false;
+    al_fwrite(file, s);
+    al_fclose(file);
+    return true;
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) Andre 'Espyo' Silva 2013.
+ * The following source file belongs to the open-source project Pikifen.
+ * Please read the included README and LICENSE files for more information.
+ * Pikmin is copyright (c) Nintendo.
+ *
+ * === FILE DESCRIPTION ===
+ * Header for the benchmark suite class and related functions.
+ */
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "utils/geometry_utils.h"
+
+
+using std::size_t;
+using std::string;
+using std::vector;
+
+
+namespace BENCHMARK {
+extern const size_t ENEMY_HORDE_AMOUNT;
+extern const size_t NR_FRAMES;
+extern const size_t PARTICLE_STORM_MAX_PARTICLES;
+extern const size_t PATH_QUERIES_AMOUNT;
+extern const size_t PIKMIN_SWARM_AMOUNT;
+extern const unsigned int RANDOM_SEED;
+extern const size_t SECTOR_GRID_SIZE;
+extern const float SECTOR_GRID_CELL_SIZE;
+extern const size_t SECTOR_QUERIES_AMOUNT;
+extern const float SPAWN_RADIUS;
+extern const size_t SPAWN_TRIES;
+}
+
+
+/**
+ * @brief Results of one of the benchmark suite's scenarios.
+ */
+struct benchmark_result_t {
+
+    //--- Members ---
+    
+    //Name of the scenario.
+    string name;
+    
+    //How many times the scenario's work was repeated. Frames, queries, etc.
+    size_t nr_iterations = 0;
+    
+    //Number of objects in the area at the end, if any.
+    size_t nr_objects = 0;
+    
+    //Total time taken, in seconds.
+    double total_time = 0.0;
+    
+    //Average time each iteration took, in seconds.
+    double avg_iteration_time = 0.0;
+    
+    //Name of each measured part of an iteration, and the average time
+    //it took, in seconds.
+    vector<std::pair<string, double> > measurements;
+    
+};
+
+
+/**
+ * @brief Runs a series of synthetic stress scenarios without a display,
+ * and saves how long each one took to a machine-readable file. This way,
+ * the performance of the heaviest parts of the engine can be tracked
+ * over time.
+ *
+ * Most scenarios take an existing area and pile things on top of it,
+ * like a huge Pikmin group or a horde of enemies.
+ */
+class benchmark_suite {
+
+public:
+
+    //--- Function declarations ---
+    
+    int run(const string &area_path, const string &output_path);
+    
+private:
+
+    //--- Members ---
+    
+    //Path to the area the scenarios are built on.
+    string area_path;
+    
+    //Results of the scenarios that have run so far.
+    vector<benchmark_result_t> results;
+    
+    
+    //--- Function declarations ---
+    
+    void add_enemy_horde();
+    void add_pikmin_swarm();
+    point get_spawn_point(const point &center) const;
+    bool run_area_scenario(
+        const string &name, const std::function<void()> &setup,
+        const std::function<void()> &frame_setup = nullptr
+    );
+    void run_path_scenario();
+    void run_sector_scenario();
+    bool save_results(const string &output_path) const;
+    
+};
+
@@ -161,9 +161,15 @@ const string MOB_TYPE_ANIMATION = "animations.txt";
 //System asset file names file.
 const string SYSTEM_ASSET_FILE_NAMES = "system_asset_file_names.txt";
 
+//Benchmark suite results file.
+const string BENCHMARK_RESULTS = "benchmark_results.json";
+
 //Error log file.
 const string ERROR_LOG = "error_log.txt";
 
+//Input replay of the latest gameplay session.
+const string INPUT_REPLAY = "input_replay.rpl";
+
 //Mission records file.
 const string MISSION_RECORDS = "mission_records.txt";
 
@@ -179,6 +185,9 @@ const string PACK_DATA = "data.txt";
 //Performance log file.
 const string PERFORMANCE_LOG = "performance_log.txt";
 
+//Performance trace file.
+const string PERFORMANCE_TRACE = "performance_trace.json";
+
 //Statistics file.
 const string STATISTICS = "statistics.txt";
 
@@ -210,10 +219,18 @@ const string AREA_USER_DATA =
 //Paths to files from the engine's root folder.
 namespace FILE_PATHS_FROM_ROOT {
 
+//Benchmark suite results.
+const string BENCHMARK_RESULTS =
+    FOLDER_PATHS_FROM_ROOT::USER_DATA + "/" + FILE_NAMES::BENCHMARK_RESULTS;
+    
 //Error log.
 const string ERROR_LOG =
     FOLDER_PATHS_FROM_ROOT::USER_DATA + "/" + FILE_NAMES::ERROR_LOG;
     
+//Input replay.
+const string INPUT_REPLAY =
+    FOLDER_PATHS_FROM_ROOT::USER_DATA + "/" + FILE_NAMES::INPUT_REPLAY;
+    
 //Mission records.
 const string MISSION_RECORDS =
     FOLDER_PATHS_FROM_ROOT::USER_DATA + "/" + FILE_NAMES::MISSION_RECORDS;
@@ -226,6 +243,10 @@ const string OPTIONS =
 const string PERFORMANCE_LOG =
     FOLDER_PATHS_FROM_ROOT::USER_DATA + "/" + FILE_NAMES::PERFORMANCE_LOG;
     
+//Performance trace.
+const string PERFORMANCE_TRACE =
+    FOLDER_PATHS_FROM_ROOT::USER_DATA + "/" + FILE_NAMES::PERFORMANCE_TRACE;
+    
 //Statistics.
 const string STATISTICS =
     FOLDER_PATHS_FROM_ROOT::USER_DATA + "/" + FILE_NAMES::STATISTICS;
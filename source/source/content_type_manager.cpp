@@ -158,7 +158,7 @@ bool area_content_manager::load_area(
     if(game.perf_mon) game.perf_mon->finish_measurement();
     
     //Loading screen.
-    if(level >= CONTENT_LOAD_LEVEL_EDITOR) {
+    if(level >= CONTENT_LOAD_LEVEL_EDITOR && !game.headless) {
         if(game.loading_text_bmp) al_destroy_bitmap(game.loading_text_bmp);
         if(game.loading_subtext_bmp) al_destroy_bitmap(game.loading_subtext_bmp);
         game.loading_text_bmp = nullptr;
@@ -999,10 +999,12 @@ void misc_config_content_manager::load_all(CONTENT_LOAD_LEVEL level) {
         load_data_file(manifests[config_file_internal_name].path);
     game.config.load(&game_config_file);
     
-    al_set_window_title(
-        game.display,
-        game.config.name.empty() ? "Pikifen" : game.config.name.c_str()
-    );
+    if(game.display) {
+        al_set_window_title(
+            game.display,
+            game.config.name.empty() ? "Pikifen" : game.config.name.c_str()
+        );
+    }
     
     //System asset file names.
     string sys_asset_fn_internal_name =
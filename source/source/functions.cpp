@@ -53,14 +53,13 @@ bool are_walls_between(
     const point &p1, const point &p2,
     float ignore_walls_below_z, bool* out_impassable_walls
 ) {
-    point bb_tl(std::min(p1.x, p2.x), std::min(p1.y, p2.y));
-    point bb_br(std::max(p1.x, p2.x), std::max(p1.y, p2.y));
-    
-    set<edge*> candidate_edges;
+    //Only check the edges the line crosses. These come in the order
+    //of the blocks the line goes through, so the closest wall is found first.
+    //Cache for performance.
+    static vector<edge*> crossed_edges;
     if(
-        !game.cur_area_data->bmap.get_edges_in_region(
-            bb_tl, bb_br,
-            candidate_edges
+        !game.cur_area_data->bmap.get_edges_crossing_line_seg(
+            p1, p2, crossed_edges
         )
     ) {
         //Somehow out of bounds.
@@ -68,17 +67,7 @@ bool are_walls_between(
         return true;
     }
     
-    for(auto const &e_ptr : candidate_edges) {
-        if(
-            !line_segs_intersect(
-                p1, p2,
-                point(e_ptr->vertexes[0]->x, e_ptr->vertexes[0]->y),
-                point(e_ptr->vertexes[1]->x, e_ptr->vertexes[1]->y),
-                nullptr
-            )
-        ) {
-            continue;
-        }
+    for(auto const &e_ptr : crossed_edges) {
         for(size_t s = 0; s < 2; s++) {
             if(!e_ptr->sectors[s]) {
                 //No sectors means there's out-of-bounds geometry in the way.
@@ -865,6 +854,12 @@ void save_maker_tools() {
             "performance_monitor", b2s(game.maker_tools.use_perf_mon)
         )
     );
+    file.add(
+        new data_node(
+            "performance_monitor_frame_budget",
+            f2s(game.maker_tools.perf_mon_frame_budget)
+        )
+    );
     
     file.save_file(FILE_PATHS_FROM_ROOT::MAKER_TOOLS, true, true);
 }
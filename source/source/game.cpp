@@ -9,6 +9,8 @@
  */
 
 #include <algorithm>
+#include <cmath>
+#include <iostream>
 
 #include <allegro5/allegro_native_dialog.h>
 
@@ -21,6 +23,7 @@
 #include "load.h"
 #include "utils/allegro_utils.h"
 #include "utils/general_utils.h"
+#include "utils/math_utils.h"
 
 
 namespace GAME {
@@ -46,12 +49,22 @@ const unsigned char CURSOR_TRAIL_SAVE_N_SPOTS = 16;
 //Duration of full-screen fades.
 const float FADE_DURATION = 0.15f;
 
+//In fixed timestep mode, never run more than this many logic ticks
+//in a single frame, even if the logic is falling behind.
+const size_t FIXED_TIMESTEP_MAX_TICKS = 5;
+
+//In fixed timestep mode, how many logic ticks happen per second.
+const float FIXED_TIMESTEP_TICK_RATE = 60.0f;
+
 //When getting a framerate average, use a sample of this size.
 const size_t FRAMERATE_AVG_SAMPLE_SIZE = 30;
 
 //Only save the latest N FPS samples.
 const size_t FRAMERATE_HISTORY_SIZE = 300;
 
+//Number of frames a headless benchmark runs for, if not specified.
+const size_t HEADLESS_DEF_NR_FRAMES = 3600;
+
 }
 
 
@@ -162,6 +175,77 @@ void game_class::check_system_key_press(const ALLEGRO_EVENT &ev) {
 }
 
 
+/**
+ * @brief Runs as many fixed-length logic ticks as the time that passed
+ * since the last frame calls for. Whatever time is left over carries
+ * over to the next frame, and decides how far between the last two ticks
+ * the drawing should place things.
+ *
+ * @param frame_delta_t How long the current frame took.
+ */
+void game_class::do_fixed_timestep_logic(float frame_delta_t) {
+    const float tick_delta_t = 1.0f / GAME::FIXED_TIMESTEP_TICK_RATE;
+    game_state* prev_state = cur_state;
+    size_t nr_ticks = 0;
+    
+    tick_time_debt += frame_delta_t;
+    
+    while(tick_time_debt >= tick_delta_t) {
+        if(nr_ticks == GAME::FIXED_TIMESTEP_MAX_TICKS) {
+            //The logic can't keep up. Let the game slow down instead of
+            //falling further and further behind.
+            tick_time_debt = fmod(tick_time_debt, tick_delta_t);
+            break;
+        }
+        
+        delta_t = tick_delta_t;
+        time_passed += delta_t;
+        
+        do_global_logic();
+        cur_state->do_logic();
+        
+        tick_time_debt -= tick_delta_t;
+        nr_ticks++;
+        
+        if(cur_state != prev_state) {
+            tick_time_debt = 0.0f;
+            break;
+        }
+    }
+    
+    tick_interpolation = clamp(tick_time_debt / tick_delta_t, 0.0f, 1.0f);
+}
+
+
+/**
+ * @brief Ticks one frame of the current state when there is no display,
+ * with a fixed time step. This includes the state's drawing logic,
+ * even if nothing ends up on-screen.
+ *
+ * @return Whether the gameplay state is still the current one.
+ */
+bool game_class::do_headless_frame() {
+    double cur_frame_start_time = al_get_time();
+    
+    //Always the same time step, so runs can be compared with one another.
+    delta_t = 1.0f / options.target_fps;
+    time_passed += delta_t;
+    
+    do_global_logic();
+    cur_state->do_logic();
+    
+    if(cur_state != states.gameplay) {
+        //The area was left, like when a mission ends.
+        return false;
+    }
+    
+    cur_state->do_drawing();
+    
+    cur_frame_process_time = al_get_time() - cur_frame_start_time;
+    return true;
+}
+
+
 /**
  * @brief Performs some global drawings to run every frame.
  */
@@ -190,10 +274,6 @@ void game_class::do_global_logic() {
     
     //Audio.
     audio.tick(delta_t);
-    
-    //Dear ImGui.
-    ImGui_ImplAllegro5_NewFrame();
-    ImGui::NewFrame();
 }
 
 
@@ -270,6 +350,7 @@ void game_class::main_loop() {
                     //Failsafe.
                     prev_frame_start_time =
                         cur_frame_start_time - 1.0f / options.target_fps;
+                    tick_time_debt = 0.0f;
                     reset_delta_t = false;
                 }
                 
@@ -278,13 +359,24 @@ void game_class::main_loop() {
                 statistics.runtime += real_delta_t;
                 
                 //Anti speed-burst cap.
-                delta_t = std::min(real_delta_t, 0.2f);
+                float capped_delta_t = std::min(real_delta_t, 0.2f);
                 
-                time_passed += delta_t;
                 game_state* prev_state = cur_state;
                 
-                do_global_logic();
-                cur_state->do_logic();
+                ImGui_ImplAllegro5_NewFrame();
+                ImGui::NewFrame();
+                
+                if(options.fixed_timestep && cur_state == states.gameplay) {
+                    do_fixed_timestep_logic(capped_delta_t);
+                } else {
+                    delta_t = capped_delta_t;
+                    time_passed += delta_t;
+                    tick_time_debt = 0.0f;
+                    tick_interpolation = 1.0f;
+                    
+                    do_global_logic();
+                    cur_state->do_logic();
+                }
                 
                 if(cur_state == prev_state) {
                     //Only draw if we didn't change states in the meantime.
@@ -369,6 +461,115 @@ void game_class::register_audio_stream_source(ALLEGRO_AUDIO_STREAM* stream) {
 }
 
 
+/**
+ * @brief Benchmarks an area, without a display. The area is loaded,
+ * it is ticked for a number of frames with a fixed time step,
+ * and then the performance monitor's report is printed to stdout.
+ *
+ * @param area_path Path to the area's folder.
+ * @param nr_frames Number of frames to tick.
+ * @return 0 if everything went well, or an error number otherwise.
+ */
+int game_class::run_headless_benchmark(
+    const string &area_path, size_t nr_frames
+) {
+    states.gameplay->path_of_area_to_load = area_path;
+    change_state(states.gameplay);
+    if(cur_state != states.gameplay) {
+        std::cout <<
+                  "Could not load the area \"" << area_path << "\"!" <<
+                  std::endl;
+        return -1;
+    }
+    
+    size_t nr_frames_done = 0;
+    double start_time = al_get_time();
+    
+    while(nr_frames_done < nr_frames && is_game_running) {
+        nr_frames_done++;
+        if(!do_headless_frame()) break;
+    }
+    
+    double total_time = al_get_time() - start_time;
+    std::cout <<
+              perf_mon->get_report() << "\n" <<
+              "Ticked " << nr_frames_done << " frames in " <<
+              std::to_string(total_time) << "s (" <<
+              std::to_string(nr_frames_done / total_time) <<
+              " frames per second), with " <<
+              states.gameplay->mobs.all.size() <<
+              " objects in the area at the end." <<
+              std::endl;
+              
+    return 0;
+}
+
+
+/**
+ * @brief Plays back an input replay, without a display. The area it was
+ * recorded in is loaded, and every frame runs with the recorded inputs.
+ * Then, the performance monitor's report is printed to stdout, along with
+ * whether the simulation went down the same path as the recording.
+ *
+ * @param file_path Path to the input replay file.
+ * @return 0 if the whole replay matched the recording,
+ * or an error number otherwise.
+ */
+int game_class::run_input_replay(const string &file_path) {
+    input_replay &replay_ref = states.gameplay->session_replay;
+    if(!replay_ref.load_from_file(file_path)) {
+        std::cout <<
+                  "Could not load the input replay \"" << file_path << "\"!" <<
+                  std::endl;
+        return -1;
+    }
+    
+    //What the camera can see affects which objects are active,
+    //so use the same window size as the recording.
+    if(replay_ref.win_w > 0 && replay_ref.win_h > 0) {
+        win_w = replay_ref.win_w;
+        win_h = replay_ref.win_h;
+    }
+    
+    states.gameplay->path_of_area_to_load = replay_ref.area_path;
+    change_state(states.gameplay);
+    if(cur_state != states.gameplay) {
+        std::cout <<
+                  "Could not load the area \"" << replay_ref.area_path <<
+                  "\"!" << std::endl;
+        return -1;
+    }
+    
+    double start_time = al_get_time();
+    
+    while(!replay_ref.is_playback_over() && is_game_running) {
+        if(!do_headless_frame()) break;
+    }
+    
+    double total_time = al_get_time() - start_time;
+    std::cout <<
+              perf_mon->get_report() << "\n" <<
+              "Replayed " << replay_ref.cur_frame_idx << " of " <<
+              replay_ref.frames.size() << " frames in " <<
+              std::to_string(total_time) << "s." << std::endl;
+              
+    if(replay_ref.cur_frame_idx < replay_ref.frames.size()) {
+        std::cout <<
+                  "The gameplay ended before the replay did!" << std::endl;
+        return 1;
+    }
+    if(replay_ref.nr_desyncs > 0) {
+        std::cout <<
+                  "The simulation did not match the recording on " <<
+                  replay_ref.nr_desyncs << " frames, starting on frame " <<
+                  replay_ref.first_desync_frame_idx << "." << std::endl;
+        return 1;
+    }
+    std::cout << "The simulation matched the recording." << std::endl;
+    return 0;
+}
+
+
 /**
  * @brief Starts up the program, setting up everything that's necessary.
  *
@@ -426,12 +627,14 @@ int game_class::start() {
     load_misc_graphics();
     load_misc_sounds();
     
-    //Draw the basic loading screen.
-    draw_loading_screen("", "", 1.0);
-    al_flip_display();
-    
-    //Init Dear ImGui.
-    init_dear_imgui();
+    if(!headless) {
+        //Draw the basic loading screen.
+        draw_loading_screen("", "", 1.0);
+        al_flip_display();
+        
+        //Init Dear ImGui.
+        init_dear_imgui();
+    }
     
     //Init and load some engine things.
     init_mob_actions();
@@ -442,8 +645,14 @@ int game_class::start() {
     
     dummy_mob_state = new mob_state("dummy");
     
-    if(maker_tools.use_perf_mon) {
+    if(maker_tools.use_perf_mon || headless) {
         perf_mon = new performance_monitor_t();
+        perf_mon->set_frame_budget(maker_tools.perf_mon_frame_budget);
+    }
+    
+    if(headless) {
+        //The benchmark loads its area by itself.
+        return 0;
     }
     
     if(
@@ -39,8 +39,11 @@ extern const float CURSOR_TRAIL_MIN_SPOT_DIFF;
 extern const float CURSOR_TRAIL_SAVE_INTERVAL;
 extern const unsigned char CURSOR_TRAIL_SAVE_N_SPOTS;
 extern const float FADE_DURATION;
+extern const size_t FIXED_TIMESTEP_MAX_TICKS;
+extern const float FIXED_TIMESTEP_TICK_RATE;
 extern const size_t FRAMERATE_AVG_SAMPLE_SIZE;
 extern const size_t FRAMERATE_HISTORY_SIZE;
+extern const size_t HEADLESS_DEF_NR_FRAMES;
 }
 
 
@@ -147,6 +150,9 @@ public:
     //Last framerate average started at this point in the history.
     size_t framerate_last_avg_point = 0.0f;
     
+    //Is the engine running without a display, just to benchmark an area?
+    bool headless = false;
+    
     //Identity matrix transformation. Cache for convenience.
     ALLEGRO_TRANSFORM identity_transform;
     
@@ -223,6 +229,11 @@ public:
     //List of all mob team names, in proper English.
     string team_names[N_MOB_TEAMS];
     
+    //In fixed timestep mode, how far along the time is between the
+    //second-to-last logic tick (0) and the last one (1).
+    //Drawings use this to place things in between. Always 1 otherwise.
+    float tick_interpolation = 1.0f;
+    
     //How much time has passed since the program booted.
     float time_passed = 0.0f;
     
@@ -255,10 +266,13 @@ public:
         game_state* new_state,
         bool unload_current = true, bool load_new = true
     );
+    bool do_headless_frame();
     string get_cur_state_name() const;
     void unload_loaded_state(game_state* loaded_state);
     void register_audio_stream_source(ALLEGRO_AUDIO_STREAM* stream);
     void unregister_audio_stream_source(ALLEGRO_AUDIO_STREAM* stream);
+    int run_headless_benchmark(const string &area_path, size_t nr_frames);
+    int run_input_replay(const string &file_path);
     int start();
     void main_loop();
     void shutdown();
@@ -279,10 +293,15 @@ private:
     //Is delta_t meant to be reset for the next frame?
     bool reset_delta_t = true;
     
+    //In fixed timestep mode, time that has passed but that the logic
+    //ticks haven't covered yet.
+    float tick_time_debt = 0.0f;
+    
     
     //--- Function declarations ---
     
     void check_system_key_press(const ALLEGRO_EVENT &ev);
+    void do_fixed_timestep_logic(float frame_delta_t);
     void do_global_drawing();
     void do_global_logic();
     void global_handle_allegro_event(const ALLEGRO_EVENT &ev);
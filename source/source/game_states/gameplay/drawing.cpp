@@ -200,6 +200,34 @@ void gameplay_state::do_game_drawing(
 #pragma warning(default: 4701)
 
 
+/**
+ * @brief Does the drawing for the main game loop when there is no display.
+ * Only the game world is drawn, onto a bitmap that never gets shown,
+ * so that how long it takes can still be measured.
+ */
+void gameplay_state::do_headless_drawing() {
+    if(!headless_canvas) {
+        headless_canvas = al_create_bitmap(game.win_w, game.win_h);
+    }
+    
+    ALLEGRO_BITMAP* old_target = al_get_target_bitmap();
+    al_set_target_bitmap(headless_canvas);
+    al_clear_to_color(game.cur_area_data->bg_color);
+    
+    if(game.perf_mon) {
+        game.perf_mon->start_measurement("Drawing -- World");
+    }
+    al_use_transform(&game.world_to_screen_transform);
+    draw_world_components(nullptr);
+    al_use_transform(&game.identity_transform);
+    if(game.perf_mon) {
+        game.perf_mon->finish_measurement();
+    }
+    
+    al_set_target_bitmap(old_target);
+}
+
+
 /**
  * @brief Draws the area background.
  *
@@ -1505,7 +1533,8 @@ void gameplay_state::draw_throw_preview() {
     }
     
     //Check which edges exist near the throw.
-    set<edge*> candidate_edges;
+    //Cache for performance.
+    static vector<edge*> candidate_edges;
     
     game.cur_area_data->bmap.get_edges_in_region(
         point(
@@ -154,7 +154,16 @@ void gameplay_state::change_spray_count(
  * @brief Draws the gameplay.
  */
 void gameplay_state::do_drawing() {
-    do_game_drawing();
+    bool interpolate = game.tick_interpolation < 1.0f;
+    if(interpolate) start_tick_interpolation();
+    
+    if(game.headless) {
+        do_headless_drawing();
+    } else {
+        do_game_drawing();
+    }
+    
+    if(interpolate) finish_tick_interpolation();
     
     if(game.perf_mon) {
         game.perf_mon->leave_state();
@@ -177,14 +186,43 @@ void gameplay_state::do_logic() {
         }
     }
     
+    //Controls.
+    vector<player_action> player_actions = game.controls.new_frame();
+    if(session_replay.mode != INPUT_REPLAY_MODE_NONE) {
+        //Cache for performance.
+        static vector<ALLEGRO_EVENT> menu_mouse_events;
+        session_replay.process_frame(
+            &game.delta_t,
+            &game.mouse_cursor.s_pos, &game.mouse_cursor.w_pos,
+            &player_actions, &menu_mouse_events
+        );
+        
+        if(!menu_mouse_events.empty()) {
+            //Give the menus the mouse events they got during the recording,
+            //with the cursor where it was for each one.
+            point final_s_pos = game.mouse_cursor.s_pos;
+            point final_w_pos = game.mouse_cursor.w_pos;
+            for(size_t e = 0; e < menu_mouse_events.size(); e++) {
+                game.mouse_cursor.update_pos(
+                    menu_mouse_events[e], game.screen_to_world_transform
+                );
+                handle_menu_event(menu_mouse_events[e]);
+            }
+            game.mouse_cursor.s_pos = final_s_pos;
+            game.mouse_cursor.w_pos = final_w_pos;
+        }
+    }
+    
     float regular_delta_t = game.delta_t;
     
+    if(game.options.fixed_timestep) {
+        save_tick_start_state();
+    }
+    
     if(game.maker_tools.change_speed) {
         game.delta_t *= game.maker_tools.change_speed_mult;
     }
     
-    //Controls.
-    vector<player_action> player_actions = game.controls.new_frame();
     for(size_t a = 0; a < player_actions.size(); a++) {
         handle_player_action(player_actions[a]);
         if(onion_menu) onion_menu->handle_player_action(player_actions[a]);
@@ -198,6 +236,10 @@ void gameplay_state::do_logic() {
     }
     do_menu_logic();
     do_aesthetic_logic(game.delta_t* delta_t_mult);
+    
+    if(session_replay.mode != INPUT_REPLAY_MODE_NONE) {
+        session_replay.finish_frame(get_world_state_hash());
+    }
 }
 
 
@@ -301,6 +343,7 @@ void gameplay_state::enter() {
         cur_leader_ptr->stop_whistling();
     }
     update_closest_group_members();
+    save_tick_start_state();
 }
 
 
@@ -381,6 +424,21 @@ ALLEGRO_BITMAP* gameplay_state::generate_fog_bitmap(
 }
 
 
+/**
+ * @brief Puts every mob and the camera back where the logic has them,
+ * after they were drawn at interpolated spots.
+ */
+void gameplay_state::finish_tick_interpolation() {
+    for(size_t m = 0; m < real_mob_transforms.size(); m++) {
+        mobs.all[m]->pos = real_mob_transforms[m].first;
+        mobs.all[m]->z = real_mob_transforms[m].second;
+    }
+    game.cam.pos = real_cam_pos;
+    game.cam.zoom = real_cam_zoom;
+    update_transformations();
+}
+
+
 /**
  * @brief Returns how many Pikmin are in the field in the current area.
  * This also checks inside converters.
@@ -605,18 +663,54 @@ string gameplay_state::get_name() const {
 }
 
 
+/**
+ * @brief Returns a hash of the state of every mob in the world.
+ * Two simulations that went down the same path have the same hash.
+ *
+ * @return The hash.
+ */
+uint32_t gameplay_state::get_world_state_hash() const {
+    //FNV-1a.
+    uint32_t hash = 2166136261u;
+    auto add_to_hash = [&hash] (const void* data, size_t size) {
+        const unsigned char* bytes = (const unsigned char*) data;
+        for(size_t b = 0; b < size; b++) {
+            hash ^= bytes[b];
+            hash *= 16777619u;
+        }
+    };
+    
+    //Counts and IDs go in as 64-bit numbers, so that the hash is the same
+    //on 32-bit and 64-bit builds, and replays can be shared between them.
+    size_t n_mobs = mobs.all.size();
+    uint64_t n_mobs_64 = n_mobs;
+    add_to_hash(&n_mobs_64, sizeof(n_mobs_64));
+    for(size_t m = 0; m < n_mobs; m++) {
+        const mob* m_ptr = mobs.all[m];
+        uint64_t id_64 = m_ptr->id;
+        add_to_hash(&id_64, sizeof(id_64));
+        add_to_hash(&m_ptr->pos.x, sizeof(m_ptr->pos.x));
+        add_to_hash(&m_ptr->pos.y, sizeof(m_ptr->pos.y));
+        add_to_hash(&m_ptr->z, sizeof(m_ptr->z));
+        add_to_hash(&m_ptr->angle, sizeof(m_ptr->angle));
+        add_to_hash(&m_ptr->health, sizeof(m_ptr->health));
+    }
+    return hash;
+}
+
+
 /**
  * @brief Handles an Allegro event.
  *
  * @param ev Event to handle.
  */
 void gameplay_state::handle_allegro_event(ALLEGRO_EVENT &ev) {
-    //Handle the Onion menu first so events don't bleed from gameplay to it.
-    if(onion_menu) {
-        onion_menu->handle_event(ev);
-    } else if(pause_menu) {
-        pause_menu->handle_event(ev);
+    //The menus read the mouse directly instead of going through player
+    //actions, so input replays need to record what they get.
+    if(onion_menu || pause_menu) {
+        session_replay.record_menu_mouse_event(ev);
     }
+    handle_menu_event(ev);
     
     //Check if there are system key presses.
     if(ev.type == ALLEGRO_EVENT_KEY_CHAR) {
@@ -633,6 +727,21 @@ void gameplay_state::handle_allegro_event(ALLEGRO_EVENT &ev) {
 }
 
 
+/**
+ * @brief Passes an Allegro event to whichever menu is open, if any.
+ *
+ * @param ev Event to handle.
+ */
+void gameplay_state::handle_menu_event(const ALLEGRO_EVENT &ev) {
+    //Handle the Onion menu first so events don't bleed from gameplay to it.
+    if(onion_menu) {
+        onion_menu->handle_event(ev);
+    } else if(pause_menu) {
+        pause_menu->handle_event(ev);
+    }
+}
+
+
 /**
  * @brief Initializes the HUD.
  */
@@ -697,8 +806,10 @@ void gameplay_state::load() {
     game.errors.prepare_area_load();
     went_to_results = false;
     
-    draw_loading_screen("", "", 1.0f);
-    al_flip_display();
+    if(!game.headless) {
+        draw_loading_screen("", "", 1.0f);
+        al_flip_display();
+    }
     
     game.statistics.area_entries++;
     
@@ -771,6 +882,21 @@ void gameplay_state::load() {
         );
     }
     
+    //Input replay. From here on, the random number generator has to
+    //give the same numbers as during the recording.
+    if(session_replay.mode == INPUT_REPLAY_MODE_PLAYING) {
+        session_replay.restart_playback();
+        srand(session_replay.rng_seed);
+    } else if(game.options.record_input_replays) {
+        session_replay.start_recording(
+            path_of_area_to_load, (unsigned int) rand(),
+            game.win_w, game.win_h
+        );
+        srand(session_replay.rng_seed);
+    } else {
+        session_replay.clear();
+    }
+    
     //Load the area.
     if(
         !game.content.load_area_as_current(
@@ -996,8 +1122,15 @@ void gameplay_state::load() {
         nr_area_cell_cols, vector<bool>(nr_area_cell_rows, false)
     );
     
+    //Initialize the mob interaction grid. It uses the same cells.
+    interaction_grid.init(
+        game.cur_area_data->bmap.top_left_corner,
+        nr_area_cell_cols, nr_area_cell_rows
+    );
+    
     //Initialize some other things.
     path_mgr.handle_area_load();
+    logic_workers.start(game.options.logic_threads);
     
     init_hud();
     
@@ -1166,6 +1299,20 @@ void gameplay_state::load_game_content() {
 }
 
 
+/**
+ * @brief Saves where every mob and the camera are before a logic tick,
+ * so the drawing can place them in between this and the next tick.
+ */
+void gameplay_state::save_tick_start_state() {
+    for(size_t m = 0; m < mobs.all.size(); m++) {
+        mobs.all[m]->tick_start_pos = mobs.all[m]->pos;
+        mobs.all[m]->tick_start_z = mobs.all[m]->z;
+    }
+    tick_start_cam_pos = game.cam.pos;
+    tick_start_cam_zoom = game.cam.zoom;
+}
+
+
 /**
  * @brief Starts the fade out to leave the gameplay state.
  *
@@ -1176,12 +1323,46 @@ void gameplay_state::start_leaving(const GAMEPLAY_LEAVE_TARGET target) {
 }
 
 
+/**
+ * @brief Moves every mob and the camera to where they would be in between
+ * the last two logic ticks, according to the game's tick interpolation,
+ * so the drawing is smooth. The real spots are kept, so that
+ * finish_tick_interpolation() can restore them.
+ */
+void gameplay_state::start_tick_interpolation() {
+    float t = game.tick_interpolation;
+    
+    real_mob_transforms.resize(mobs.all.size());
+    for(size_t m = 0; m < mobs.all.size(); m++) {
+        mob* m_ptr = mobs.all[m];
+        real_mob_transforms[m] = std::make_pair(m_ptr->pos, m_ptr->z);
+        m_ptr->pos =
+            m_ptr->tick_start_pos + (m_ptr->pos - m_ptr->tick_start_pos) * t;
+        m_ptr->z =
+            m_ptr->tick_start_z + (m_ptr->z - m_ptr->tick_start_z) * t;
+    }
+    
+    real_cam_pos = game.cam.pos;
+    real_cam_zoom = game.cam.zoom;
+    game.cam.pos =
+        tick_start_cam_pos + (game.cam.pos - tick_start_cam_pos) * t;
+    game.cam.zoom =
+        tick_start_cam_zoom + (game.cam.zoom - tick_start_cam_zoom) * t;
+    update_transformations();
+}
+
+
 /**
  * @brief Unloads the "gameplay" state from memory.
  */
 void gameplay_state::unload() {
     unloading = true;
     
+    if(session_replay.mode == INPUT_REPLAY_MODE_RECORDING) {
+        session_replay.save_to_file(FILE_PATHS_FROM_ROOT::INPUT_REPLAY);
+        session_replay.clear();
+    }
+    
     if(hud) {
         hud->gui.destroy();
         delete hud;
@@ -1199,16 +1380,25 @@ void gameplay_state::unload() {
     game.cam.set_pos(point());
     game.cam.set_zoom(1.0f);
     
-    while(!mobs.all.empty()) {
-        delete_mob(*mobs.all.begin(), true);
+    for(size_t m = 0; m < mobs.all.size(); m++) {
+        mobs.all[m]->to_delete = true;
     }
+    delete_marked_mobs(mobs.all.size(), true);
     
     if(lightmap_bmp) {
         al_destroy_bitmap(lightmap_bmp);
         lightmap_bmp = nullptr;
     }
+    if(headless_canvas) {
+        al_destroy_bitmap(headless_canvas);
+        headless_canvas = nullptr;
+    }
     
     mission_remaining_mob_ids.clear();
+    interaction_grid.clear();
+    logic_workers.stop();
+    snapshot_interaction_candidates.clear();
+    snapshot_interaction_cell_ranges.clear();
     path_mgr.clear();
     spray_stats.clear();
     particles.clear();
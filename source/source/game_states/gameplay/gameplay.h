@@ -20,6 +20,7 @@
 #include "../../replay.h"
 #include "../../gui.h"
 #include "../../utils/general_utils.h"
+#include "../../utils/thread_utils.h"
 #include "../game_state.h"
 #include "gameplay_utils.h"
 #include "hud.h"
@@ -166,6 +167,9 @@ public:
     //Replay of the gameplay.
     replay gameplay_replay;
     
+    //Inputs of the gameplay, being recorded or played back.
+    input_replay session_replay;
+    
     //How many seconds of actual playtime. Only counts on player control.
     float gameplay_time_passed = 0.0f;
     
@@ -424,6 +428,15 @@ private:
     //Movement of player 1's cursor via non-mouse means.
     movement_t cursor_movement;
     
+    //Bitmap the world is drawn onto when there is no display.
+    ALLEGRO_BITMAP* headless_canvas = nullptr;
+    
+    //Mob indexes returned by the interaction grid. Cache for performance.
+    vector<size_t> interaction_candidates;
+    
+    //Broad phase grid used to find which mobs can interact with one another.
+    mob_interaction_grid interaction_grid;
+    
     //Is input enabled, for reasons outside the ready_for_input variable?
     bool is_input_allowed = false;
     
@@ -433,6 +446,10 @@ private:
     //Movement of player 1's leader.
     movement_t leader_movement;
     
+    //Worker threads that find each mob's interaction candidates at the
+    //start of the mob logic. The rest of the logic runs on the main thread.
+    worker_pool logic_workers;
+    
     //Information about the current Onion menu, if any.
     onion_menu_t* onion_menu = nullptr;
     
@@ -447,15 +464,39 @@ private:
     //So forbid input until the second frame.
     bool ready_for_input = false;
     
+    //Real camera position, while the drawing uses an interpolated one.
+    point real_cam_pos;
+    
+    //Real camera zoom, while the drawing uses an interpolated one.
+    float real_cam_zoom = 1.0f;
+    
+    //Real position and Z of every mob, while the drawing uses
+    //interpolated ones.
+    vector<std::pair<point, float> > real_mob_transforms;
+    
     //Timer for the next replay state save.
     timer replay_timer;
     
+    //For each mob, the interaction candidates found at the start of the
+    //frame. Cache for performance.
+    vector<vector<size_t> > snapshot_interaction_candidates;
+    
+    //For each mob, the first column, last column, first row, and last row
+    //of the interaction grid cells its snapshot candidates came from.
+    vector<int> snapshot_interaction_cell_ranges;
+    
     //Is player 1 holding the "swarm to cursor" button?
     bool swarm_cursor = false;
     
     //Reach of player 1's swarm.
     movement_t swarm_movement;
     
+    //Camera position at the start of the latest logic tick.
+    point tick_start_cam_pos;
+    
+    //Camera zoom at the start of the latest logic tick.
+    float tick_start_cam_zoom = 1.0f;
+    
     
     //--- Function declarations ---
     
@@ -467,6 +508,7 @@ private:
     );
     void do_gameplay_leader_logic(float delta_t);
     void do_gameplay_logic(float delta_t);
+    void do_headless_drawing();
     void do_menu_logic();
     void draw_background(ALLEGRO_BITMAP* bmp_output);
     void draw_debug_tools();
@@ -484,10 +526,14 @@ private:
     void draw_world_components(ALLEGRO_BITMAP* bmp_output);
     ALLEGRO_BITMAP* draw_to_bitmap();
     void end_mission(bool cleared);
+    void find_snapshot_interaction_candidates();
+    void finish_tick_interpolation();
     ALLEGRO_BITMAP* generate_fog_bitmap(
         float near_radius, float far_radius
     );
     mob* get_closest_group_member(const subgroup_type* type);
+    uint32_t get_world_state_hash() const;
+    void handle_menu_event(const ALLEGRO_EVENT &ev);
     void handle_player_action(const player_action &action);
     void init_hud();
     bool is_mission_clear_met();
@@ -512,6 +558,8 @@ private:
         mob* m_ptr, mob* m2_ptr, size_t m, size_t m2, dist &d
     );
     void process_system_key_press(int keycode);
+    void save_tick_start_state();
+    void start_tick_interpolation();
     void unload_game_content();
     void update_area_active_cells();
     void update_mob_is_active_flag();
@@ -740,8 +740,32 @@ void gameplay_state::do_gameplay_logic(float delta_t) {
                 cur_leader_ptr->chase_info.state == CHASE_STATE_CHASING;
         }
         
+        if(game.perf_mon) {
+            game.perf_mon->start_measurement("Logic -- Object setup");
+        }
+        
         update_area_active_cells();
         update_mob_is_active_flag();
+        interaction_grid.rebuild(mobs.all);
+        find_snapshot_interaction_candidates();
+        
+        if(game.perf_mon) {
+            game.perf_mon->finish_measurement();
+        }
+        
+        if(game.perf_mon) {
+            game.perf_mon->start_measurement("Logic -- Path replanning");
+        }
+        
+        path_mgr.process_replan_queue();
+        
+        if(game.perf_mon) {
+            game.perf_mon->finish_measurement();
+        }
+        
+        if(game.perf_mon) {
+            game.perf_mon->start_measurement("Logic -- Objects");
+        }
         
         size_t n_mobs = mobs.all.size();
         for(size_t m = 0; m < n_mobs; m++) {
@@ -758,20 +782,26 @@ void gameplay_state::do_gameplay_logic(float delta_t) {
             }
             
             m_ptr->tick(delta_t);
+            interaction_grid.update_mob(m, m_ptr);
             if(!m_ptr->is_stored_inside_mob()) {
                 process_mob_interactions(m_ptr, m);
+                interaction_grid.update_mob(m, m_ptr);
             }
         }
         
-        for(size_t m = 0; m < n_mobs;) {
-            //Mob deletion.
-            mob* m_ptr = mobs.all[m];
-            if(m_ptr->to_delete) {
-                delete_mob(m_ptr);
-                n_mobs--;
-                continue;
-            }
-            m++;
+        if(game.perf_mon) {
+            game.perf_mon->finish_measurement();
+        }
+        
+        //Mob deletion.
+        if(game.perf_mon) {
+            game.perf_mon->start_measurement("Logic -- Object deletion");
+        }
+        
+        delete_marked_mobs(n_mobs);
+        
+        if(game.perf_mon) {
+            game.perf_mon->finish_measurement();
         }
         
         do_gameplay_leader_logic(delta_t);
@@ -1460,6 +1490,42 @@ void gameplay_state::do_menu_logic() {
 }
 
 
+/**
+ * @brief Finds the interaction candidates of every mob, splitting the work
+ * among the logic worker threads. This is done at the start of the frame,
+ * before any mob moves, so each thread only reads the interaction grid,
+ * and only writes to its own mob's list.
+ * If there are no worker threads, nothing is done, and the candidates
+ * are found as each mob is processed instead.
+ */
+void gameplay_state::find_snapshot_interaction_candidates() {
+    snapshot_interaction_cell_ranges.clear();
+    if(logic_workers.get_nr_workers() == 0) return;
+    
+    size_t n_mobs = mobs.all.size();
+    if(snapshot_interaction_candidates.size() < n_mobs) {
+        snapshot_interaction_candidates.resize(n_mobs);
+    }
+    snapshot_interaction_cell_ranges.resize(n_mobs * 4);
+    
+    logic_workers.parallel_for(
+        n_mobs,
+    [this] (size_t m) {
+        mob* m_ptr = mobs.all[m];
+        int* cell_range = &snapshot_interaction_cell_ranges[m * 4];
+        interaction_grid.get_cell_range(
+            m_ptr->pos, m_ptr->interaction_span,
+            &cell_range[0], &cell_range[1], &cell_range[2], &cell_range[3]
+        );
+        interaction_grid.get_candidates(
+            m_ptr->pos, m_ptr->interaction_span,
+            snapshot_interaction_candidates[m]
+        );
+    }
+    );
+}
+
+
 /**
  * @brief Checks if the player is close to any living enemy and also if
  * they are close to any living boss.
@@ -1591,11 +1657,73 @@ void gameplay_state::mark_area_cells_active(
  * @param m Index of the mob.
  */
 void gameplay_state::process_mob_interactions(mob* m_ptr, size_t m) {
+    //Performance monitor zones. Cache for performance.
+    static const size_t touching_zone_id =
+        performance_monitor_t::get_zone_id("Objects -- Touching others");
+    static const size_t reaches_zone_id =
+        performance_monitor_t::get_zone_id("Objects -- Reaches");
+    static const size_t misc_zone_id =
+        performance_monitor_t::get_zone_id("Objects -- Misc. interactions");
+    static const size_t results_zone_id =
+        performance_monitor_t::get_zone_id("Objects -- Interaction results");
+        
     vector<pending_intermob_event> pending_intermob_events;
     mob_state* state_before = m_ptr->fsm.cur_state;
     
+    //Only check mobs that the broad phase says could be in range.
+    //Mobs are kept in the grid based on the position they had after their
+    //own tick, and mobs don't move other mobs far enough within a single
+    //frame for this to miss anything.
     size_t n_mobs = mobs.all.size();
-    for(size_t m2 = 0; m2 < n_mobs; m2++) {
+    bool snapshot_is_valid = false;
+    if(m * 4 < snapshot_interaction_cell_ranges.size()) {
+        int cell_range[4];
+        interaction_grid.get_cell_range(
+            m_ptr->pos, m_ptr->interaction_span,
+            &cell_range[0], &cell_range[1], &cell_range[2], &cell_range[3]
+        );
+        snapshot_is_valid =
+            std::equal(
+                cell_range, cell_range + 4,
+                &snapshot_interaction_cell_ranges[m * 4]
+            );
+    }
+    
+    const vector<size_t>* candidates = &interaction_candidates;
+    if(snapshot_is_valid) {
+        //The candidates were found by the worker threads at the start of
+        //the frame, using the same cells. The only mobs that could be
+        //missing from them are the ones that changed cells since, and moved
+        //into these ones, so add those too. Mobs that moved out are left in,
+        //since having a few extra candidates doesn't change the results.
+        candidates = &snapshot_interaction_candidates[m];
+        if(
+            interaction_grid.add_moved_candidates(
+                m_ptr->pos, m_ptr->interaction_span,
+                *candidates, interaction_candidates
+            )
+        ) {
+            candidates = &interaction_candidates;
+        }
+    } else {
+        interaction_grid.get_candidates(
+            m_ptr->pos, m_ptr->interaction_span, interaction_candidates
+        );
+    }
+    
+    //Mobs created since the grid was built aren't in it,
+    //so they always need to be checked, after the candidates.
+    size_t n_candidates = candidates->size();
+    size_t n_checks = n_candidates;
+    if(n_mobs > interaction_grid.n_mobs) {
+        n_checks += n_mobs - interaction_grid.n_mobs;
+    }
+    
+    for(size_t c = 0; c < n_checks; c++) {
+        size_t m2 =
+            c < n_candidates ?
+            (*candidates)[c] :
+            interaction_grid.n_mobs + (c - n_candidates);
         if(m == m2) continue;
         
         mob* m2_ptr = mobs.all[m2];
@@ -1619,48 +1747,37 @@ void gameplay_state::process_mob_interactions(mob* m_ptr, size_t m) {
             continue;
         }
         
-        if(game.perf_mon) {
-            game.perf_mon->start_measurement("Objects -- Touching others");
-        }
-        
-        if(d <= m_ptr->physical_span + m2_ptr->physical_span) {
-            //Only check if their radii or hitboxes
-            //can (theoretically) reach each other.
-            process_mob_touches(m_ptr, m2_ptr, m, m2, d);
-            
+        {
+            perf_zone zone(touching_zone_id);
+            if(d <= m_ptr->physical_span + m2_ptr->physical_span) {
+                //Only check if their radii or hitboxes
+                //can (theoretically) reach each other.
+                process_mob_touches(m_ptr, m2_ptr, m, m2, d);
+                
+            }
         }
         
-        if(game.perf_mon) {
-            game.perf_mon->finish_measurement();
-            game.perf_mon->start_measurement("Objects -- Reaches");
+        {
+            perf_zone zone(reaches_zone_id);
+            if(
+                m2_ptr->health != 0 && m_ptr->near_reach != INVALID &&
+                !m2_ptr->has_invisibility_status
+            ) {
+                process_mob_reaches(
+                    m_ptr, m2_ptr, m, m2, d, pending_intermob_events
+                );
+            }
         }
         
-        if(
-            m2_ptr->health != 0 && m_ptr->near_reach != INVALID &&
-            !m2_ptr->has_invisibility_status
-        ) {
-            process_mob_reaches(
+        {
+            perf_zone zone(misc_zone_id);
+            process_mob_misc_interactions(
                 m_ptr, m2_ptr, m, m2, d, pending_intermob_events
             );
         }
-        
-        if(game.perf_mon) {
-            game.perf_mon->finish_measurement();
-            game.perf_mon->start_measurement("Objects -- Misc. interactions");
-        }
-        
-        process_mob_misc_interactions(
-            m_ptr, m2_ptr, m, m2, d, pending_intermob_events
-        );
-        
-        if(game.perf_mon) {
-            game.perf_mon->finish_measurement();
-        }
     }
     
-    if(game.perf_mon) {
-        game.perf_mon->start_measurement("Objects -- Interaction results");
-    }
+    perf_zone results_zone(results_zone_id);
     
     //Check the pending inter-mob events.
     sort(
@@ -1689,10 +1806,6 @@ void gameplay_state::process_mob_interactions(mob* m_ptr, size_t m) {
         );
         
     }
-    
-    if(game.perf_mon) {
-        game.perf_mon->finish_measurement();
-    }
 }
 
 
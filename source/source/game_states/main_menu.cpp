@@ -781,8 +781,10 @@ void main_menu_state::init_gui_tutorial_page() {
  * @brief Loads the main menu into memory.
  */
 void main_menu_state::load() {
-    draw_loading_screen("", "", 1.0);
-    al_flip_display();
+    if(!game.headless) {
+        draw_loading_screen("", "", 1.0);
+        al_flip_display();
+    }
     
     //Game content.
     game.content.reload_packs();
@@ -77,7 +77,7 @@ void destroy_event_things(
 ) {
     al_destroy_event_queue(event_queue);
     al_destroy_timer(main_timer);
-    al_destroy_display(game.display);
+    if(game.display) al_destroy_display(game.display);
 }
 
 
@@ -105,13 +105,19 @@ void init_allegro() {
     if(!al_init()) {
         report_fatal_error("Could not initialize Allegro!");
     }
-    if(!al_install_mouse()) {
-        report_fatal_error("Could not install the Allegro mouse module!");
+    //Without a display, there's nothing to read input from.
+    if(!game.headless) {
+        if(!al_install_mouse()) {
+            report_fatal_error("Could not install the Allegro mouse module!");
+        }
+        if(!al_install_keyboard()) {
+            report_fatal_error(
+                "Could not install the Allegro keyboard module!"
+            );
+        }
     }
-    if(!al_install_keyboard()) {
-        report_fatal_error("Could not install the Allegro keyboard module!");
-    }
-    if(!al_install_audio()) {
+    //Headless machines may have no sound device, which is fine.
+    if(!al_install_audio() && !game.headless) {
         report_fatal_error("Could not install the Allegro audio module!");
     }
     if(!al_init_image_addon()) {
@@ -137,7 +143,7 @@ void init_allegro() {
             "Could not initialize the Allegro TTF font addon!"
         );
     }
-    if(!al_install_joystick()) {
+    if(!game.headless && !al_install_joystick()) {
         report_fatal_error(
             "Could not initialize Allegro joystick support!"
         );
@@ -563,7 +569,8 @@ void init_error_bitmap() {
             16.0, 16.0, 32.0, 32.0,
             al_map_rgba(255, 0, 255, 192)
         );
-    } al_set_target_backbuffer(game.display);
+    }
+    if(game.display) al_set_target_backbuffer(game.display);
     game.bmp_error = recreate_bitmap(game.bmp_error);
 }
 
@@ -590,50 +597,54 @@ void init_essentials() {
 void init_event_things(
     ALLEGRO_TIMER* &main_timer, ALLEGRO_EVENT_QUEUE* &event_queue
 ) {
-    al_set_new_display_flags(
-        al_get_new_display_flags() |
-        ALLEGRO_OPENGL
-    );
-    if(game.options.window_position_hack) al_set_new_window_position(64, 64);
-    if(game.win_fullscreen) {
+    if(!game.headless) {
         al_set_new_display_flags(
             al_get_new_display_flags() |
-            (
-                game.options.true_fullscreen ?
-                ALLEGRO_FULLSCREEN :
-                ALLEGRO_FULLSCREEN_WINDOW
-            )
-        );
-    }
-    game.display = al_create_display(game.win_w, game.win_h);
-    
-    //It's possible that this resolution is not valid for fullscreen.
-    //Detect this and try again in windowed.
-    if(!game.display && game.win_fullscreen) {
-        game.errors.report(
-            "Could not create a fullscreen window with the resolution " +
-            i2s(game.win_w) + "x" + i2s(game.win_h) + ". "
-            "Setting the fullscreen option back to false. "
-            "You can try a different resolution, "
-            "preferably one from the options menu."
-        );
-        game.win_fullscreen = false;
-        game.options.intended_win_fullscreen = false;
-        save_options();
-        al_set_new_display_flags(
-            al_get_new_display_flags() & ~ALLEGRO_FULLSCREEN
+            ALLEGRO_OPENGL
         );
+        if(game.options.window_position_hack) {
+            al_set_new_window_position(64, 64);
+        }
+        if(game.win_fullscreen) {
+            al_set_new_display_flags(
+                al_get_new_display_flags() |
+                (
+                    game.options.true_fullscreen ?
+                    ALLEGRO_FULLSCREEN :
+                    ALLEGRO_FULLSCREEN_WINDOW
+                )
+            );
+        }
         game.display = al_create_display(game.win_w, game.win_h);
+        
+        //It's possible that this resolution is not valid for fullscreen.
+        //Detect this and try again in windowed.
+        if(!game.display && game.win_fullscreen) {
+            game.errors.report(
+                "Could not create a fullscreen window with the resolution " +
+                i2s(game.win_w) + "x" + i2s(game.win_h) + ". "
+                "Setting the fullscreen option back to false. "
+                "You can try a different resolution, "
+                "preferably one from the options menu."
+            );
+            game.win_fullscreen = false;
+            game.options.intended_win_fullscreen = false;
+            save_options();
+            al_set_new_display_flags(
+                al_get_new_display_flags() & ~ALLEGRO_FULLSCREEN
+            );
+            game.display = al_create_display(game.win_w, game.win_h);
+        }
+        
+        if(!game.display) {
+            report_fatal_error("Could not create a display!");
+        }
+        
+        //For some reason some resolutions aren't properly created
+        //under Windows. This hack fixes it.
+        al_resize_display(game.display, game.win_w, game.win_h);
     }
     
-    if(!game.display) {
-        report_fatal_error("Could not create a display!");
-    }
-    
-    //For some reason some resolutions aren't properly created under Windows.
-    //This hack fixes it.
-    al_resize_display(game.display, game.win_w, game.win_h);
-    
     main_timer = al_create_timer(1.0f / game.options.target_fps);
     if(!main_timer) {
         report_fatal_error("Could not create the main game timer!");
@@ -643,12 +654,14 @@ void init_event_things(
     if(!event_queue) {
         report_fatal_error("Could not create the main event queue!");
     }
-    al_register_event_source(event_queue, al_get_mouse_event_source());
-    al_register_event_source(event_queue, al_get_keyboard_event_source());
-    al_register_event_source(event_queue, al_get_joystick_event_source());
-    al_register_event_source(
-        event_queue, al_get_display_event_source(game.display)
-    );
+    if(!game.headless) {
+        al_register_event_source(event_queue, al_get_mouse_event_source());
+        al_register_event_source(event_queue, al_get_keyboard_event_source());
+        al_register_event_source(event_queue, al_get_joystick_event_source());
+        al_register_event_source(
+            event_queue, al_get_display_event_source(game.display)
+        );
+    }
     al_register_event_source(
         event_queue, al_get_timer_event_source(main_timer)
     );
@@ -662,8 +675,12 @@ void init_misc() {
     game.mouse_cursor.init();
     
     al_set_blender(ALLEGRO_ADD, ALLEGRO_ALPHA, ALLEGRO_INVERSE_ALPHA);
-    al_set_window_title(game.display, "Pikifen");
+    if(game.display) al_set_window_title(game.display, "Pikifen");
     int new_bitmap_flags = ALLEGRO_NO_PREMULTIPLIED_ALPHA;
+    if(game.headless) {
+        //There's no display to own video bitmaps.
+        enable_flag(new_bitmap_flags, ALLEGRO_MEMORY_BITMAP);
+    }
     if(game.options.smooth_scaling) {
         enable_flag(new_bitmap_flags, ALLEGRO_MAG_LINEAR);
         enable_flag(new_bitmap_flags, ALLEGRO_MIN_LINEAR);
@@ -345,6 +345,10 @@ void load_maker_tools() {
     rs.set("auto_start_option", game.maker_tools.auto_start_option);
     rs.set("auto_start_mode", game.maker_tools.auto_start_mode);
     rs.set("performance_monitor", game.maker_tools.use_perf_mon);
+    rs.set(
+        "performance_monitor_frame_budget",
+        game.maker_tools.perf_mon_frame_budget
+    );
     
     if(mob_hurting_percentage_node) {
         game.maker_tools.mob_hurting_ratio /= 100.0;
@@ -358,7 +362,9 @@ void load_maker_tools() {
 void load_misc_graphics() {
     //Icon.
     game.sys_assets.bmp_icon = game.content.bitmaps.list.get(game.asset_file_names.bmp_icon);
-    al_set_display_icon(game.display, game.sys_assets.bmp_icon);
+    if(game.display) {
+        al_set_display_icon(game.display, game.sys_assets.bmp_icon);
+    }
     
     //Graphics.
     game.sys_assets.bmp_menu_icons =
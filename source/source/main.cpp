@@ -8,25 +8,98 @@
  * Program start and main loop.
  */
 
+#include <algorithm>
+
+#include "benchmark.h"
 #include "game.h"
+#include "verification.h"
+
+#include "utils/string_utils.h"
 
 
 /**
  * @brief Main function. It calls the game class's functions to initialize
  * and run the game.
  *
- * @param argc Command line argument count. Unused.
- * @param argv Command line argument values. Unused.
+ * If the program is started with "--headless <area path> [frames]",
+ * it instead runs a benchmark of that area's logic, without any display,
+ * and prints the timings. The area path is the same as the one used by the
+ * "play" auto-start maker tool.
+ *
+ * If it is started with "--benchmark-suite <area path> [output path]",
+ * it instead runs a series of stress scenarios built on that area,
+ * without any display, and saves the timings to a JSON file.
+ *
+ * If it is started with "--replay <replay path>", it instead plays back
+ * an input replay without any display, checks if the simulation matches
+ * the recorded one, and prints the timings.
+ *
+ * If it is started with "--verify <area path>", it instead checks that the
+ * engine's faster ways of answering things like path searches give the same
+ * answers as the slow ones, on that area, and prints the results.
+ *
+ * @param argc Command line argument count.
+ * @param argv Command line argument values.
  * @return 0 if everything went well, or an error number otherwise.
  */
 int main(int argc, char** argv) {
     game = game_class();
     
+    string headless_area_path;
+    size_t headless_nr_frames = GAME::HEADLESS_DEF_NR_FRAMES;
+    bool run_benchmark_suite = false;
+    string benchmark_output_path = FILE_PATHS_FROM_ROOT::BENCHMARK_RESULTS;
+    string replay_path;
+    bool run_verification_suite = false;
+    if(argc >= 3 && string(argv[1]) == "--headless") {
+        game.headless = true;
+        headless_area_path = argv[2];
+        if(argc >= 4) {
+            headless_nr_frames = std::max(s2i(argv[3]), 1);
+        }
+    } else if(argc >= 3 && string(argv[1]) == "--benchmark-suite") {
+        game.headless = true;
+        run_benchmark_suite = true;
+        headless_area_path = argv[2];
+        if(argc >= 4) {
+            benchmark_output_path = argv[3];
+        }
+    } else if(argc >= 3 && string(argv[1]) == "--replay") {
+        game.headless = true;
+        replay_path = argv[2];
+    } else if(argc >= 3 && string(argv[1]) == "--verify") {
+        game.headless = true;
+        run_verification_suite = true;
+        headless_area_path = argv[2];
+    }
+    
     int game_start_result = game.start();
     if(game_start_result != 0) {
         return game_start_result;
     }
     
+    if(game.headless) {
+        int benchmark_result = 0;
+        if(run_benchmark_suite) {
+            benchmark_result =
+                benchmark_suite().run(
+                    headless_area_path, benchmark_output_path
+                );
+        } else if(run_verification_suite) {
+            benchmark_result =
+                verification_suite().run(headless_area_path);
+        } else if(!replay_path.empty()) {
+            benchmark_result = game.run_input_replay(replay_path);
+        } else {
+            benchmark_result =
+                game.run_headless_benchmark(
+                    headless_area_path, headless_nr_frames
+                );
+        }
+        game.shutdown();
+        return benchmark_result;
+    }
+    
     game.main_loop();
     
     game.shutdown();
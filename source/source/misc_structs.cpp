@@ -70,6 +70,38 @@ const float FADE_SPEED = 4.0f;
 }
 
 
+namespace PERF_MON {
+
+//Default frame processing time budget, in seconds.
+//Frames that take longer count as spikes.
+const float DEF_FRAME_BUDGET = 1.0f / 30.0f;
+
+//Size of each bucket of the frame time histogram, in seconds.
+const float FRAME_HISTOGRAM_BUCKET_SIZE = 0.0001f;
+
+//Number of buckets in the frame time histogram. The last one also
+//gets all frames that took longer than that.
+const size_t FRAME_HISTOGRAM_NR_BUCKETS = 2000;
+
+//When writing the frame time histogram, join this many buckets per row.
+const size_t FRAME_HISTOGRAM_ROW_BUCKETS = 10;
+
+//Maximum number of frames a single spike capture can have.
+const size_t MAX_SPIKE_CAPTURE_FRAMES = 30;
+
+//Maximum number of spike captures to keep.
+const size_t MAX_SPIKE_CAPTURES = 10;
+
+//Maximum number of trace events a thread can keep per state.
+//Zones past this still count for the report.
+const size_t MAX_TRACE_EVENTS = 200000;
+
+//How many frames before and after a spike to capture.
+const size_t SPIKE_NEIGHBOR_FRAMES = 3;
+
+}
+
+
 namespace WHISTLE {
 
 //R, G, and B components for each dot color.
@@ -585,6 +617,7 @@ maker_tools_t::maker_tools_t() :
     last_pikmin_type(nullptr),
     mob_hurting_ratio(0.75),
     path_info(false),
+    perf_mon_frame_budget(PERF_MON::DEF_FRAME_BUDGET),
     use_perf_mon(false),
     used_helping_tools(false) {
     
@@ -616,6 +649,7 @@ void maker_tools_t::reset_for_gameplay() {
  * @brief Hides the OS mouse in the game window.
  */
 void mouse_cursor_t::hide() const {
+    if(!game.display) return;
     al_hide_mouse_cursor(game.display);
 }
 
@@ -642,10 +676,12 @@ void mouse_cursor_t::init() {
  * @brief Resets the cursor's state.
  */
 void mouse_cursor_t::reset() {
-    ALLEGRO_MOUSE_STATE mouse_state;
-    al_get_mouse_state(&mouse_state);
-    game.mouse_cursor.s_pos.x = al_get_mouse_state_axis(&mouse_state, 0);
-    game.mouse_cursor.s_pos.y = al_get_mouse_state_axis(&mouse_state, 1);
+    if(al_is_mouse_installed()) {
+        ALLEGRO_MOUSE_STATE mouse_state;
+        al_get_mouse_state(&mouse_state);
+        game.mouse_cursor.s_pos.x = al_get_mouse_state_axis(&mouse_state, 0);
+        game.mouse_cursor.s_pos.y = al_get_mouse_state_axis(&mouse_state, 1);
+    }
     game.mouse_cursor.w_pos = game.mouse_cursor.s_pos;
     al_transform_coordinates(
         &game.screen_to_world_transform,
@@ -659,6 +695,7 @@ void mouse_cursor_t::reset() {
  * @brief Shows the OS mouse in the game window.
  */
 void mouse_cursor_t::show() const {
+    if(!game.display) return;
     al_show_mouse_cursor(game.display);
 }
 
@@ -826,6 +863,34 @@ void notification_t::tick(float delta_t) {
 }
 
 
+/**
+ * @brief Constructs a new performance monitor zone object, and starts
+ * measuring the zone.
+ *
+ * @param zone_id ID of the zone, obtained with
+ * performance_monitor_t::get_zone_id().
+ */
+perf_zone::perf_zone(size_t zone_id) {
+    if(game.perf_mon && game.perf_mon->start_zone(zone_id)) {
+        monitor = game.perf_mon;
+    }
+}
+
+
+/**
+ * @brief Destroys the performance monitor zone object, finishing
+ * the zone's measurement.
+ */
+perf_zone::~perf_zone() {
+    if(monitor) monitor->finish_zone();
+}
+
+
+vector<string> performance_monitor_t::zone_names;
+map<string, size_t> performance_monitor_t::zone_ids;
+std::mutex performance_monitor_t::zones_mutex;
+
+
 /**
  * @brief Constructs a new performance monitor struct object.
  */
@@ -833,24 +898,131 @@ performance_monitor_t::performance_monitor_t() :
     cur_state(PERF_MON_STATE_LOADING),
     paused(false),
     cur_state_start_time(0.0),
-    cur_measurement_start_time(0.0),
     frame_samples(0) {
     
+    static size_t next_instance_nr = 1;
+    instance_nr = next_instance_nr;
+    next_instance_nr++;
+    
+    main_buffer = get_thread_buffer();
+    
     reset();
 }
 
 
+/**
+ * @brief Keeps the current frame around in case a spike comes next,
+ * and captures the frames around spikes.
+ */
+void performance_monitor_t::capture_spikes() {
+    bool is_spike = cur_page.duration > frame_budget;
+    if(is_spike) nr_frame_spikes++;
+    
+    frame_record cur_frame;
+    cur_frame.frame_nr = frame_samples;
+    cur_frame.info = cur_page;
+    
+    if(!spike_captures.empty() && spike_captures.back().frames_left > 0) {
+        //Still capturing the frames after a spike.
+        spike_capture &capture = spike_captures.back();
+        capture.frames.push_back(cur_frame);
+        capture.frames_left--;
+        if(is_spike) {
+            capture.frames_left = PERF_MON::SPIKE_NEIGHBOR_FRAMES;
+        }
+        if(capture.frames.size() >= PERF_MON::MAX_SPIKE_CAPTURE_FRAMES) {
+            capture.frames_left = 0;
+        }
+        
+    } else if(
+        is_spike && spike_captures.size() < PERF_MON::MAX_SPIKE_CAPTURES
+    ) {
+        //New spike. Start with the frames before it, oldest first.
+        spike_capture capture;
+        size_t oldest_idx =
+            recent_frames.size() < PERF_MON::SPIKE_NEIGHBOR_FRAMES ?
+            0 :
+            recent_frames_next_idx;
+        for(size_t f = 0; f < recent_frames.size(); f++) {
+            capture.frames.push_back(
+                recent_frames[(oldest_idx + f) % recent_frames.size()]
+            );
+        }
+        capture.frames.push_back(cur_frame);
+        capture.frames_left = PERF_MON::SPIKE_NEIGHBOR_FRAMES;
+        spike_captures.push_back(capture);
+        
+    }
+    
+    //Remember this frame.
+    if(PERF_MON::SPIKE_NEIGHBOR_FRAMES == 0) return;
+    if(recent_frames.size() < PERF_MON::SPIKE_NEIGHBOR_FRAMES) {
+        recent_frames.push_back(cur_frame);
+    } else {
+        recent_frames[recent_frames_next_idx] = cur_frame;
+    }
+    recent_frames_next_idx =
+        (recent_frames_next_idx + 1) % PERF_MON::SPIKE_NEIGHBOR_FRAMES;
+}
+
+
+/**
+ * @brief Empties the current page and every thread's trace events,
+ * so that a new state can start being measured.
+ */
+void performance_monitor_t::clear_cur_info() {
+    cur_page.clear();
+    clear_trace();
+    
+    //Zones that are still open belong to the old page.
+    for(size_t z = 0; z < main_buffer->open_zones.size(); z++) {
+        main_buffer->open_zones[z].node_idx = INVALID;
+    }
+}
+
+
+/**
+ * @brief Empties every thread's trace events.
+ * This assumes no other thread is measuring anything at the moment.
+ */
+void performance_monitor_t::clear_trace() {
+    std::lock_guard<std::mutex> lock(thread_buffers_mutex);
+    for(size_t b = 0; b < thread_buffers.size(); b++) {
+        thread_buffers[b]->events.clear();
+    }
+}
+
+
+/**
+ * @brief Copies every thread's trace events into a list.
+ * This assumes no other thread is measuring anything at the moment.
+ *
+ * @param out_trace The trace events are returned here.
+ */
+void performance_monitor_t::collect_trace(vector<trace_event>* out_trace) {
+    out_trace->clear();
+    std::lock_guard<std::mutex> lock(thread_buffers_mutex);
+    for(size_t b = 0; b < thread_buffers.size(); b++) {
+        const vector<trace_event> &events = thread_buffers[b]->events;
+        out_trace->insert(out_trace->end(), events.begin(), events.end());
+    }
+}
+
+
 /**
  * @brief Enters the given state of the monitoring process.
+ * If it's already in that state, like when several logic ticks run
+ * before a frame gets drawn, it keeps adding to the same page.
  *
  * @param state New state.
  */
 void performance_monitor_t::enter_state(const PERF_MON_STATE state) {
     if(paused) return;
+    if(cur_state_start_time != 0.0 && cur_state == state) return;
     
     cur_state = state;
     cur_state_start_time = al_get_time();
-    cur_page = page();
+    clear_cur_info();
     
     if(cur_state == PERF_MON_STATE_FRAME) {
         frame_samples++;
@@ -859,50 +1031,263 @@ void performance_monitor_t::enter_state(const PERF_MON_STATE state) {
 
 
 /**
- * @brief Finishes the latest measurement.
+ * @brief Finishes the latest measurement started with start_measurement().
+ * This is always done, even if the monitor was paused at any point, so that
+ * the measurements started and finished stay paired up.
  */
 void performance_monitor_t::finish_measurement() {
-    if(paused) return;
+    finish_zone();
+}
+
+
+/**
+ * @brief Finishes measuring the latest zone started on the current thread.
+ * If the monitor is paused, or the zone was only a placeholder,
+ * the zone is closed without recording anything.
+ */
+void performance_monitor_t::finish_zone() {
+    double end_time = al_get_time();
+    thread_buffer* buffer = get_thread_buffer();
     
     //Check if we were measuring something.
     engine_assert(
-        cur_measurement_start_time != 0.0,
-        cur_page.measurements.empty() ?
-        "(No measurements)" :
-        "Last measurement: " + cur_page.measurements.back().first
+        !buffer->open_zones.empty(),
+        "No zone to finish on thread " + i2s(buffer->thread_nr) + "."
     );
     
-    double dur = al_get_time() - cur_measurement_start_time;
-    bool is_new = true;
+    const open_zone &zone = buffer->open_zones.back();
+    if(paused || zone.zone_id == INVALID) {
+        buffer->open_zones.pop_back();
+        return;
+    }
+    double dur = end_time - zone.start_time;
+    
+    if(zone.node_idx != INVALID) {
+        cur_page.nodes[zone.node_idx].duration += dur;
+    }
+    
+    if(buffer->events.size() < PERF_MON::MAX_TRACE_EVENTS) {
+        trace_event event;
+        event.zone_id = zone.zone_id;
+        event.thread_nr = buffer->thread_nr;
+        event.start_time = zone.start_time;
+        event.duration = dur;
+        buffer->events.push_back(event);
+    }
     
-    for(size_t m = 0; m < cur_page.measurements.size(); m++) {
-        if(cur_page.measurements[m].first == cur_measurement_name) {
-            cur_page.measurements[m].second += dur;
-            is_new = false;
-            break;
+    buffer->open_zones.pop_back();
+}
+
+
+/**
+ * @brief Returns the frame processing time that the given percentage of
+ * sampled frames took at most. This is an estimate, based on the
+ * frame time histogram.
+ *
+ * @param percentile Percentage of frames, from 0 to 100.
+ * @return The time, in seconds, or 0 if no frames were sampled.
+ */
+double performance_monitor_t::get_frame_time_percentile(
+    float percentile
+) const {
+    size_t nr_frames = 0;
+    for(size_t b = 0; b < frame_histogram.size(); b++) {
+        nr_frames += frame_histogram[b];
+    }
+    if(nr_frames == 0) return 0.0;
+    
+    double target = nr_frames * clamp(percentile, 0.0f, 100.0f) / 100.0;
+    size_t nr_frames_so_far = 0;
+    for(size_t b = 0; b < frame_histogram.size(); b++) {
+        if(frame_histogram[b] == 0) continue;
+        if(nr_frames_so_far + frame_histogram[b] >= target) {
+            if(b == frame_histogram.size() - 1) {
+                //The last bucket has no upper limit.
+                return frame_max_duration;
+            }
+            //Assume the frames are spread evenly inside the bucket.
+            double ratio =
+                (target - nr_frames_so_far) / (double) frame_histogram[b];
+            return
+                std::min(
+                    (b + ratio) * PERF_MON::FRAME_HISTOGRAM_BUCKET_SIZE,
+                    frame_max_duration
+                );
         }
+        nr_frames_so_far += frame_histogram[b];
     }
-    if(is_new) {
-        cur_page.measurements.push_back(
-            std::make_pair(cur_measurement_name, dur)
+    return frame_max_duration;
+}
+
+
+/**
+ * @brief Returns a human-friendly report with all known stats.
+ *
+ * @return The report.
+ */
+string performance_monitor_t::get_report() const {
+    //Average out the frames of gameplay.
+    page avg_page = frame_avg_page;
+    avg_page.duration /= (double) frame_samples;
+    for(size_t n = 0; n < avg_page.nodes.size(); n++) {
+        avg_page.nodes[n].duration /= (double) frame_samples;
+    }
+    
+    //Fill out the string.
+    string s =
+        "\n" +
+        get_current_time(false) +
+        "; Pikifen version " + get_engine_version_string();
+    if(!game.config.version.empty()) {
+        s += ", game version " + game.config.version;
+    }
+    
+    s +=
+        "\nData from the latest played area, " + area_name + ", with " +
+        i2s(frame_samples) + " gameplay frames sampled.\n";
+        
+    s += "\nLoading times:\n";
+    loading_page.write(s);
+    
+    s += "\nAverage frame processing times:\n";
+    avg_page.write(s);
+    
+    s += "\nFastest frame processing times:\n";
+    frame_fastest_page.write(s);
+    
+    s += "\nSlowest frame processing times:\n";
+    frame_slowest_page.write(s);
+    
+    s +=
+        "\nFrame processing time percentiles:\n"
+        "  50%: " + std::to_string(get_frame_time_percentile(50.0f)) + "s\n"
+        "  95%: " + std::to_string(get_frame_time_percentile(95.0f)) + "s\n"
+        "  99%: " + std::to_string(get_frame_time_percentile(99.0f)) + "s\n"
+        "  99.9%: " + std::to_string(get_frame_time_percentile(99.9f)) +
+        "s\n";
+        
+    s += "\nFrame processing time histogram:\n";
+    write_frame_histogram(s);
+    
+    write_spikes(s);
+    
+    return s;
+}
+
+
+/**
+ * @brief Returns the results obtained for a given state of the
+ * monitoring process. For the frame state, these are the averages of
+ * all sampled frames. Zones nested inside others are named after
+ * all of their parents, like "Parent > Child".
+ *
+ * @param state State to get the results of.
+ * @param out_duration The total duration is returned here.
+ * @param out_measurements The individual measurements are returned here.
+ */
+void performance_monitor_t::get_results(
+    const PERF_MON_STATE state, double* out_duration,
+    vector<std::pair<string, double> >* out_measurements
+) const {
+    *out_duration = 0.0;
+    out_measurements->clear();
+    
+    const page* p = &loading_page;
+    double divisor = 1.0;
+    if(state == PERF_MON_STATE_FRAME) {
+        if(frame_samples == 0) return;
+        p = &frame_avg_page;
+        divisor = (double) frame_samples;
+    }
+    
+    *out_duration = p->duration / divisor;
+    
+    vector<string> full_names(p->nodes.size());
+    for(size_t n = 0; n < p->nodes.size(); n++) {
+        const page_node &node = p->nodes[n];
+        if(node.parent_idx != INVALID) {
+            full_names[n] = full_names[node.parent_idx] + " > ";
+        }
+        full_names[n] += get_zone_name(node.zone_id);
+        out_measurements->push_back(
+            std::make_pair(full_names[n], node.duration / divisor)
         );
     }
+}
+
+
+/**
+ * @brief Returns the buffer that belongs to the current thread,
+ * creating it if it doesn't exist yet.
+ *
+ * @return The buffer.
+ */
+performance_monitor_t::thread_buffer*
+performance_monitor_t::get_thread_buffer() {
+    //Cache for performance.
+    static thread_local size_t cached_instance_nr = 0;
+    static thread_local thread_buffer* cached_buffer = nullptr;
+    if(cached_instance_nr == instance_nr) return cached_buffer;
     
-    cur_measurement_start_time = 0.0;
+    std::lock_guard<std::mutex> lock(thread_buffers_mutex);
+    thread_buffer* new_buffer = new thread_buffer();
+    new_buffer->thread_nr = thread_buffers.size();
+    thread_buffers.push_back(std::unique_ptr<thread_buffer>(new_buffer));
+    
+    cached_instance_nr = instance_nr;
+    cached_buffer = new_buffer;
+    return new_buffer;
+}
+
+
+/**
+ * @brief Returns the ID of a zone, given its name. The first time a name
+ * is used, it gets a new ID. This is slow-ish, so code that runs often
+ * should only obtain the ID once.
+ *
+ * @param name Name of the zone.
+ * @return The ID.
+ */
+size_t performance_monitor_t::get_zone_id(const string &name) {
+    std::lock_guard<std::mutex> lock(zones_mutex);
+    auto it = zone_ids.find(name);
+    if(it != zone_ids.end()) return it->second;
+    
+    size_t id = zone_names.size();
+    zone_names.push_back(name);
+    zone_ids[name] = id;
+    return id;
+}
+
+
+/**
+ * @brief Returns the name of a zone, given its ID.
+ *
+ * @param zone_id ID of the zone.
+ * @return The name, or an empty string if the ID is unknown.
+ */
+string performance_monitor_t::get_zone_name(size_t zone_id) {
+    std::lock_guard<std::mutex> lock(zones_mutex);
+    if(zone_id >= zone_names.size()) return "";
+    return zone_names[zone_id];
 }
 
 
 /**
  * @brief Leaves the current state of the monitoring process.
+ * Does nothing if no state was entered since the last time.
  */
 void performance_monitor_t::leave_state() {
     if(paused) return;
+    if(cur_state_start_time == 0.0) return;
     
     cur_page.duration = al_get_time() - cur_state_start_time;
+    cur_state_start_time = 0.0;
     
     switch(cur_state) {
     case PERF_MON_STATE_LOADING: {
         loading_page = cur_page;
+        collect_trace(&loading_trace);
         break;
     }
     case PERF_MON_STATE_FRAME: {
@@ -917,40 +1302,28 @@ void performance_monitor_t::leave_state() {
             cur_page.duration > frame_slowest_page.duration
         ) {
             frame_slowest_page = cur_page;
+            collect_trace(&frame_slowest_trace);
             
         }
         
-        if(frame_avg_page.duration == 0.0) {
-            frame_avg_page = cur_page;
-        } else {
-            frame_avg_page.duration += cur_page.duration;
-            for(size_t m = 0; m < cur_page.measurements.size(); m++) {
-                bool is_new = true;
-                for(
-                    size_t m2 = 0;
-                    m2 < frame_avg_page.measurements.size(); m2++
-                ) {
-                    if(
-                        cur_page.measurements[m].first ==
-                        frame_avg_page.measurements[m2].first
-                    ) {
-                        frame_avg_page.measurements[m2].second +=
-                            cur_page.measurements[m].second;
-                        is_new = false;
-                        break;
-                    }
-                }
-                if(is_new) {
-                    frame_avg_page.measurements.push_back(
-                        cur_page.measurements[m]
-                    );
-                }
-            }
-        }
+        frame_avg_page.add(cur_page);
+        
+        //Frame time histogram.
+        size_t bucket =
+            (size_t) (
+                cur_page.duration / PERF_MON::FRAME_HISTOGRAM_BUCKET_SIZE
+            );
+        bucket = std::min(bucket, PERF_MON::FRAME_HISTOGRAM_NR_BUCKETS - 1);
+        frame_histogram[bucket]++;
+        frame_max_duration = std::max(frame_max_duration, cur_page.duration);
+        
+        capture_spikes();
         break;
         
     }
     }
+    
+    clear_trace();
 }
 
 
@@ -962,58 +1335,36 @@ void performance_monitor_t::reset() {
     cur_state = PERF_MON_STATE_LOADING;
     paused = false;
     cur_state_start_time = 0.0;
-    cur_measurement_start_time = 0.0;
-    cur_measurement_name.clear();
-    cur_page = page();
+    clear_cur_info();
     frame_samples = 0;
     loading_page = page();
+    loading_trace.clear();
     frame_avg_page = page();
     frame_fastest_page = page();
     frame_slowest_page = page();
+    frame_slowest_trace.clear();
+    frame_histogram.assign(PERF_MON::FRAME_HISTOGRAM_NR_BUCKETS, 0);
+    frame_max_duration = 0.0;
+    nr_frame_spikes = 0;
+    spike_captures.clear();
+    recent_frames.clear();
+    recent_frames_next_idx = 0;
 }
 
 
 /**
  * @brief Saves a log file with all known stats, if there is anything to save.
+ * Also saves the trace file.
  */
 void performance_monitor_t::save_log() {
-    if(loading_page.measurements.empty()) {
+    if(loading_page.nodes.empty()) {
         //Nothing to save.
         return;
     }
     
-    //Average out the frames of gameplay.
-    frame_avg_page.duration /= (double) frame_samples;
-    for(size_t m = 0; m < frame_avg_page.measurements.size(); m++) {
-        frame_avg_page.measurements[m].second /= (double) frame_samples;
-    }
+    string s = get_report();
     
-    //Fill out the string.
-    string s =
-        "\n" +
-        get_current_time(false) +
-        "; Pikifen version " + get_engine_version_string();
-    if(!game.config.version.empty()) {
-        s += ", game version " + game.config.version;
-    }
-    
-    s +=
-        "\nData from the latest played area, " + area_name + ", with " +
-        i2s(frame_samples) + " gameplay frames sampled.\n";
-        
-    s += "\nLoading times:\n";
-    loading_page.write(s);
-    
-    s += "\nAverage frame processing times:\n";
-    frame_avg_page.write(s);
-    
-    s += "\nFastest frame processing times:\n";
-    frame_fastest_page.write(s);
-    
-    s += "\nSlowest frame processing times:\n";
-    frame_slowest_page.write(s);
-    
-    //Finally, write the string to a file.
+    //Write the string to a file.
     string prev_log;
     ALLEGRO_FILE* file_i =
         al_fopen(FILE_PATHS_FROM_ROOT::PERFORMANCE_LOG.c_str(), "r");
@@ -1033,6 +1384,31 @@ void performance_monitor_t::save_log() {
         al_fwrite(file_o, prev_log + s);
         al_fclose(file_o);
     }
+    
+    save_trace(FILE_PATHS_FROM_ROOT::PERFORMANCE_TRACE);
+}
+
+
+/**
+ * @brief Saves the zones of the loading process and of the slowest frame
+ * to a file, in the Chrome trace event format. Each of the two shows up
+ * as its own process in a trace viewer.
+ *
+ * @param path Path to the file to save to.
+ * @return Whether it succeeded.
+ */
+bool performance_monitor_t::save_trace(const string &path) const {
+    string s = "{\"traceEvents\":[";
+    bool first = true;
+    write_trace(s, loading_trace, 1, "Loading", &first);
+    write_trace(s, frame_slowest_trace, 2, "Slowest frame", &first);
+    s += "\n],\"displayTimeUnit\":\"ms\"}\n";
+    
+    ALLEGRO_FILE* file = al_fopen(path.c_str(), "w");
+    if(!file) return false;
+    al_fwrite(file, s);
+    al_fclose(file);
+    return true;
 }
 
 
@@ -1046,6 +1422,17 @@ void performance_monitor_t::set_area_name(const string &name) {
 }
 
 
+/**
+ * @brief Sets the frame processing time budget. Frames that take longer
+ * count as spikes.
+ *
+ * @param budget Budget, in seconds.
+ */
+void performance_monitor_t::set_frame_budget(float budget) {
+    frame_budget = budget;
+}
+
+
 /**
  * @brief Sets whether monitoring is currently paused or not.
  *
@@ -1058,22 +1445,257 @@ void performance_monitor_t::set_paused(bool paused) {
 
 /**
  * @brief Starts measuring a certain point in the loading procedure.
+ * This looks the zone up by name, so code that runs often should
+ * use start_zone() or perf_zone instead.
  *
  * @param name Name of the measurement.
  */
 void performance_monitor_t::start_measurement(const string &name) {
-    if(paused) return;
+    if(!paused) {
+        start_zone(get_zone_id(name));
+        return;
+    }
     
-    //Check if we were already measuring something.
-    engine_assert(
-        cur_measurement_start_time == 0.0,
-        cur_page.measurements.empty() ?
-        "(No measurements)" :
-        "Last measurement: " + cur_page.measurements.back().first
-    );
+    //Open a placeholder zone, so that finish_measurement() has something
+    //to close even if the monitor gets unpaused in the meantime.
+    get_thread_buffer()->open_zones.push_back(open_zone());
+}
+
+
+/**
+ * @brief Starts measuring a zone on the current thread. If another zone
+ * is being measured on this thread, the new one is nested inside it.
+ *
+ * @param zone_id ID of the zone, obtained with get_zone_id().
+ * @return Whether it started. If not, it must not be finished.
+ */
+bool performance_monitor_t::start_zone(size_t zone_id) {
+    if(paused) return false;
+    
+    thread_buffer* buffer = get_thread_buffer();
+    open_zone zone;
+    zone.zone_id = zone_id;
+    
+    if(buffer == main_buffer) {
+        size_t parent_idx =
+            buffer->open_zones.empty() ?
+            INVALID :
+            buffer->open_zones.back().node_idx;
+        zone.node_idx = cur_page.get_node(parent_idx, zone_id);
+    }
     
-    cur_measurement_start_time = al_get_time();
-    cur_measurement_name = name;
+    zone.start_time = al_get_time();
+    buffer->open_zones.push_back(zone);
+    return true;
+}
+
+
+/**
+ * @brief Writes the frame processing time histogram in a human-friendly
+ * format onto a string. Each row joins several buckets, and only the rows
+ * between the fastest and slowest frames are written.
+ *
+ * @param s String to write to.
+ */
+void performance_monitor_t::write_frame_histogram(string &s) const {
+    const size_t row_size = PERF_MON::FRAME_HISTOGRAM_ROW_BUCKETS;
+    size_t nr_rows = (frame_histogram.size() + row_size - 1) / row_size;
+    vector<size_t> rows(nr_rows, 0);
+    for(size_t b = 0; b < frame_histogram.size(); b++) {
+        rows[b / row_size] += frame_histogram[b];
+    }
+    
+    size_t first_row = INVALID;
+    size_t last_row = INVALID;
+    size_t biggest_row = 0;
+    for(size_t r = 0; r < nr_rows; r++) {
+        if(rows[r] == 0) continue;
+        if(first_row == INVALID) first_row = r;
+        last_row = r;
+        biggest_row = std::max(biggest_row, rows[r]);
+    }
+    if(first_row == INVALID) {
+        s += "  (No frames sampled.)\n";
+        return;
+    }
+    
+    float row_duration = PERF_MON::FRAME_HISTOGRAM_BUCKET_SIZE * row_size;
+    for(size_t r = first_row; r <= last_row; r++) {
+        string range =
+            std::to_string(r * row_duration) + "s" +
+            (
+                r == nr_rows - 1 ?
+                " or more" :
+                " to " + std::to_string((r + 1) * row_duration) + "s"
+            );
+        size_t bar_size =
+            (size_t) ceil(rows[r] / (float) biggest_row * 50.0f);
+        s +=
+            "  " + box_string(range, 24) +
+            box_string(i2s(rows[r]), 8) + string(bar_size, '#') + "\n";
+    }
+}
+
+
+/**
+ * @brief Writes the frames captured around frame spikes in a
+ * human-friendly format onto a string.
+ *
+ * @param s String to write to.
+ */
+void performance_monitor_t::write_spikes(string &s) const {
+    s +=
+        "\nFrame spikes: " + i2s(nr_frame_spikes) +
+        " frames took longer than the budget of " +
+        std::to_string(frame_budget) + "s.\n";
+        
+    for(size_t c = 0; c < spike_captures.size(); c++) {
+        const spike_capture &capture = spike_captures[c];
+        s += "\nSpike capture " + i2s(c + 1) + ":\n";
+        for(size_t f = 0; f < capture.frames.size(); f++) {
+            const frame_record &frame = capture.frames[f];
+            s +=
+                "\n Frame " + i2s(frame.frame_nr) +
+                (frame.info.duration > frame_budget ? " (spike)" : "") +
+                ":\n";
+            frame.info.write(s);
+        }
+    }
+    
+    if(spike_captures.size() == PERF_MON::MAX_SPIKE_CAPTURES) {
+        s +=
+            "\n(At most " + i2s(PERF_MON::MAX_SPIKE_CAPTURES) +
+            " spike captures are kept.)\n";
+    }
+}
+
+
+/**
+ * @brief Writes a list of trace events onto a string, in the
+ * Chrome trace event format. Times are written in microseconds,
+ * relative to the earliest event.
+ *
+ * @param s String to write to.
+ * @param trace Trace events to write.
+ * @param process_nr Number of the process to write them as.
+ * @param process_name Name of the process to write them as.
+ * @param first Whether no event was written onto the string yet.
+ * This gets set to false if something gets written.
+ */
+void performance_monitor_t::write_trace(
+    string &s, const vector<trace_event> &trace,
+    size_t process_nr, const string &process_name, bool* first
+) {
+    if(trace.empty()) return;
+    
+    double start_time = trace[0].start_time;
+    size_t max_thread_nr = 0;
+    for(size_t e = 0; e < trace.size(); e++) {
+        start_time = std::min(start_time, trace[e].start_time);
+        max_thread_nr = std::max(max_thread_nr, trace[e].thread_nr);
+    }
+    
+    string pid_str = ",\"pid\":" + i2s(process_nr);
+    
+    s += *first ? "\n" : ",\n";
+    *first = false;
+    s +=
+        "{\"name\":\"process_name\",\"ph\":\"M\"" + pid_str +
+        ",\"tid\":0,\"args\":{\"name\":" + to_json_string(process_name) +
+        "}}";
+        
+    for(size_t t = 0; t <= max_thread_nr; t++) {
+        string thread_name = t == 0 ? "Main thread" : "Thread " + i2s(t);
+        s +=
+            ",\n{\"name\":\"thread_name\",\"ph\":\"M\"" + pid_str +
+            ",\"tid\":" + i2s(t) +
+            ",\"args\":{\"name\":" + to_json_string(thread_name) + "}}";
+    }
+    
+    for(size_t e = 0; e < trace.size(); e++) {
+        const trace_event &event = trace[e];
+        s +=
+            ",\n{\"name\":" + to_json_string(get_zone_name(event.zone_id)) +
+            ",\"ph\":\"X\"" + pid_str +
+            ",\"tid\":" + i2s(event.thread_nr) +
+            ",\"ts\":" +
+            to_json_number((event.start_time - start_time) * 1000000.0) +
+            ",\"dur\":" + to_json_number(event.duration * 1000000.0) + "}";
+    }
+}
+
+
+/**
+ * @brief Adds the durations of another page's zones to this page's.
+ * Zones this page doesn't have yet are added too.
+ *
+ * @param other Page to add.
+ */
+void performance_monitor_t::page::add(const page &other) {
+    duration += other.duration;
+    
+    //Parents always come before their children, so by the time a node
+    //is added, its parent already has a matching node here.
+    vector<size_t> node_map(other.nodes.size(), INVALID);
+    for(size_t n = 0; n < other.nodes.size(); n++) {
+        const page_node &node = other.nodes[n];
+        size_t parent_idx =
+            node.parent_idx == INVALID ? INVALID : node_map[node.parent_idx];
+        node_map[n] = get_node(parent_idx, node.zone_id);
+        nodes[node_map[n]].duration += node.duration;
+    }
+}
+
+
+/**
+ * @brief Clears the page's information.
+ * Unlike creating a new page, this keeps the memory around.
+ */
+void performance_monitor_t::page::clear() {
+    duration = 0.0;
+    nodes.clear();
+    first_root_idx = INVALID;
+}
+
+
+/**
+ * @brief Returns the index of the node for the given zone, under the
+ * given parent node. If there is no such node yet, it gets added.
+ *
+ * @param parent_idx Index of the parent node, or INVALID for a root node.
+ * @param zone_id ID of the zone.
+ * @return The node's index.
+ */
+size_t performance_monitor_t::page::get_node(
+    size_t parent_idx, size_t zone_id
+) {
+    size_t first_idx =
+        parent_idx == INVALID ?
+        first_root_idx :
+        nodes[parent_idx].first_child_idx;
+        
+    size_t last_idx = INVALID;
+    for(size_t n = first_idx; n != INVALID; n = nodes[n].next_sibling_idx) {
+        if(nodes[n].zone_id == zone_id) return n;
+        last_idx = n;
+    }
+    
+    //It's new.
+    size_t new_idx = nodes.size();
+    page_node new_node;
+    new_node.zone_id = zone_id;
+    new_node.parent_idx = parent_idx;
+    nodes.push_back(new_node);
+    
+    if(last_idx != INVALID) {
+        nodes[last_idx].next_sibling_idx = new_idx;
+    } else if(parent_idx != INVALID) {
+        nodes[parent_idx].first_child_idx = new_idx;
+    } else {
+        first_root_idx = new_idx;
+    }
+    
+    return new_idx;
 }
 
 
@@ -1082,20 +1704,22 @@ void performance_monitor_t::start_measurement(const string &name) {
  *
  * @param s String to write to.
  */
-void performance_monitor_t::page::write(string &s) {
+void performance_monitor_t::page::write(string &s) const {
     //Get the total measured time.
     double total_measured_time = 0.0;
-    for(size_t m = 0; m < measurements.size(); m++) {
-        total_measured_time += measurements[m].second;
+    for(
+        size_t n = first_root_idx; n != INVALID;
+        n = nodes[n].next_sibling_idx
+    ) {
+        total_measured_time += nodes[n].duration;
     }
     
-    //Write each measurement into the string.
-    for(size_t m = 0; m < measurements.size(); m++) {
-        write_measurement(
-            s, measurements[m].first,
-            measurements[m].second,
-            total_measured_time
-        );
+    //Write each zone into the string.
+    for(
+        size_t n = first_root_idx; n != INVALID;
+        n = nodes[n].next_sibling_idx
+    ) {
+        write_node(s, n, 0, total_measured_time);
     }
     
     //Write the total.
@@ -1107,21 +1731,24 @@ void performance_monitor_t::page::write(string &s) {
 
 
 /**
- * @brief Writes a measurement in a human-friendly format onto a string.
+ * @brief Writes a node, and the nodes nested inside it, in a
+ * human-friendly format onto a string.
  *
  * @param str The string to write to.
- * @param name The name of this measurement.
- * @param dur How long it lasted for, in seconds.
+ * @param node_idx Index of the node.
+ * @param depth How deeply nested the node is. 0 for root nodes.
  * @param total How long the entire procedure lasted for.
  */
-void performance_monitor_t::page::write_measurement(
-    string &str, const string &name, double dur, float total
-) {
-    float perc = dur / total * 100.0;
+void performance_monitor_t::page::write_node(
+    string &str, size_t node_idx, size_t depth, double total
+) const {
+    const page_node &node = nodes[node_idx];
+    string indent(depth * 2, ' ');
+    float perc = node.duration / total * 100.0;
     str +=
-        "  " + name + "\n" +
-        "    " + box_string(std::to_string(dur), 8, "s") +
-        " (" + f2s(perc) + "%)\n    ";
+        "  " + indent + get_zone_name(node.zone_id) + "\n" +
+        "    " + indent + box_string(std::to_string(node.duration), 8, "s") +
+        " (" + f2s(perc) + "%)\n    " + indent;
     for(unsigned char p = 0; p < 100; p++) {
         if(p < perc) {
             str.push_back('#');
@@ -1130,6 +1757,13 @@ void performance_monitor_t::page::write_measurement(
         }
     }
     str += "\n";
+    
+    for(
+        size_t c = node.first_child_idx; c != INVALID;
+        c = nodes[c].next_sibling_idx
+    ) {
+        write_node(str, c, depth + 1, total);
+    }
 }
 
 
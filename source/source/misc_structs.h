@@ -13,6 +13,8 @@
 
 #include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 #include <allegro5/allegro.h>
@@ -58,6 +60,18 @@ extern const float FADE_SPEED;
 }
 
 
+namespace PERF_MON {
+extern const float DEF_FRAME_BUDGET;
+extern const float FRAME_HISTOGRAM_BUCKET_SIZE;
+extern const size_t FRAME_HISTOGRAM_NR_BUCKETS;
+extern const size_t FRAME_HISTOGRAM_ROW_BUCKETS;
+extern const size_t MAX_SPIKE_CAPTURE_FRAMES;
+extern const size_t MAX_SPIKE_CAPTURES;
+extern const size_t MAX_TRACE_EVENTS;
+extern const size_t SPIKE_NEIGHBOR_FRAMES;
+}
+
+
 namespace WHISTLE {
 constexpr unsigned char N_RING_COLORS = 8;
 constexpr unsigned char N_DOT_COLORS = 6;
@@ -507,6 +521,9 @@ struct maker_tools_t {
     //Show path info?
     bool path_info = false;
     
+    //Performance monitor frames that take longer than this count as spikes.
+    float perf_mon_frame_budget = PERF_MON::DEF_FRAME_BUDGET;
+    
     //Use the performance monitor?
     bool use_perf_mon = false;
     
@@ -950,6 +967,12 @@ enum PERF_MON_STATE {
 /**
  * @brief Info about how long certain things took. Useful for makers
  * to monitor performance with.
+ *
+ * Measurements are done in zones, which can be nested inside one another,
+ * and are identified by a number obtained from the zone's name once.
+ * Zones can be measured from any thread, but only the main thread's zones
+ * go into the report. All threads' zones go into the trace file, which
+ * can be opened with a trace viewer, like Chrome's "about:tracing".
  */
 struct performance_monitor_t {
 
@@ -960,17 +983,56 @@ struct performance_monitor_t {
     performance_monitor_t();
     void set_area_name(const string &name);
     void set_paused(bool paused);
+    void set_frame_budget(float budget);
     void enter_state(const PERF_MON_STATE mode);
     void leave_state();
+    bool start_zone(size_t zone_id);
+    void finish_zone();
     void start_measurement(const string &name);
     void finish_measurement();
+    string get_report() const;
+    double get_frame_time_percentile(float percentile) const;
+    void get_results(
+        const PERF_MON_STATE state, double* out_duration,
+        vector<std::pair<string, double> >* out_measurements
+    ) const;
     void save_log();
+    bool save_trace(const string &path) const;
     void reset();
+    static size_t get_zone_id(const string &name);
+    static string get_zone_name(size_t zone_id);
     
     private:
     
     //--- Misc. declarations ---
     
+    /**
+     * @brief A zone in a page of the report, and how long
+     * it took in total.
+     */
+    struct page_node {
+    
+        public:
+        
+        //--- Members ---
+        
+        //ID of the zone.
+        size_t zone_id = INVALID;
+        
+        //Index of the parent node, or INVALID if it's a root node.
+        size_t parent_idx = INVALID;
+        
+        //Index of the first child node, or INVALID if none.
+        size_t first_child_idx = INVALID;
+        
+        //Index of the next node with the same parent, or INVALID if none.
+        size_t next_sibling_idx = INVALID;
+        
+        //How long it took in total.
+        double duration = 0.0;
+        
+    };
+    
     /**
      * @brief A page in the report.
      */
@@ -983,22 +1045,126 @@ struct performance_monitor_t {
         //How long it lasted for in total.
         double duration = 0.0f;
         
-        //Measurements took, and how long each one took.
-        vector<std::pair<string, double> > measurements;
+        //Zones measured, in a tree. Parents always come before children.
+        vector<page_node> nodes;
+        
+        //Index of the first root node, or INVALID if none.
+        size_t first_root_idx = INVALID;
         
         
         //--- Function declarations ---
         
-        void write(string &s);
+        void add(const page &other);
+        void clear();
+        size_t get_node(size_t parent_idx, size_t zone_id);
+        void write(string &s) const;
         
         private:
         
         //--- Function declarations ---
         
-        void write_measurement(
-            string &str, const string &name,
-            double time, float total
-        );
+        void write_node(
+            string &str, size_t node_idx, size_t depth, double total
+        ) const;
+    };
+    
+    /**
+     * @brief One run of a zone, for the trace file.
+     */
+    struct trace_event {
+    
+        public:
+        
+        //--- Members ---
+        
+        //ID of the zone.
+        size_t zone_id = INVALID;
+        
+        //Number of the thread it ran on.
+        size_t thread_nr = 0;
+        
+        //When it started.
+        double start_time = 0.0;
+        
+        //How long it took.
+        double duration = 0.0;
+        
+    };
+    
+    /**
+     * @brief A zone that a thread is measuring right now.
+     */
+    struct open_zone {
+    
+        public:
+        
+        //--- Members ---
+        
+        //ID of the zone.
+        size_t zone_id = INVALID;
+        
+        //Index of its node in the current page, or INVALID if none.
+        size_t node_idx = INVALID;
+        
+        //When it started.
+        double start_time = 0.0;
+        
+    };
+    
+    /**
+     * @brief A page of information about one sampled frame.
+     */
+    struct frame_record {
+    
+        public:
+        
+        //--- Members ---
+        
+        //Number of the frame, starting at 1.
+        size_t frame_nr = 0;
+        
+        //Information about the frame.
+        performance_monitor_t::page info;
+        
+    };
+    
+    /**
+     * @brief The frames around a frame spike, or around a series of
+     * spikes close to one another.
+     */
+    struct spike_capture {
+    
+        public:
+        
+        //--- Members ---
+        
+        //Frames captured, from oldest to newest.
+        vector<frame_record> frames;
+        
+        //How many frames after the latest spike are left to capture.
+        size_t frames_left = 0;
+        
+    };
+    
+    /**
+     * @brief Zone info that belongs to one thread, so that threads
+     * never have to wait on one another to measure something.
+     */
+    struct thread_buffer {
+    
+        public:
+        
+        //--- Members ---
+        
+        //Number of the thread. The main thread is number 0.
+        size_t thread_nr = 0;
+        
+        //Zones being measured right now, from outermost to innermost.
+        vector<open_zone> open_zones;
+        
+        //Zones finished since the current state began.
+        vector<trace_event> events;
+        
     };
     
     
@@ -1016,12 +1182,6 @@ struct performance_monitor_t {
     //When the current state began.
     double cur_state_start_time = 0.0f;
     
-    //When the current measurement began.
-    double cur_measurement_start_time = 0.0f;
-    
-    //Name of the current measurement.
-    string cur_measurement_name;
-    
     //Page of information about the current working info.
     performance_monitor_t::page cur_page;
     
@@ -1031,6 +1191,9 @@ struct performance_monitor_t {
     //Page of information about the loading process.
     performance_monitor_t::page loading_page;
     
+    //Trace events of the loading process.
+    vector<trace_event> loading_trace;
+    
     //Page of information about the average frame.
     performance_monitor_t::page frame_avg_page;
     
@@ -1040,6 +1203,91 @@ struct performance_monitor_t {
     //Page of information about the slowest frame.
     performance_monitor_t::page frame_slowest_page;
     
+    //Trace events of the slowest frame.
+    vector<trace_event> frame_slowest_trace;
+    
+    //How many frames fall in each bucket of processing time.
+    vector<size_t> frame_histogram;
+    
+    //Longest time a frame took to process.
+    double frame_max_duration = 0.0;
+    
+    //Frames that take longer than this many seconds count as spikes.
+    float frame_budget = PERF_MON::DEF_FRAME_BUDGET;
+    
+    //How many frames were spikes.
+    size_t nr_frame_spikes = 0;
+    
+    //Frames captured around the spikes.
+    vector<spike_capture> spike_captures;
+    
+    //The latest frames, in case a spike comes next. This is a ring buffer.
+    vector<frame_record> recent_frames;
+    
+    //Index in the recent frames ring buffer to write the next frame to.
+    size_t recent_frames_next_idx = 0;
+    
+    //Number that identifies this monitor, for the threads' caches.
+    size_t instance_nr = 0;
+    
+    //Each thread's buffer.
+    vector<std::unique_ptr<thread_buffer> > thread_buffers;
+    
+    //Main thread's buffer. Cache for performance.
+    thread_buffer* main_buffer = nullptr;
+    
+    //Mutex for the list of thread buffers.
+    std::mutex thread_buffers_mutex;
+    
+    //Names of every zone, by zone ID.
+    static vector<string> zone_names;
+    
+    //ID of every zone, by name.
+    static map<string, size_t> zone_ids;
+    
+    //Mutex for the zone names and IDs.
+    static std::mutex zones_mutex;
+    
+    
+    //--- Function declarations ---
+    
+    void capture_spikes();
+    void clear_cur_info();
+    void clear_trace();
+    void collect_trace(vector<trace_event>* out_trace);
+    thread_buffer* get_thread_buffer();
+    void write_frame_histogram(string &s) const;
+    void write_spikes(string &s) const;
+    static void write_trace(
+        string &s, const vector<trace_event> &trace,
+        size_t process_nr, const string &process_name, bool* first
+    );
+    
+};
+
+
+/**
+ * @brief Measures a zone of the performance monitor for as long as it
+ * exists. Does nothing if the performance monitor is off.
+ */
+struct perf_zone {
+
+    public:
+    
+    //--- Function declarations ---
+    
+    explicit perf_zone(size_t zone_id);
+    ~perf_zone();
+    perf_zone(const perf_zone &) = delete;
+    perf_zone &operator=(const perf_zone &) = delete;
+    
+    private:
+    
+    //--- Members ---
+    
+    //Monitor the zone is being measured on, if any.
+    performance_monitor_t* monitor = nullptr;
+    
 };
 
 
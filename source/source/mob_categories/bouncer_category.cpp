@@ -67,22 +67,6 @@ mob_type* bouncer_category::create_type() {
 }
 
 
-/**
- * @brief Clears a bouncer from the list of bouncers.
- *
- * @param m The mob to erase.
- */
-void bouncer_category::erase_mob(mob* m) {
-    game.states.gameplay->mobs.bouncers.erase(
-        find(
-            game.states.gameplay->mobs.bouncers.begin(),
-            game.states.gameplay->mobs.bouncers.end(),
-            (bouncer*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of bouncer given its internal name,
  * or nullptr on error.
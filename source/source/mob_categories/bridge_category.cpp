@@ -67,22 +67,6 @@ mob_type* bridge_category::create_type() {
 }
 
 
-/**
- * @brief Clears a bridge from the list of bridges.
- *
- * @param m The mob to erase.
- */
-void bridge_category::erase_mob(mob* m) {
-    game.states.gameplay->mobs.bridges.erase(
-        find(
-            game.states.gameplay->mobs.bridges.begin(),
-            game.states.gameplay->mobs.bridges.end(),
-            (bridge*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of bridge given its internal name,
  * or nullptr on error.
@@ -68,22 +68,6 @@ mob_type* converter_category::create_type() {
 }
 
 
-/**
- * @brief Clears a converter from the list of converters.
- *
- * @param m The mob to erase.
- */
-void converter_category::erase_mob(mob* m) {
-    game.states.gameplay->mobs.converters.erase(
-        find(
-            game.states.gameplay->mobs.converters.begin(),
-            game.states.gameplay->mobs.converters.end(),
-            (converter*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of converter given its name,
  * or nullptr on error.
@@ -65,14 +65,6 @@ mob_type* custom_category::create_type() {
 }
 
 
-/**
- * @brief Clears a custom mob from the list of custom mobs.
- *
- * @param m The mob to erase.
- */
-void custom_category::erase_mob(mob* m) { }
-
-
 /**
  * @brief Returns a custom type given its internal name,
  * or nullptr on error.
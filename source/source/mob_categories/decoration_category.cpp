@@ -67,22 +67,6 @@ mob_type* decoration_category::create_type() {
 }
 
 
-/**
- * @brief Clears a decoration from the list of decorations.
- *
- * @param m The mob to erase.
- */
-void decoration_category::erase_mob(mob* m) {
-    game.states.gameplay->mobs.decorations.erase(
-        find(
-            game.states.gameplay->mobs.decorations.begin(),
-            game.states.gameplay->mobs.decorations.end(),
-            (decoration*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of decoration given its internal name,
  * or nullptr on error.
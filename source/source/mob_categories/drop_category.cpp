@@ -67,22 +67,6 @@ mob_type* drop_category::create_type() {
 }
 
 
-/**
- * @brief Clears a drop from the list of drops.
- *
- * @param m The mob to erase.
- */
-void drop_category::erase_mob(mob* m) {
-    game.states.gameplay->mobs.drops.erase(
-        find(
-            game.states.gameplay->mobs.drops.begin(),
-            game.states.gameplay->mobs.drops.end(),
-            (drop*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of drop given its internal name,
  * or nullptr on error.
@@ -67,22 +67,6 @@ mob_type* enemy_category::create_type() {
 }
 
 
-/**
- * @brief Clears an enemy from the list of enemies.
- *
- * @param m The mob to erase.
- */
-void enemy_category::erase_mob(mob* m) {
-    game.states.gameplay->mobs.enemies.erase(
-        find(
-            game.states.gameplay->mobs.enemies.begin(),
-            game.states.gameplay->mobs.enemies.end(),
-            (enemy*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of enemy given its internal name,
  * or nullptr on error.
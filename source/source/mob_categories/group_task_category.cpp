@@ -67,22 +67,6 @@ mob_type* group_task_category::create_type() {
 }
 
 
-/**
- * @brief Clears a group task from the list of group task.
- *
- * @param m The mob to erase.
- */
-void group_task_category::erase_mob(mob* m) {
-    game.states.gameplay->mobs.group_tasks.erase(
-        find(
-            game.states.gameplay->mobs.group_tasks.begin(),
-            game.states.gameplay->mobs.group_tasks.end(),
-            (group_task*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of group task given its internal name,
  * or nullptr on error.
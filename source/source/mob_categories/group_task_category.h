@@ -39,7 +39,6 @@ public:
     mob* create_mob(
         const point &pos, mob_type* type, float angle
     ) override;
-    void erase_mob(mob* m) override;
     void clear_types() override;
     
 };
@@ -67,22 +67,6 @@ mob_type* interactable_category::create_type() {
 }
 
 
-/**
- * @brief Clears an interactable from the list of interactables.
- *
- * @param m The mob to erase.
- */
-void interactable_category::erase_mob(mob* m) {
-    game.states.gameplay->mobs.interactables.erase(
-        find(
-            game.states.gameplay->mobs.interactables.begin(),
-            game.states.gameplay->mobs.interactables.end(),
-            (interactable*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of interactable given its name,
  * or nullptr on error.
@@ -70,18 +70,11 @@ mob_type* leader_category::create_type() {
 
 
 /**
- * @brief Clears a leader from the list of leaders.
+ * @brief Makes a leader that's about to be deleted run its death logic.
  *
  * @param m The mob to erase.
  */
 void leader_category::erase_mob(mob* m) {
-    game.states.gameplay->mobs.leaders.erase(
-        find(
-            game.states.gameplay->mobs.leaders.begin(),
-            game.states.gameplay->mobs.leaders.end(),
-            (leader*) m
-        )
-    );
     leader_fsm::die((leader*) m, nullptr, nullptr);
 }
 
@@ -49,6 +49,16 @@ mob_category::mob_category(
 }
 
 
+/**
+ * @brief Does whatever this category needs when one of its mobs is about
+ * to be deleted. Taking it out of the lists of mobs is done elsewhere,
+ * for all of the mobs being deleted at once.
+ *
+ * @param m The mob to erase.
+ */
+void mob_category::erase_mob(mob* m) { }
+
+
 /**
  * @brief Clears the list of registered categories, freeing memory.
  */
@@ -212,14 +222,6 @@ mob* none_category::create_mob(
 mob_type* none_category::create_type() { return nullptr; }
 
 
-/**
- * @brief Clears a mob from the list.
- *
- * @param m The mob to erase.
- */
-void none_category::erase_mob(mob* m) { }
-
-
 /**
  * @brief Returns a type of mob given its internal name,
  * or nullptr on error.
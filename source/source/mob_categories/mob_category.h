@@ -145,7 +145,7 @@ public:
     virtual mob* create_mob(
         const point &pos, mob_type* type, float angle
     ) = 0;
-    virtual void erase_mob(mob* m) = 0;
+    virtual void erase_mob(mob* m);
     virtual void clear_types() = 0;
     
 };
@@ -199,7 +199,6 @@ public:
     mob* create_mob(
         const point &pos, mob_type* type, float angle
     ) override;
-    void erase_mob(mob* m) override;
     void clear_types() override;
     
 };
@@ -67,22 +67,6 @@ mob_type* onion_category::create_type() {
 }
 
 
-/**
- * @brief Clears an Onion from the list of Onions.
- *
- * @param m The mob to erase.
- */
-void onion_category::erase_mob(mob* m) {
-    game.states.gameplay->mobs.onions.erase(
-        find(
-            game.states.gameplay->mobs.onions.begin(),
-            game.states.gameplay->mobs.onions.end(),
-            (onion*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of Onion given its name,
  * or nullptr on error.
@@ -67,22 +67,6 @@ mob_type* pellet_category::create_type() {
 }
 
 
-/**
- * @brief Clears a pellet from the list of pellets.
- *
- * @param m The mob to erase.
- */
-void pellet_category::erase_mob(mob* m) {
-    game.states.gameplay->mobs.pellets.erase(
-        find(
-            game.states.gameplay->mobs.pellets.begin(),
-            game.states.gameplay->mobs.pellets.end(),
-            (pellet*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of pellet given its name,
  * or nullptr on error.
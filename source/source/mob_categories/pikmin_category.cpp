@@ -67,22 +67,6 @@ mob_type* pikmin_category::create_type() {
 }
 
 
-/**
- * @brief Clears a Pikmin from the list of Pikmin.
- *
- * @param m The mob to erase.
- */
-void pikmin_category::erase_mob(mob* m) {
-    game.states.gameplay->mobs.pikmin_list.erase(
-        find(
-            game.states.gameplay->mobs.pikmin_list.begin(),
-            game.states.gameplay->mobs.pikmin_list.end(),
-            (pikmin*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of Pikmin given its name,
  * or nullptr on error.
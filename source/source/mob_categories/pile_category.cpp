@@ -67,22 +67,6 @@ mob_type* pile_category::create_type() {
 }
 
 
-/**
- * @brief Clears a pile from the list of piles.
- *
- * @param m The mob to erase.
- */
-void pile_category::erase_mob(mob* m) {
-    game.states.gameplay->mobs.piles.erase(
-        find(
-            game.states.gameplay->mobs.piles.begin(),
-            game.states.gameplay->mobs.piles.end(),
-            (pile*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of pile given its name,
  * or nullptr on error.
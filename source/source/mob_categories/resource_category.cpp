@@ -67,22 +67,6 @@ mob_type* resource_category::create_type() {
 }
 
 
-/**
- * @brief Clears a resource from the list of resources.
- *
- * @param m The mob to erase.
- */
-void resource_category::erase_mob(mob* m) {
-    game.states.gameplay->mobs.resources.erase(
-        find(
-            game.states.gameplay->mobs.resources.begin(),
-            game.states.gameplay->mobs.resources.end(),
-            (resource*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of resource given its name,
  * or nullptr on error.
@@ -67,22 +67,6 @@ mob_type* scale_category::create_type() {
 }
 
 
-/**
- * @brief Clears a scale from the list of scales.
- *
- * @param m The mob to erase.
- */
-void scale_category::erase_mob(mob* m) {
-    game.states.gameplay->mobs.scales.erase(
-        find(
-            game.states.gameplay->mobs.scales.begin(),
-            game.states.gameplay->mobs.scales.end(),
-            (scale*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of scale given its name,
  * or nullptr on error.
@@ -67,22 +67,6 @@ mob_type* ship_category::create_type() {
 }
 
 
-/**
- * @brief Clears a ship from the list of ships.
- *
- * @param m The mob to erase.
- */
-void ship_category::erase_mob(mob* m) {
-    game.states.gameplay->mobs.ships.erase(
-        find(
-            game.states.gameplay->mobs.ships.begin(),
-            game.states.gameplay->mobs.ships.end(),
-            (ship*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of ship given its name,
  * or nullptr on error.
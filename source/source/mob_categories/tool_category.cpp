@@ -67,22 +67,6 @@ mob_type* tool_category::create_type() {
 }
 
 
-/**
- * @brief Clears a tool from the list of tools.
- *
- * @param m The mob to erase.
- */
-void tool_category::erase_mob(mob* m) {
-    game.states.gameplay->mobs.tools.erase(
-        find(
-            game.states.gameplay->mobs.tools.begin(),
-            game.states.gameplay->mobs.tools.end(),
-            (tool*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of tool given its name,
  * or nullptr on error.
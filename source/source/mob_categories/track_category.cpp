@@ -67,22 +67,6 @@ mob_type* track_category::create_type() {
 }
 
 
-/**
- * @brief Clears a track from the list of tracks.
- *
- * @param m The mob to erase.
- */
-void track_category::erase_mob(mob* m) {
-    game.states.gameplay->mobs.tracks.erase(
-        find(
-            game.states.gameplay->mobs.tracks.begin(),
-            game.states.gameplay->mobs.tracks.end(),
-            (track*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of track given its name,
  * or nullptr on error.
@@ -67,22 +67,6 @@ mob_type* treasure_category::create_type() {
 }
 
 
-/**
- * @brief Clears a treasure from the list of treasures.
- *
- * @param m The mob to erase.
- */
-void treasure_category::erase_mob(mob* m) {
-    game.states.gameplay->mobs.treasures.erase(
-        find(
-            game.states.gameplay->mobs.treasures.begin(),
-            game.states.gameplay->mobs.treasures.end(),
-            (treasure*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of treasure given its name,
  * or nullptr on error.
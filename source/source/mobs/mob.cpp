@@ -152,6 +152,10 @@ const float SWARM_VERTICAL_SCALE = 0.5f;
 //A new "mob thrown" particle is spawned every X seconds.
 const float THROW_PARTICLE_INTERVAL = 0.02f;
 
+//When a fast mob would skip past a wall in one frame, it gets stopped
+//this far into the wall instead, so the usual wall logic can handle it.
+const float WALL_HIT_OVERLAP = 1.0f;
+
 //A water wave ring particle lasts this long.
 const float WAVE_RING_DURATION = 1.0f;
 
@@ -192,6 +196,8 @@ mob::mob(const point &pos, mob_type* type, float angle) :
     }
     ground_sector = sec;
     center_sector = sec;
+    tick_start_pos = pos;
+    tick_start_z = z;
     
     team = type->starting_team;
     
@@ -1579,6 +1585,7 @@ bool mob::follow_path(
 ) {
     bool was_blocked = false;
     path_stop* old_next_stop = nullptr;
+    const path_request* replan_request = nullptr;
     
     //Some setup before we begin.
     if(has_flag(settings.flags, PATH_FOLLOW_FLAG_CAN_CONTINUE) && path_info) {
@@ -1589,6 +1596,8 @@ bool mob::follow_path(
     }
     
     if(path_info) {
+        //If this is because of a path request, its result can be used.
+        replan_request = path_info->replan_request;
         delete path_info;
     }
     
@@ -1636,7 +1645,7 @@ bool mob::follow_path(
     
     //Establish the mob's path-following information.
     //This also generates the path to take.
-    path_info = new path_t(this, final_settings);
+    path_info = new path_t(this, final_settings, replan_request);
     
     if(
         has_flag(path_info->settings.flags, PATH_FOLLOW_FLAG_CAN_CONTINUE) &&
@@ -3388,63 +3397,59 @@ void mob::tick(float delta_t) {
     
     if(to_delete) return;
     
+    //Performance monitor zones. Cache for performance.
+    static const size_t brain_zone_id =
+        performance_monitor_t::get_zone_id("Object -- Brain");
+    static const size_t physics_zone_id =
+        performance_monitor_t::get_zone_id("Object -- Physics");
+    static const size_t misc_logic_zone_id =
+        performance_monitor_t::get_zone_id("Object -- Misc. logic");
+    static const size_t animation_zone_id =
+        performance_monitor_t::get_zone_id("Object -- Animation");
+    static const size_t script_zone_id =
+        performance_monitor_t::get_zone_id("Object -- Script");
+    static const size_t class_specifics_zone_id =
+        performance_monitor_t::get_zone_id("Object -- Misc. specifics");
+        
     //Brain.
-    if(game.perf_mon) {
-        game.perf_mon->start_measurement("Object -- Brain");
-    }
-    tick_brain(delta_t);
-    if(game.perf_mon) {
-        game.perf_mon->finish_measurement();
+    {
+        perf_zone zone(brain_zone_id);
+        tick_brain(delta_t);
     }
     if(to_delete) return;
     
     //Physics.
-    if(game.perf_mon) {
-        game.perf_mon->start_measurement("Object -- Physics");
-    }
-    tick_physics(delta_t);
-    if(game.perf_mon) {
-        game.perf_mon->finish_measurement();
+    {
+        perf_zone zone(physics_zone_id);
+        tick_physics(delta_t);
     }
     if(to_delete) return;
     
     //Misc. logic.
-    if(game.perf_mon) {
-        game.perf_mon->start_measurement("Object -- Misc. logic");
-    }
-    tick_misc_logic(delta_t);
-    if(game.perf_mon) {
-        game.perf_mon->finish_measurement();
+    {
+        perf_zone zone(misc_logic_zone_id);
+        tick_misc_logic(delta_t);
     }
     if(to_delete) return;
     
     //Animation.
-    if(game.perf_mon) {
-        game.perf_mon->start_measurement("Object -- Animation");
-    }
-    tick_animation(delta_t);
-    if(game.perf_mon) {
-        game.perf_mon->finish_measurement();
+    {
+        perf_zone zone(animation_zone_id);
+        tick_animation(delta_t);
     }
     if(to_delete) return;
     
     //Script.
-    if(game.perf_mon) {
-        game.perf_mon->start_measurement("Object -- Script");
-    }
-    tick_script(delta_t);
-    if(game.perf_mon) {
-        game.perf_mon->finish_measurement();
+    {
+        perf_zone zone(script_zone_id);
+        tick_script(delta_t);
     }
     if(to_delete) return;
     
     //Class specifics.
-    if(game.perf_mon) {
-        game.perf_mon->start_measurement("Object -- Misc. specifics");
-    }
-    tick_class_specifics(delta_t);
-    if(game.perf_mon) {
-        game.perf_mon->finish_measurement();
+    {
+        perf_zone zone(class_specifics_zone_id);
+        tick_class_specifics(delta_t);
     }
 }
 
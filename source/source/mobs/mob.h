@@ -79,6 +79,7 @@ extern const float SWARM_MARGIN;
 extern const float SWARM_VERTICAL_SCALE;
 extern const float STATUS_SHAKING_TIME_MULT;
 extern const float THROW_PARTICLE_INTERVAL;
+extern const float WALL_HIT_OVERLAP;
 extern const float WAVE_RING_DURATION;
 };
 
@@ -116,12 +117,24 @@ public:
     //Current facing angle. 0 = right, PI / 2 = up, etc.
     float angle = 0.0f;
     
+    //Coordinates at the start of the latest logic tick.
+    //Only kept up to date when the logic runs at a fixed timestep.
+    point tick_start_pos;
+    
+    //Z coordinate at the start of the latest logic tick.
+    //Only kept up to date when the logic runs at a fixed timestep.
+    float tick_start_z = 0.0f;
+    
     //The highest ground below the entire mob.
     sector* ground_sector = nullptr;
     
     //Sector that the mob's center is on.
     sector* center_sector = nullptr;
     
+    //Index of the blockmap triangle the mob's center was last found in,
+    //if known. Cache for performance.
+    size_t center_triangle_idx = INVALID;
+    
     //Mob this mob is standing on top of, if any.
     mob* standing_on_mob = nullptr;
     
@@ -533,9 +546,11 @@ protected:
     H_MOVE_RESULT get_movement_edge_intersections(
         const point &new_pos, vector<edge*>* intersecting_edges
     ) const;
+    bool get_movement_wall_hit(const point &new_pos, float* out_time) const;
     H_MOVE_RESULT get_physics_horizontal_movement(
         float delta_t, float move_speed_mult, point* move_speed
     );
+    float get_terrain_radius() const;
     H_MOVE_RESULT get_wall_slide_angle(
         const edge* e_ptr, unsigned char wall_sector, float move_angle,
         float* slide_angle
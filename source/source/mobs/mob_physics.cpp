@@ -107,22 +107,15 @@ H_MOVE_RESULT mob::get_movement_edge_intersections(
     const point &new_pos, vector<edge*>* intersecting_edges
 ) const {
     //Before checking the edges, let's consult the blockmap and look at
-    //the edges in the same blocks the mob is on.
+    //the edges in the same blocks the mob is on, that it's touching.
     //This way, we won't check for edges that are really far away.
-    //Use the bounding box to know which blockmap blocks the mob will be on.
-    set<edge*> candidate_edges;
-    //Use the terrain radius if the mob is moving about and alive.
-    //Otherwise if it's a corpse, it can use the regular radius.
-    float radius_to_use =
-        (type->terrain_radius < 0 || health <= 0) ?
-        radius :
-        type->terrain_radius;
-        
+    //Cache for performance.
+    static vector<edge*> touched_edges;
+    float radius_to_use = get_terrain_radius();
+    
     if(
-        !game.cur_area_data->bmap.get_edges_in_region(
-            new_pos - radius_to_use,
-            new_pos + radius_to_use,
-            candidate_edges
+        !game.cur_area_data->bmap.get_edges_touching_circle(
+            new_pos, radius_to_use, touched_edges
         )
     ) {
         //Somehow out of bounds. No movement.
@@ -130,22 +123,10 @@ H_MOVE_RESULT mob::get_movement_edge_intersections(
     }
     
     //Go through each edge, and figure out if it is a valid wall for our mob.
-    for(auto &e_ptr : candidate_edges) {
+    for(auto &e_ptr : touched_edges) {
     
         bool is_edge_blocking = false;
         
-        if(
-            !circle_intersects_line_seg(
-                new_pos, radius_to_use,
-                point(e_ptr->vertexes[0]->x, e_ptr->vertexes[0]->y),
-                point(e_ptr->vertexes[1]->x, e_ptr->vertexes[1]->y),
-                nullptr, nullptr
-            )
-        ) {
-            //No intersection? Well, obviously this one doesn't count.
-            continue;
-        }
-        
         if(!e_ptr->sectors[0] || !e_ptr->sectors[1]) {
             //If we're on the edge of out-of-bounds geometry,
             //block entirely.
@@ -203,6 +184,84 @@ H_MOVE_RESULT mob::get_movement_edge_intersections(
 }
 
 
+/**
+ * @brief Checks if the mob would hit a wall it can't get past when moving
+ * from its current position to a new one. This sweeps the mob's circle
+ * along the whole movement, so it catches walls that the mob would skip
+ * past entirely if it's moving fast enough.
+ *
+ * @param new_pos Position the mob wants to move to.
+ * @param out_time If not nullptr, how far along the movement the first
+ * hit happens is returned here, from 0 (at the start) to 1 (at the end).
+ * @return Whether it hits a wall.
+ */
+bool mob::get_movement_wall_hit(const point &new_pos, float* out_time) const {
+    //Cache for performance.
+    static vector<edge*> candidate_edges;
+    float radius_to_use = get_terrain_radius();
+    
+    if(
+        !game.cur_area_data->bmap.get_edges_in_region(
+            point(std::min(pos.x, new_pos.x), std::min(pos.y, new_pos.y)) -
+            radius_to_use,
+            point(std::max(pos.x, new_pos.x), std::max(pos.y, new_pos.y)) +
+            radius_to_use,
+            candidate_edges
+        )
+    ) {
+        //Out of bounds. The regular checks will refuse the movement.
+        return false;
+    }
+    
+    float step_height =
+        has_flag(flags, MOB_FLAG_WAS_THROWN) ? 0.0f : GEOMETRY::STEP_HEIGHT;
+    point movement = new_pos - pos;
+    float first_hit_time = FLT_MAX;
+    
+    for(size_t e = 0; e < candidate_edges.size(); e++) {
+        edge* e_ptr = candidate_edges[e];
+        
+        //Same criteria as the regular wall checks, but only for walls
+        //that the mob can't climb up.
+        if(e_ptr->sectors[0] && e_ptr->sectors[1]) {
+            bool blocking_0 = e_ptr->sectors[0]->type == SECTOR_TYPE_BLOCKING;
+            bool blocking_1 = e_ptr->sectors[1]->type == SECTOR_TYPE_BLOCKING;
+            if(blocking_0 && blocking_1) continue;
+            if(!blocking_0 && !blocking_1) {
+                if(
+                    e_ptr->sectors[0]->z > z &&
+                    e_ptr->sectors[1]->z > z
+                ) {
+                    continue;
+                }
+                if(
+                    std::max(e_ptr->sectors[0]->z, e_ptr->sectors[1]->z) <=
+                    z + step_height
+                ) {
+                    continue;
+                }
+            }
+        }
+        
+        float hit_time;
+        if(
+            moving_circle_intersects_line_seg(
+                pos, radius_to_use, movement,
+                point(e_ptr->vertexes[0]->x, e_ptr->vertexes[0]->y),
+                point(e_ptr->vertexes[1]->x, e_ptr->vertexes[1]->y),
+                &hit_time
+            )
+        ) {
+            first_hit_time = std::min(first_hit_time, hit_time);
+        }
+    }
+    
+    if(first_hit_time == FLT_MAX) return false;
+    if(out_time) *out_time = first_hit_time;
+    return true;
+}
+
+
 /**
  * @brief Calculates how much the mob is going to move horizontally,
  * for the purposes of movement physics calculation.
@@ -319,6 +378,21 @@ H_MOVE_RESULT mob::get_physics_horizontal_movement(
 }
 
 
+/**
+ * @brief Returns the radius to use when checking collisions against walls.
+ * This is the terrain radius if the mob is moving about and alive.
+ * Otherwise if it's a corpse, it can use the regular radius.
+ *
+ * @return The radius.
+ */
+float mob::get_terrain_radius() const {
+    return
+        (type->terrain_radius < 0 || health <= 0) ?
+        radius :
+        type->terrain_radius;
+}
+
+
 /**
  * @brief Calculates the angle at which the mob should slide against this wall,
  * for the purposes of movement physics calculations.
@@ -407,18 +481,36 @@ void mob::tick_horizontal_movement_physics(
     
         //Start by checking sector collisions.
         //For this, we will only check if the mob is intersecting
-        //with any edge. With this, we trust that mobs can't go so fast
-        //that they're fully on one side of an edge in one frame,
-        //and the other side on the next frame.
-        //It's pretty naive...but it works!
+        //with any edge. A mob that moves farther than its radius could
+        //be fully on one side of an edge in one frame, and on the other
+        //side on the next frame, so for those, sweep along the movement
+        //first, and stop the mob just past the first wall it would hit.
         bool successful_move = true;
         
         new_pos.x = pos.x + delta_t* move_speed.x;
         new_pos.y = pos.y + delta_t* move_speed.y;
         float new_z = z;
         
-        //Get the sector the mob will be on.
-        sector* new_center_sector = get_sector(new_pos, nullptr, true);
+        float move_dist = dist(pos, new_pos).to_float();
+        float terrain_radius = get_terrain_radius();
+        float hit_time;
+        if(
+            move_dist > terrain_radius &&
+            get_movement_wall_hit(new_pos, &hit_time)
+        ) {
+            float overlap =
+                std::min(MOB::WALL_HIT_OVERLAP, terrain_radius / 2.0f);
+            float move_ratio = std::min(1.0f, hit_time + overlap / move_dist);
+            new_pos = pos + (new_pos - pos) * move_ratio;
+        }
+        
+        //Get the sector the mob will be on. It's most likely the same
+        //triangle as before, or one next to it, so check those first.
+        size_t new_center_triangle_idx = center_triangle_idx;
+        sector* new_center_sector =
+            game.cur_area_data->bmap.get_sector(
+                new_pos, &new_center_triangle_idx
+            );
         sector* new_ground_sector = new_center_sector;
         sector* step_sector = new_center_sector;
         
@@ -431,7 +523,9 @@ void mob::tick_horizontal_movement_physics(
             return;
         }
         //Get all edges it collides against in this new position.
-        vector<edge*> intersecting_edges;
+        //Cache for performance.
+        static vector<edge*> intersecting_edges;
+        intersecting_edges.clear();
         if(
             get_movement_edge_intersections(new_pos, &intersecting_edges) ==
             H_MOVE_RESULT_FAIL
@@ -568,6 +662,7 @@ void mob::tick_horizontal_movement_physics(
             z = new_z;
             ground_sector = new_ground_sector;
             center_sector = new_center_sector;
+            center_triangle_idx = new_center_triangle_idx;
             finished_moving = true;
             
         } else {
@@ -18,7 +18,26 @@
 #include "../mob_script_action.h"
 #include "../utils/general_utils.h"
 #include "../utils/string_utils.h"
+#include "bouncer.h"
+#include "bridge.h"
+#include "converter.h"
+#include "decoration.h"
+#include "drop.h"
+#include "enemy.h"
+#include "group_task.h"
+#include "interactable.h"
+#include "leader.h"
 #include "mob.h"
+#include "onion.h"
+#include "pellet.h"
+#include "pikmin.h"
+#include "pile.h"
+#include "resource.h"
+#include "scale.h"
+#include "ship.h"
+#include "tool.h"
+#include "track.h"
+#include "treasure.h"
 
 
 using std::unordered_set;
@@ -716,6 +735,322 @@ point hold_t::get_final_pos(float* out_z) const {
 }
 
 
+/**
+ * @brief Adds a mob to all of the cells its physical span touches.
+ *
+ * @param mob_idx Index of the mob in the list of all mobs.
+ * @param m_ptr The mob.
+ */
+void mob_interaction_grid::add_mob(size_t mob_idx, const mob* m_ptr) {
+    int from_col, to_col, from_row, to_row;
+    get_cell_range(
+        m_ptr->pos, m_ptr->physical_span,
+        &from_col, &to_col, &from_row, &to_row
+    );
+    
+    for(int r = from_row; r <= to_row; r++) {
+        for(int c = from_col; c <= to_col; c++) {
+            cells[r * n_cols + c].push_back(mob_idx);
+        }
+    }
+    
+    mob_cell_ranges[mob_idx * 4] = from_col;
+    mob_cell_ranges[mob_idx * 4 + 1] = to_col;
+    mob_cell_ranges[mob_idx * 4 + 2] = from_row;
+    mob_cell_ranges[mob_idx * 4 + 3] = to_row;
+}
+
+
+/**
+ * @brief Given a list of candidates found before any mob changed cells,
+ * adds the mobs that changed cells since the grid was last built,
+ * and whose cells now overlap the ones a range around a point touches.
+ * Only the list of mobs that changed cells is checked, not the cells.
+ * If that list is longer than the candidates list, the cells are
+ * checked again from scratch instead, since that's cheaper.
+ *
+ * @param pos Coordinates of the point.
+ * @param range Range around the point.
+ * @param candidates List of mob indexes, sorted by index.
+ * @param out_candidates If any mob had to be added, the candidates plus
+ * the new ones are returned here, sorted and without repeats.
+ * @return Whether any mob had to be added. If not, the candidates
+ * can be used as they are.
+ */
+bool mob_interaction_grid::add_moved_candidates(
+    const point &pos, float range, const vector<size_t> &candidates,
+    vector<size_t> &out_candidates
+) const {
+    if(moved_mob_idxs.empty() || cells.empty()) return false;
+    
+    if(moved_mob_idxs.size() > candidates.size()) {
+        get_candidates(pos, range, out_candidates);
+        return true;
+    }
+    
+    int from_col, to_col, from_row, to_row;
+    get_cell_range(pos, range, &from_col, &to_col, &from_row, &to_row);
+    
+    out_candidates.clear();
+    for(size_t m = 0; m < moved_mob_idxs.size(); m++) {
+        size_t mob_idx = moved_mob_idxs[m];
+        const int* mob_range = &mob_cell_ranges[mob_idx * 4];
+        if(mob_range[0] > to_col || mob_range[1] < from_col) continue;
+        if(mob_range[2] > to_row || mob_range[3] < from_row) continue;
+        out_candidates.push_back(mob_idx);
+    }
+    
+    if(out_candidates.empty()) return false;
+    
+    size_t n_moved = out_candidates.size();
+    std::sort(out_candidates.begin(), out_candidates.end());
+    out_candidates.insert(
+        out_candidates.end(), candidates.begin(), candidates.end()
+    );
+    std::inplace_merge(
+        out_candidates.begin(), out_candidates.begin() + n_moved,
+        out_candidates.end()
+    );
+    out_candidates.erase(
+        std::unique(out_candidates.begin(), out_candidates.end()),
+        out_candidates.end()
+    );
+    return true;
+}
+
+
+/**
+ * @brief Clears the grid.
+ */
+void mob_interaction_grid::clear() {
+    top_left_corner = point();
+    n_cols = 0;
+    n_rows = 0;
+    cells.clear();
+    mob_cell_ranges.clear();
+    n_mobs = 0;
+    moved_mob_idxs.clear();
+    mob_moved_flags.clear();
+}
+
+
+/**
+ * @brief Returns the indexes of all mobs that may be within a given
+ * range of a point, taking their physical span into account.
+ * This is a broad phase, so the list can contain mobs that are farther
+ * away, but it will never miss a mob that is in range.
+ * Mobs added to the list of all mobs after the grid was built are
+ * not included.
+ * This doesn't change the grid, so it's safe to call from several
+ * threads at once.
+ *
+ * @param pos Coordinates of the point.
+ * @param range Range around the point.
+ * @param out_candidates The mob indexes are returned here, sorted by index.
+ */
+void mob_interaction_grid::get_candidates(
+    const point &pos, float range, vector<size_t> &out_candidates
+) const {
+    out_candidates.clear();
+    
+    if(cells.empty()) {
+        for(size_t m = 0; m < n_mobs; m++) {
+            out_candidates.push_back(m);
+        }
+        return;
+    }
+    
+    int from_col, to_col, from_row, to_row;
+    get_cell_range(pos, range, &from_col, &to_col, &from_row, &to_row);
+    
+    for(int r = from_row; r <= to_row; r++) {
+        for(int c = from_col; c <= to_col; c++) {
+            const vector<size_t> &cell = cells[r * n_cols + c];
+            out_candidates.insert(
+                out_candidates.end(), cell.begin(), cell.end()
+            );
+        }
+    }
+    
+    //Keep the same order as the list of all mobs, so that whoever uses
+    //this gets the same results as if they had checked every mob.
+    //Mobs that span several cells show up more than once, too.
+    std::sort(out_candidates.begin(), out_candidates.end());
+    out_candidates.erase(
+        std::unique(out_candidates.begin(), out_candidates.end()),
+        out_candidates.end()
+    );
+}
+
+
+/**
+ * @brief Returns the range of cells that a region around a point touches.
+ * Cells outside of the grid are clamped to the grid's borders, so that mobs
+ * that wander outside still get checked against one another.
+ *
+ * @param pos Coordinates of the point.
+ * @param range Range around the point.
+ * @param from_col The first column is returned here.
+ * @param to_col The last column is returned here.
+ * @param from_row The first row is returned here.
+ * @param to_row The last row is returned here.
+ */
+void mob_interaction_grid::get_cell_range(
+    const point &pos, float range,
+    int* from_col, int* to_col, int* from_row, int* to_row
+) const {
+    //Pad the range a bit, so that floating point errors don't make two
+    //regions that touch right at a cell border end up in different cells.
+    range += 1.0f;
+    
+    float max_col = n_cols - 1;
+    float max_row = n_rows - 1;
+    point tl = (pos - range - top_left_corner) / GEOMETRY::AREA_CELL_SIZE;
+    point br = (pos + range - top_left_corner) / GEOMETRY::AREA_CELL_SIZE;
+    
+    *from_col = clamp(floor(tl.x), 0.0f, max_col);
+    *to_col = clamp(floor(br.x), 0.0f, max_col);
+    *from_row = clamp(floor(tl.y), 0.0f, max_row);
+    *to_row = clamp(floor(br.y), 0.0f, max_row);
+}
+
+
+/**
+ * @brief Initializes the grid's dimensions. This removes all mobs from it.
+ *
+ * @param top_left_corner Top-left corner of the grid.
+ * @param n_cols Number of columns.
+ * @param n_rows Number of rows.
+ */
+void mob_interaction_grid::init(
+    const point &top_left_corner, size_t n_cols, size_t n_rows
+) {
+    clear();
+    this->top_left_corner = top_left_corner;
+    this->n_cols = n_cols;
+    this->n_rows = n_rows;
+    cells.assign(n_cols * n_rows, vector<size_t>());
+}
+
+
+/**
+ * @brief Rebuilds the grid from scratch, using the mobs' current positions.
+ *
+ * @param all_mobs List of all mobs in the area.
+ */
+void mob_interaction_grid::rebuild(const vector<mob*> &all_mobs) {
+    for(size_t c = 0; c < cells.size(); c++) {
+        cells[c].clear();
+    }
+    
+    n_mobs = all_mobs.size();
+    mob_cell_ranges.assign(n_mobs * 4, 0);
+    moved_mob_idxs.clear();
+    mob_moved_flags.assign(n_mobs, false);
+    
+    if(cells.empty()) return;
+    
+    for(size_t m = 0; m < n_mobs; m++) {
+        add_mob(m, all_mobs[m]);
+    }
+}
+
+
+/**
+ * @brief Removes a mob from all of the cells it was placed in.
+ *
+ * @param mob_idx Index of the mob in the list of all mobs.
+ */
+void mob_interaction_grid::remove_mob(size_t mob_idx) {
+    for(
+        int r = mob_cell_ranges[mob_idx * 4 + 2];
+        r <= mob_cell_ranges[mob_idx * 4 + 3]; r++
+    ) {
+        for(
+            int c = mob_cell_ranges[mob_idx * 4];
+            c <= mob_cell_ranges[mob_idx * 4 + 1]; c++
+        ) {
+            vector<size_t> &cell = cells[r * n_cols + c];
+            for(size_t m = 0; m < cell.size(); m++) {
+                if(cell[m] != mob_idx) continue;
+                //The order inside a cell doesn't matter, so just swap
+                //the last one in.
+                cell[m] = cell.back();
+                cell.pop_back();
+                break;
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief Updates the cells a mob is in, after it moved or changed size.
+ * Mobs that were added to the list of all mobs after the grid
+ * was built are ignored.
+ *
+ * @param mob_idx Index of the mob in the list of all mobs.
+ * @param m_ptr The mob.
+ */
+void mob_interaction_grid::update_mob(size_t mob_idx, const mob* m_ptr) {
+    if(mob_idx >= n_mobs || cells.empty()) return;
+    
+    int from_col, to_col, from_row, to_row;
+    get_cell_range(
+        m_ptr->pos, m_ptr->physical_span,
+        &from_col, &to_col, &from_row, &to_row
+    );
+    if(
+        from_col == mob_cell_ranges[mob_idx * 4] &&
+        to_col == mob_cell_ranges[mob_idx * 4 + 1] &&
+        from_row == mob_cell_ranges[mob_idx * 4 + 2] &&
+        to_row == mob_cell_ranges[mob_idx * 4 + 3]
+    ) {
+        //Still in the same cells.
+        return;
+    }
+    
+    remove_mob(mob_idx);
+    add_mob(mob_idx, m_ptr);
+    
+    if(!mob_moved_flags[mob_idx]) {
+        mob_moved_flags[mob_idx] = true;
+        moved_mob_idxs.push_back(mob_idx);
+    }
+}
+
+
+/**
+ * @brief Removes the given mobs from the list of all mobs, and from
+ * whichever other lists they are in. Everyone else is kept in the same order.
+ *
+ * @param mobs Mobs to remove.
+ */
+void mob_lists::remove_mobs(const unordered_set<mob*> &mobs) {
+    remove_mobs_from_list(all, mobs);
+    remove_mobs_from_list(bouncers, mobs);
+    remove_mobs_from_list(bridges, mobs);
+    remove_mobs_from_list(converters, mobs);
+    remove_mobs_from_list(decorations, mobs);
+    remove_mobs_from_list(drops, mobs);
+    remove_mobs_from_list(enemies, mobs);
+    remove_mobs_from_list(group_tasks, mobs);
+    remove_mobs_from_list(interactables, mobs);
+    remove_mobs_from_list(leaders, mobs);
+    remove_mobs_from_list(onions, mobs);
+    remove_mobs_from_list(pellets, mobs);
+    remove_mobs_from_list(pikmin_list, mobs);
+    remove_mobs_from_list(piles, mobs);
+    remove_mobs_from_list(resources, mobs);
+    remove_mobs_from_list(walkables, mobs);
+    remove_mobs_from_list(scales, mobs);
+    remove_mobs_from_list(ships, mobs);
+    remove_mobs_from_list(tools, mobs);
+    remove_mobs_from_list(tracks, mobs);
+    remove_mobs_from_list(treasures, mobs);
+}
+
+
 /**
  * @brief Constructs a new parent info struct object.
  *
@@ -732,10 +1067,13 @@ parent_t::parent_t(mob* m) :
  *
  * @param m Mob this path info struct belongs to.
  * @param settings Settings about how the path should be followed.
+ * @param replan_request If not nullptr, a path request that was just handled
+ * for this mob, whose result can be used instead of searching again.
  */
 path_t::path_t(
     mob* m,
-    const path_follow_settings &settings
+    const path_follow_settings &settings,
+    const path_request* replan_request
 ) :
     m(m),
     settings(settings) {
@@ -743,7 +1081,7 @@ path_t::path_t(
     result =
         get_path(
             m->pos, settings.target_point, settings,
-            path, nullptr, nullptr, nullptr
+            path, nullptr, nullptr, nullptr, replan_request
         );
 }
 
@@ -1223,102 +1561,159 @@ mob* create_mob(
 
 
 /**
- * @brief Deletes a mob from the relevant vectors.
+ * @brief Deletes all mobs that are marked for deletion.
  *
- * It's always removed from the vector of mobs, but it's
- * also removed from the vector of Pikmin if it's a Pikmin,
- * leaders if it's a leader, etc.
+ * They are handled one at a time, in the order they're in the list, and
+ * each one goes through the same steps, and sends the same events, as if it
+ * were the only one. The only difference is that none of them are taken out
+ * of the lists of mobs until the end, when they're all taken out at once,
+ * keeping everyone else in the same order. Mobs that were already handled
+ * are not told about the ones after them, as if they were gone.
+ * If deleting a mob marks mobs further ahead in the list for deletion,
+ * those are deleted in this same call too.
  *
- * @param m_ptr The mob to delete.
- * @param complete_destruction If true, don't bother removing it from groups
- * and such, since everything is going to be destroyed.
+ * @param n_mobs Only the first N mobs in the list of all mobs are checked.
+ * @param complete_destruction If true, don't bother removing them from
+ * groups and such, since everything is going to be destroyed.
  */
-void delete_mob(mob* m_ptr, bool complete_destruction) {
-    if(game.maker_tools.info_lock == m_ptr) game.maker_tools.info_lock = nullptr;
+void delete_marked_mobs(size_t n_mobs, bool complete_destruction) {
+    vector<mob*> &all_mobs = game.states.gameplay->mobs.all;
     
-    if(!complete_destruction) {
-        m_ptr->leave_group();
+    size_t first_marked = 0;
+    for(; first_marked < n_mobs; first_marked++) {
+        if(all_mobs[first_marked]->to_delete) break;
+    }
+    if(first_marked == n_mobs) return;
+    
+    vector<mob*> deleted_mobs;
+    unordered_set<mob*> deleted_set;
+    
+    for(size_t m = first_marked; m < n_mobs; m++) {
+        mob* m_ptr = all_mobs[m];
+        if(!m_ptr->to_delete) continue;
         
-        for(size_t m = 0; m < game.states.gameplay->mobs.all.size(); m++) {
-            mob* m2_ptr = game.states.gameplay->mobs.all[m];
-            if(m2_ptr->focused_mob == m_ptr) {
-                m2_ptr->fsm.run_event(MOB_EV_FOCUSED_MOB_UNAVAILABLE);
-                m2_ptr->fsm.run_event(MOB_EV_FOCUS_OFF_REACH);
-                m2_ptr->fsm.run_event(MOB_EV_FOCUS_DIED);
-                m2_ptr->focused_mob = nullptr;
-            }
-            if(m2_ptr->parent && m2_ptr->parent->m == m_ptr) {
-                delete m2_ptr->parent;
-                m2_ptr->parent = nullptr;
-                m2_ptr->to_delete = true;
-            }
-            for(size_t f = 0; f < m2_ptr->focused_mob_memory.size(); f++) {
-                if(m2_ptr->focused_mob_memory[f] == m_ptr) {
-                    m2_ptr->focused_mob_memory[f] = nullptr;
-                }
-            }
-            for(size_t c = 0; c < m2_ptr->chomping_mobs.size(); c++) {
-                if(m2_ptr->chomping_mobs[c] == m_ptr) {
-                    m2_ptr->chomping_mobs[c] = nullptr;
-                }
-            }
-            for(size_t l = 0; l < m2_ptr->links.size(); l++) {
-                if(m2_ptr->links[l] == m_ptr) {
-                    m2_ptr->links[l] = nullptr;
-                }
-            }
-            if(m2_ptr->stored_inside_another == m_ptr) {
-                m_ptr->release(m2_ptr);
-                m2_ptr->stored_inside_another = nullptr;
-            }
-            if(m2_ptr->carry_info) {
-                for(
-                    size_t c = 0; c < m2_ptr->carry_info->spot_info.size(); c++
-                ) {
-                    if(m2_ptr->carry_info->spot_info[c].pik_ptr == m_ptr) {
-                        m2_ptr->carry_info->spot_info[c].pik_ptr =
-                            nullptr;
-                        m2_ptr->carry_info->spot_info[c].state =
-                            CARRY_SPOT_STATE_FREE;
-                    }
-                }
-            }
+        if(game.maker_tools.info_lock == m_ptr) {
+            game.maker_tools.info_lock = nullptr;
         }
-        
-        if(m_ptr->holder.m) {
-            m_ptr->holder.m->release(m_ptr);
+        if(!complete_destruction) {
+            detach_mob(m_ptr, deleted_set);
         }
+        game.audio.handle_mob_deletion(m_ptr);
+        m_ptr->type->category->erase_mob(m_ptr);
+        game.states.gameplay->path_mgr.handle_mob_deletion(m_ptr);
         
-        while(!m_ptr->holding.empty()) {
-            m_ptr->release(m_ptr->holding[0]);
+        deleted_mobs.push_back(m_ptr);
+        deleted_set.insert(m_ptr);
+    }
+    
+    if(!complete_destruction) {
+        //Some event could've made a mob point to them again while
+        //they were being deleted. Clean those up before they
+        //become dangling pointers.
+        for(size_t m = 0; m < all_mobs.size(); m++) {
+            mob* m2_ptr = all_mobs[m];
+            if(deleted_set.count(m2_ptr) > 0) continue;
+            forget_mobs(m2_ptr, deleted_set, false);
         }
-        
-        m_ptr->set_can_block_paths(false);
-        
-        m_ptr->fsm.set_state(INVALID);
     }
     
-    game.audio.handle_mob_deletion(m_ptr);
+    game.states.gameplay->mobs.remove_mobs(deleted_set);
     
-    m_ptr->type->category->erase_mob(m_ptr);
-    game.states.gameplay->mobs.all.erase(
-        find(
-            game.states.gameplay->mobs.all.begin(),
-            game.states.gameplay->mobs.all.end(),
-            m_ptr
-        )
-    );
-    if(m_ptr->type->walkable) {
-        game.states.gameplay->mobs.walkables.erase(
-            find(
-                game.states.gameplay->mobs.walkables.begin(),
-                game.states.gameplay->mobs.walkables.end(),
-                m_ptr
-            )
-        );
+    for(size_t m = 0; m < deleted_mobs.size(); m++) {
+        delete deleted_mobs[m];
+    }
+}
+
+
+/**
+ * @brief Makes a mob that is about to be deleted let go of everything, and
+ * makes every other mob forget about it.
+ *
+ * @param m_ptr The mob.
+ * @param deleted_mobs Mobs that were already deleted in this batch.
+ * These are not told to forget anything.
+ */
+void detach_mob(mob* m_ptr, const unordered_set<mob*> &deleted_mobs) {
+    m_ptr->leave_group();
+    
+    unordered_set<mob*> this_mob;
+    this_mob.insert(m_ptr);
+    for(size_t m = 0; m < game.states.gameplay->mobs.all.size(); m++) {
+        mob* m2_ptr = game.states.gameplay->mobs.all[m];
+        if(deleted_mobs.count(m2_ptr) > 0) continue;
+        forget_mobs(m2_ptr, this_mob, true);
     }
     
-    delete m_ptr;
+    if(m_ptr->holder.m) {
+        m_ptr->holder.m->release(m_ptr);
+    }
+    
+    while(!m_ptr->holding.empty()) {
+        m_ptr->release(m_ptr->holding[0]);
+    }
+    
+    m_ptr->set_can_block_paths(false);
+    
+    m_ptr->fsm.set_state(INVALID);
+}
+
+
+/**
+ * @brief Makes a mob forget about some other mobs, since those are about
+ * to be deleted.
+ *
+ * @param m_ptr The mob.
+ * @param mobs Mobs to forget about.
+ * @param run_events If true, the mob is told via events that its focused mob
+ * is gone. Otherwise, it's just unfocused.
+ */
+void forget_mobs(
+    mob* m_ptr, const unordered_set<mob*> &mobs, bool run_events
+) {
+    if(m_ptr->focused_mob && mobs.count(m_ptr->focused_mob) > 0) {
+        if(run_events) {
+            m_ptr->fsm.run_event(MOB_EV_FOCUSED_MOB_UNAVAILABLE);
+            m_ptr->fsm.run_event(MOB_EV_FOCUS_OFF_REACH);
+            m_ptr->fsm.run_event(MOB_EV_FOCUS_DIED);
+        }
+        m_ptr->focused_mob = nullptr;
+    }
+    if(m_ptr->parent && mobs.count(m_ptr->parent->m) > 0) {
+        delete m_ptr->parent;
+        m_ptr->parent = nullptr;
+        m_ptr->to_delete = true;
+    }
+    for(size_t f = 0; f < m_ptr->focused_mob_memory.size(); f++) {
+        if(mobs.count(m_ptr->focused_mob_memory[f]) > 0) {
+            m_ptr->focused_mob_memory[f] = nullptr;
+        }
+    }
+    for(size_t c = 0; c < m_ptr->chomping_mobs.size(); c++) {
+        if(mobs.count(m_ptr->chomping_mobs[c]) > 0) {
+            m_ptr->chomping_mobs[c] = nullptr;
+        }
+    }
+    for(size_t l = 0; l < m_ptr->links.size(); l++) {
+        if(mobs.count(m_ptr->links[l]) > 0) {
+            m_ptr->links[l] = nullptr;
+        }
+    }
+    if(
+        m_ptr->stored_inside_another &&
+        mobs.count(m_ptr->stored_inside_another) > 0
+    ) {
+        m_ptr->stored_inside_another->release(m_ptr);
+        m_ptr->stored_inside_another = nullptr;
+    }
+    if(m_ptr->carry_info) {
+        for(size_t c = 0; c < m_ptr->carry_info->spot_info.size(); c++) {
+            carrier_spot_t* spot_ptr = &m_ptr->carry_info->spot_info[c];
+            if(mobs.count(spot_ptr->pik_ptr) > 0) {
+                spot_ptr->pik_ptr = nullptr;
+                spot_ptr->state = CARRY_SPOT_STATE_FREE;
+            }
+        }
+    }
 }
 
 
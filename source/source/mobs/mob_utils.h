@@ -393,6 +393,78 @@ class treasure;
 class onion_type;
 class ship_type;
 
+
+/**
+ * @brief A uniform grid that divides the area into cells, and keeps track
+ * of which mobs are in each one.
+ *
+ * This serves as a broad phase for mob-on-mob interactions, so that a
+ * mob only needs to check the mobs that are in the cells its interaction
+ * span covers, instead of every mob in the area. Each mob is placed in
+ * all of the cells its physical span touches.
+ * Mobs are referred to by their index in the list of all mobs, so the
+ * grid must be rebuilt whenever that list changes order.
+ */
+class mob_interaction_grid {
+
+public:
+
+    //--- Members ---
+    
+    //Top-left corner of the grid.
+    point top_left_corner;
+    
+    //Number of columns.
+    size_t n_cols = 0;
+    
+    //Number of rows.
+    size_t n_rows = 0;
+    
+    //Indexes of the mobs in each cell. Cells are stored row by row.
+    vector<vector<size_t> > cells;
+    
+    //For each mob, the first column, last column, first row, and last row
+    //of the cells it was placed in. Cache for performance.
+    vector<int> mob_cell_ranges;
+    
+    //Number of mobs in the list when the grid was last built.
+    size_t n_mobs = 0;
+    
+    //Indexes of the mobs that changed cells since the grid was last built.
+    vector<size_t> moved_mob_idxs;
+    
+    //For each mob, whether it's in the list of mobs that changed cells.
+    vector<bool> mob_moved_flags;
+    
+    
+    //--- Function declarations ---
+    
+    bool add_moved_candidates(
+        const point &pos, float range, const vector<size_t> &candidates,
+        vector<size_t> &out_candidates
+    ) const;
+    void clear();
+    void get_candidates(
+        const point &pos, float range, vector<size_t> &out_candidates
+    ) const;
+    void get_cell_range(
+        const point &pos, float range,
+        int* from_col, int* to_col, int* from_row, int* to_row
+    ) const;
+    void init(const point &top_left_corner, size_t n_cols, size_t n_rows);
+    void rebuild(const vector<mob*> &all_mobs);
+    void update_mob(size_t mob_idx, const mob* m_ptr);
+    
+private:
+
+    //--- Function declarations ---
+    
+    void add_mob(size_t mob_idx, const mob* m_ptr);
+    void remove_mob(size_t mob_idx);
+    
+};
+
+
 /**
  * @brief Lists of all mobs in the area.
  */
@@ -463,6 +535,36 @@ struct mob_lists {
     //Treasures.
     vector<treasure*> treasures;
     
+    
+    //--- Function declarations ---
+    
+    void remove_mobs(const unordered_set<mob*> &mobs);
+    
+    private:
+    
+    //--- Function definitions ---
+    
+    /**
+     * @brief Removes the given mobs from one of the lists, keeping the
+     * others in the same order.
+     *
+     * @tparam mob_t Class of the mobs in the list.
+     * @param list The list.
+     * @param mobs Mobs to remove.
+     */
+    template<typename mob_t>
+    void remove_mobs_from_list(
+        vector<mob_t*> &list, const unordered_set<mob*> &mobs
+    ) {
+        size_t new_size = 0;
+        for(size_t m = 0; m < list.size(); m++) {
+            if(mobs.count(list[m]) > 0) continue;
+            list[new_size] = list[m];
+            new_size++;
+        }
+        list.resize(new_size);
+    }
+    
 };
 
 
@@ -619,12 +721,18 @@ struct path_t {
     //Settings about how the path should be followed.
     path_follow_settings settings;
     
+    //Path request that was just handled for this mob, if any. It's only
+    //set while the mob is being told about it, so that its new path can
+    //use the result.
+    const path_request* replan_request = nullptr;
+    
     
     //--- Function declarations ---
     
     path_t(
         mob* m,
-        const path_follow_settings &settings
+        const path_follow_settings &settings,
+        const path_request* replan_request = nullptr
     );
     bool check_blockage(PATH_BLOCK_REASON* out_reason = nullptr);
     
@@ -747,7 +855,11 @@ mob* create_mob(
     std::function<void(mob*)> code_after_creation = nullptr,
     size_t first_state_override = INVALID
 );
-void delete_mob(mob* m, bool complete_destruction = false);
+void delete_marked_mobs(size_t n_mobs, bool complete_destruction = false);
+void detach_mob(mob* m_ptr, const unordered_set<mob*> &deleted_mobs);
+void forget_mobs(
+    mob* m_ptr, const unordered_set<mob*> &mobs, bool run_events
+);
 string get_error_message_mob_info(mob* m);
 vector<hazard*> get_mob_type_list_invulnerabilities(
     const unordered_set<mob_type*> &types
@@ -9,6 +9,7 @@
  */
 
 #include <algorithm>
+#include <thread>
 
 #include "options.h"
 
@@ -104,6 +105,9 @@ const bool DEF_EDITOR_USE_CUSTOM_STYLE = false;
 //Default value for whether the player is an engine developer.
 const bool DEF_ENGINE_DEVELOPER = false;
 
+//Default value for whether the gameplay logic uses a fixed timestep.
+const bool DEF_FIXED_TIMESTEP = false;
+
 //Default value for the GUI editor grid interval.
 const float DEF_GUI_EDITOR_GRID_INTERVAL = 2.5f;
 
@@ -123,6 +127,9 @@ const float DEF_JOYSTICK_MIN_DEADZONE = 0.2f;
 const LEAVING_CONFIRMATION_MODE DEF_LEAVING_CONFIRMATION_MODE =
     LEAVING_CONFIRMATION_MODE_ALWAYS;
     
+//Default value for the number of extra gameplay logic threads.
+const size_t DEF_LOGIC_THREADS = 0;
+
 //Default value for the master sound volume.
 const float DEF_MASTER_VOLUME = 0.8f;
 
@@ -141,6 +148,9 @@ const float DEF_MUSIC_VOLUME = 1.0f;
 //Default value for the particle editor background texture.
 const char* DEF_PARTICLE_EDITOR_BG_TEXTURE = "";
 
+//Default value for whether to record input replays of gameplay sessions.
+const bool DEF_RECORD_INPUT_REPLAYS = false;
+
 //Default value for whether to show player input icons on the HUD.
 const bool DEF_SHOW_HUD_INPUT_ICONS = true;
 
@@ -277,6 +287,7 @@ void options_t::load(data_node* file) {
     rs.set("editor_text_color", editor_text_color);
     rs.set("editor_use_custom_style", editor_use_custom_style);
     rs.set("engine_developer", engine_developer);
+    rs.set("fixed_timestep", fixed_timestep);
     rs.set("fps", target_fps);
     rs.set("fullscreen", intended_win_fullscreen);
     rs.set("gui_editor_grid_interval", gui_editor_grid_interval);
@@ -284,12 +295,14 @@ void options_t::load(data_node* file) {
     rs.set("joystick_min_deadzone", joystick_min_deadzone);
     rs.set("joystick_max_deadzone", joystick_max_deadzone);
     rs.set("leaving_confirmation_mode", leaving_confirmation_mode_c);
+    rs.set("logic_threads", logic_threads);
     rs.set("master_volume", master_volume);
     rs.set("max_particles", max_particles);
     rs.set("middle_zoom_level", zoom_mid_level);
     rs.set("mipmaps", mipmaps_enabled);
     rs.set("music_volume", music_volume);
     rs.set("particle_editor_bg_texture", particle_editor_bg_texture);
+    rs.set("record_input_replays", record_input_replays);
     rs.set("resolution", resolution_str);
     rs.set("smooth_scaling", smooth_scaling);
     rs.set("show_hud_input_icons", show_hud_input_icons);
@@ -324,6 +337,11 @@ void options_t::load(data_node* file) {
         );
     target_fps = std::max(1, target_fps);
     
+    //More threads than cores can only slow things down. If the number
+    //of cores can't be found out, it comes back as 0, so leave it be.
+    size_t nr_cores = std::thread::hardware_concurrency();
+    if(nr_cores > 0) logic_threads = std::min(logic_threads, nr_cores);
+    
     if(joystick_min_deadzone > joystick_max_deadzone) {
         std::swap(joystick_min_deadzone, joystick_max_deadzone);
     }
@@ -590,6 +608,12 @@ void options_t::save(data_node* file) const {
             b2s(engine_developer)
         )
     );
+    file->add(
+        new data_node(
+            "fixed_timestep",
+            b2s(fixed_timestep)
+        )
+    );
     file->add(
         new data_node(
             "fps",
@@ -632,6 +656,12 @@ void options_t::save(data_node* file) const {
             i2s(leaving_confirmation_mode)
         )
     );
+    file->add(
+        new data_node(
+            "logic_threads",
+            i2s(logic_threads)
+        )
+    );
     file->add(
         new data_node(
             "master_volume",
@@ -668,6 +698,12 @@ void options_t::save(data_node* file) const {
             particle_editor_bg_texture
         )
     );
+    file->add(
+        new data_node(
+            "record_input_replays",
+            b2s(record_input_replays)
+        )
+    );
     file->add(
         new data_node(
             "resolution",
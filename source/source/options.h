@@ -89,18 +89,21 @@ extern const ALLEGRO_COLOR DEF_EDITOR_TEXT_COLOR;
 extern const bool DEF_EDITOR_USE_CUSTOM_STYLE;
 extern const bool DEF_EDITOR_SHOW_TOOLTIPS;
 extern const bool DEF_ENGINE_DEVELOPER;
+extern const bool DEF_FIXED_TIMESTEP;
 extern const float DEF_GUI_EDITOR_GRID_INTERVAL;
 extern const bool DEF_GUI_EDITOR_SNAP;
 extern const float DEF_PARTICLE_EDITOR_GRID_INTERVAL;
 extern const float DEF_JOYSTICK_MIN_DEADZONE;
 extern const float DEF_JOYSTICK_MAX_DEADZONE;
 extern const LEAVING_CONFIRMATION_MODE DEF_LEAVING_CONFIRMATION_MODE;
+extern const size_t DEF_LOGIC_THREADS;
 extern const float DEF_MASTER_VOLUME;
 extern const size_t DEF_MAX_PARTICLES;
 extern const bool DEF_MIPMAPS_ENABLED;
 extern const bool DEF_MOUSE_MOVES_CURSOR[MAX_PLAYERS];
 extern const float DEF_MUSIC_VOLUME;
 extern const char* DEF_PARTICLE_EDITOR_BG_TEXTURE;
+extern const bool DEF_RECORD_INPUT_REPLAYS;
 extern const bool DEF_SMOOTH_SCALING;
 extern const bool DEF_SHOW_HUD_INPUT_ICONS;
 extern const unsigned int DEF_TARGET_FPS;
@@ -206,6 +209,10 @@ struct options_t {
     //Is the player a developer of the engine?
     bool engine_developer = OPTIONS::DEF_ENGINE_DEVELOPER;
     
+    //Should the gameplay logic run at a fixed rate, independent
+    //of the framerate?
+    bool fixed_timestep = OPTIONS::DEF_FIXED_TIMESTEP;
+    
     //Grid interval in the GUI editor, in units.
     float gui_editor_grid_interval = OPTIONS::DEF_GUI_EDITOR_GRID_INTERVAL;
     
@@ -233,6 +240,9 @@ struct options_t {
     //Pause menu leaving confirmation question mode.
     LEAVING_CONFIRMATION_MODE leaving_confirmation_mode = OPTIONS::DEF_LEAVING_CONFIRMATION_MODE;
     
+    //Number of extra threads to help with the gameplay logic. 0 for none.
+    size_t logic_threads = OPTIONS::DEF_LOGIC_THREADS;
+    
     //Master sound volume (0 - 1).
     float master_volume = OPTIONS::DEF_MASTER_VOLUME;
     
@@ -256,6 +266,9 @@ struct options_t {
     //Background texture for the particle editor, if any.
     string particle_editor_bg_texture = OPTIONS::DEF_PARTICLE_EDITOR_BG_TEXTURE;
     
+    //Record the inputs of every gameplay session, so it can be replayed?
+    bool record_input_replays = OPTIONS::DEF_RECORD_INPUT_REPLAYS;
+    
     //True to use interpolation when graphics are scaled up/down.
     bool smooth_scaling = OPTIONS::DEF_SMOOTH_SCALING;
     
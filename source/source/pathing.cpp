@@ -29,9 +29,1108 @@ namespace PATHS {
 //Default distance at which the mob considers the chase finished.
 const float DEF_CHASE_TARGET_DISTANCE = 3.0f;
 
+//A flow field is made once an end stop and settings combination
+//had this many path searches.
+const size_t FLOW_FIELD_MIN_REQUESTS = 4;
+
+//Maximum number of path search results to keep in the cache.
+const size_t MAX_CACHED_PATHS = 512;
+
+//Maximum number of flow fields to keep at once.
+const size_t MAX_FLOW_FIELDS = 16;
+
+//Maximum number of mobs from the replan queue that get a path request
+//each frame.
+const size_t MAX_REPLANS_PER_FRAME = 8;
+
 //Minimum radius of a path stop.
 const float MIN_STOP_RADIUS = 16.0f;
 
+//Maximum number of landmark stops to pick for the A* estimates.
+const size_t NR_LANDMARKS = 8;
+
+//Width and height of each cell in the path stop grid.
+const float STOP_GRID_CELL_SIZE = 128.0f;
+
+}
+
+
+/**
+ * @brief Returns the info about a stop for the current search.
+ * If the info is from an older search, it gets reset first.
+ *
+ * @param stop_idx Index of the stop.
+ * @return The info.
+ */
+a_star_workspace::stop_info &a_star_workspace::get_info(size_t stop_idx) {
+    stop_info &info = infos[stop_idx];
+    if(info.generation != generation) {
+        info = stop_info();
+        info.generation = generation;
+    }
+    return info;
+}
+
+
+/**
+ * @brief Returns whether there are no more stops to visit.
+ *
+ * @return Whether it's empty.
+ */
+bool a_star_workspace::is_heap_empty() const {
+    return heap.empty();
+}
+
+
+/**
+ * @brief Removes the stop with the lowest estimated distance from the
+ * stops to visit, and returns it.
+ *
+ * @return The stop's index.
+ */
+size_t a_star_workspace::pop() {
+    size_t stop_idx = heap[0];
+    swap_heap_items(0, heap.size() - 1);
+    heap.pop_back();
+    infos[stop_idx].heap_pos = INVALID;
+    if(!heap.empty()) sift_down(0);
+    return stop_idx;
+}
+
+
+/**
+ * @brief Adds a stop to the stops to visit. If it's already there,
+ * updates its position, since its estimated distance got lower.
+ *
+ * @param stop_idx Index of the stop.
+ */
+void a_star_workspace::push_or_update(size_t stop_idx) {
+    stop_info &info = get_info(stop_idx);
+    if(info.heap_pos == INVALID) {
+        info.heap_pos = heap.size();
+        heap.push_back(stop_idx);
+    }
+    sift_up(info.heap_pos);
+}
+
+
+/**
+ * @brief Moves a heap item down until the heap is in order.
+ *
+ * @param pos Position of the item in the heap.
+ */
+void a_star_workspace::sift_down(size_t pos) {
+    while(true) {
+        size_t left = pos * 2 + 1;
+        size_t right = left + 1;
+        size_t smallest = pos;
+        if(
+            left < heap.size() &&
+            infos[heap[left]].estimated < infos[heap[smallest]].estimated
+        ) {
+            smallest = left;
+        }
+        if(
+            right < heap.size() &&
+            infos[heap[right]].estimated < infos[heap[smallest]].estimated
+        ) {
+            smallest = right;
+        }
+        if(smallest == pos) return;
+        swap_heap_items(pos, smallest);
+        pos = smallest;
+    }
+}
+
+
+/**
+ * @brief Moves a heap item up until the heap is in order.
+ *
+ * @param pos Position of the item in the heap.
+ */
+void a_star_workspace::sift_up(size_t pos) {
+    while(pos > 0) {
+        size_t parent = (pos - 1) / 2;
+        if(infos[heap[parent]].estimated <= infos[heap[pos]].estimated) {
+            return;
+        }
+        swap_heap_items(pos, parent);
+        pos = parent;
+    }
+}
+
+
+/**
+ * @brief Prepares the workspace for a new search.
+ *
+ * @param nr_stops Number of stops in the area.
+ */
+void a_star_workspace::start_search(size_t nr_stops) {
+    if(infos.size() != nr_stops) {
+        infos.assign(nr_stops, stop_info());
+        generation = 0;
+    }
+    heap.clear();
+    
+    generation++;
+    if(generation == 0) {
+        //Wrapped around. Older infos could now match, so reset them all.
+        infos.assign(nr_stops, stop_info());
+        generation = 1;
+    }
+}
+
+
+/**
+ * @brief Swaps two items in the heap, keeping their stops' heap
+ * positions up to date.
+ *
+ * @param pos1 Position of the first item.
+ * @param pos2 Position of the second item.
+ */
+void a_star_workspace::swap_heap_items(size_t pos1, size_t pos2) {
+    std::swap(heap[pos1], heap[pos2]);
+    infos[heap[pos1]].heap_pos = pos1;
+    infos[heap[pos2]].heap_pos = pos2;
+}
+
+
+/**
+ * @brief Uses A* to get the shortest path between two stops, going through
+ * the contracted graph. The start and end stops can be skipped stops.
+ *
+ * @param workspace Workspace to use for the search.
+ * @param out_path The stops to visit, in order, are returned here.
+ * @param start_idx Index of the start stop.
+ * @param end_idx Index of the end stop.
+ * @param settings Settings about how the path should be followed.
+ * @param out_total_dist If not nullptr, the total path distance is
+ * returned here.
+ * @return Whether a path was found.
+ */
+bool contracted_path_graph::a_star(
+    a_star_workspace &workspace, vector<path_stop*> &out_path,
+    size_t start_idx, size_t end_idx,
+    const path_follow_settings &settings, float* out_total_dist
+) const {
+    const vector<path_stop*> &stops = game.cur_area_data->path_stops;
+    const point &end_pos = stops[end_idx]->pos;
+    
+    //If the end stop is skipped over, the search aims for a made-up
+    //stop right after all the real ones, which is reached by going down
+    //one of the end stop's shortcuts.
+    bool end_is_junction = is_junction[end_idx];
+    size_t goal_idx = end_is_junction ? end_idx : nr_stops;
+    
+    //The landmarks give a better estimate than a straight line, if ready.
+    const path_landmarks* landmarks =
+        game.states.gameplay->path_mgr.landmarks.is_usable() ?
+        &game.states.gameplay->path_mgr.landmarks :
+        nullptr;
+        
+    workspace.start_search(nr_stops + 1);
+    
+    auto relax =
+    [&workspace, &stops, &end_pos, end_idx, landmarks, this] (
+        size_t stop_idx, size_t prev_idx, size_t shortcut_idx,
+        float since_start
+    ) {
+        a_star_workspace::stop_info &info = workspace.get_info(stop_idx);
+        if(since_start >= info.since_start) return;
+        info.since_start = since_start;
+        info.prev_idx = prev_idx;
+        info.prev_shortcut_idx = shortcut_idx;
+        info.estimated = since_start;
+        if(stop_idx < nr_stops) {
+            float min_dist_left =
+                dist(stops[stop_idx]->pos, end_pos).to_float();
+            if(landmarks) {
+                min_dist_left =
+                    std::max(
+                        min_dist_left,
+                        landmarks->get_min_dist(stop_idx, end_idx)
+                    );
+            }
+            info.estimated += min_dist_left;
+        }
+        workspace.push_or_update(stop_idx);
+    };
+    
+    //Part 1: Initialize the algorithm.
+    if(is_junction[start_idx]) {
+        relax(start_idx, INVALID, INVALID, 0.0f);
+    } else {
+        const stop_place &start_place = stop_places[start_idx];
+        for(unsigned char side = 0; side < 2; side++) {
+            size_t s_idx = start_place.shortcut_idxs[side];
+            size_t start_pos = start_place.positions[side];
+            const path_shortcut &s_ref = shortcuts[s_idx];
+            
+            //Is the end stop further down this same shortcut?
+            if(!end_is_junction) {
+                size_t end_pos_in_s = get_stop_pos(end_idx, s_idx);
+                if(
+                    end_pos_in_s != INVALID && end_pos_in_s > start_pos &&
+                    can_traverse_shortcut(
+                        s_ref, start_pos, end_pos_in_s, settings
+                    )
+                ) {
+                    relax(
+                        goal_idx, INVALID, s_idx,
+                        s_ref.dists[end_pos_in_s] - s_ref.dists[start_pos]
+                    );
+                }
+            }
+            
+            //Go to the junction at the shortcut's end.
+            if(
+                !can_traverse_shortcut(
+                    s_ref, start_pos, s_ref.links.size(), settings
+                )
+            ) {
+                continue;
+            }
+            relax(
+                s_ref.end_idx, INVALID, s_idx,
+                s_ref.dists.back() - s_ref.dists[start_pos]
+            );
+        }
+    }
+    
+    //Start iterating.
+    while(!workspace.is_heap_empty()) {
+    
+        //Part 2: Figure out what stop to work on in this iteration.
+        size_t cur_idx = workspace.pop();
+        float cur_since_start = workspace.get_info(cur_idx).since_start;
+        
+        //Part 3: If the stop we're processing is the goal, then
+        //that's it, best path found! Go back through the shortcuts
+        //to get the stops, starting from the end.
+        if(cur_idx == goal_idx) {
+            out_path.clear();
+            size_t node_idx = goal_idx;
+            while(true) {
+                const a_star_workspace::stop_info &info =
+                    workspace.get_info(node_idx);
+                if(info.prev_shortcut_idx == INVALID) {
+                    //Reached the start junction.
+                    out_path.push_back(stops[node_idx]);
+                    break;
+                }
+                
+                const path_shortcut &s_ref = shortcuts[info.prev_shortcut_idx];
+                size_t from_pos =
+                    info.prev_idx == INVALID ?
+                    get_stop_pos(start_idx, info.prev_shortcut_idx) :
+                    0;
+                size_t to_pos =
+                    node_idx == nr_stops ?
+                    get_stop_pos(end_idx, info.prev_shortcut_idx) :
+                    s_ref.links.size();
+                    
+                //The stop at the start of this part is added by the
+                //part before it, unless this is the first part.
+                for(size_t p = to_pos; p > from_pos; p--) {
+                    out_path.push_back(stops[s_ref.stop_idxs[p]]);
+                }
+                if(info.prev_idx == INVALID) {
+                    out_path.push_back(stops[s_ref.stop_idxs[from_pos]]);
+                    break;
+                }
+                node_idx = info.prev_idx;
+            }
+            std::reverse(out_path.begin(), out_path.end());
+            
+            if(out_total_dist) *out_total_dist = cur_since_start;
+            return true;
+        }
+        
+        //Part 4: Check the shortcuts that leave this junction.
+        const vector<size_t> &cur_shortcuts = junction_shortcuts[cur_idx];
+        for(size_t s = 0; s < cur_shortcuts.size(); s++) {
+            size_t s_idx = cur_shortcuts[s];
+            const path_shortcut &s_ref = shortcuts[s_idx];
+            
+            //Is the end stop somewhere in this shortcut?
+            if(!end_is_junction) {
+                size_t end_pos_in_s = get_stop_pos(end_idx, s_idx);
+                if(
+                    end_pos_in_s != INVALID &&
+                    can_traverse_shortcut(s_ref, 0, end_pos_in_s, settings)
+                ) {
+                    relax(
+                        goal_idx, cur_idx, s_idx,
+                        cur_since_start + s_ref.dists[end_pos_in_s]
+                    );
+                }
+            }
+            
+            //Can this shortcut be traversed?
+            if(
+                !can_traverse_shortcut(
+                    s_ref, 0, s_ref.links.size(), settings
+                )
+            ) {
+                continue;
+            }
+            
+            relax(
+                s_ref.end_idx, cur_idx, s_idx,
+                cur_since_start + s_ref.dists.back()
+            );
+        }
+    }
+    
+    return false;
+}
+
+
+/**
+ * @brief Adds a shortcut, starting at a junction stop, and following
+ * the given link and any skipped stops after it, until the next junction.
+ *
+ * @param start_idx Index of the junction stop to start at.
+ * @param first_link_ptr First link to follow.
+ */
+void contracted_path_graph::add_shortcut(
+    size_t start_idx, path_link* first_link_ptr
+) {
+    const vector<path_stop*> &stops = game.cur_area_data->path_stops;
+    size_t s_idx = shortcuts.size();
+    shortcuts.push_back(path_shortcut());
+    path_shortcut &s_ref = shortcuts.back();
+    
+    s_ref.start_idx = start_idx;
+    s_ref.stop_idxs.push_back(start_idx);
+    s_ref.dists.push_back(0.0f);
+    
+    path_link* l_ptr = first_link_ptr;
+    while(true) {
+        size_t prev_idx = s_ref.stop_idxs.back();
+        size_t cur_idx = l_ptr->end_idx;
+        s_ref.links.push_back(l_ptr);
+        s_ref.stop_idxs.push_back(cur_idx);
+        s_ref.dists.push_back(s_ref.dists.back() + l_ptr->distance);
+        link_shortcut_idxs[l_ptr] = s_idx;
+        
+        if(is_junction[cur_idx]) break;
+        
+        //A skipped stop. Note where it is, and move on to its other link.
+        stop_place &place = stop_places[cur_idx];
+        unsigned char side = place.shortcut_idxs[0] == INVALID ? 0 : 1;
+        place.shortcut_idxs[side] = s_idx;
+        place.positions[side] = s_ref.stop_idxs.size() - 1;
+        
+        path_stop* cur_ptr = stops[cur_idx];
+        l_ptr =
+            cur_ptr->links[0]->end_idx == prev_idx ?
+            cur_ptr->links[1] :
+            cur_ptr->links[0];
+    }
+    
+    s_ref.end_idx = s_ref.stop_idxs.back();
+    junction_shortcuts[start_idx].push_back(s_idx);
+    refresh_shortcut(s_idx);
+}
+
+
+/**
+ * @brief Builds the contracted graph from the current area's path stops.
+ * The stops' sectors must already be known.
+ */
+void contracted_path_graph::build() {
+    clear();
+    
+    const vector<path_stop*> &stops = game.cur_area_data->path_stops;
+    nr_stops = stops.size();
+    is_junction.assign(nr_stops, true);
+    junction_shortcuts.assign(nr_stops, vector<size_t>());
+    stop_places.assign(nr_stops, stop_place());
+    
+    //Count how many links arrive at each stop.
+    vector<size_t> nr_incoming_links(nr_stops, 0);
+    for(size_t s = 0; s < nr_stops; s++) {
+        for(size_t l = 0; l < stops[s]->links.size(); l++) {
+            size_t end_idx = stops[s]->links[l]->end_idx;
+            if(end_idx >= nr_stops) {
+                //Broken link indexes. Better not use the contracted graph.
+                clear();
+                return;
+            }
+            nr_incoming_links[end_idx]++;
+        }
+    }
+    
+    //Figure out which stops can be skipped over.
+    for(size_t s = 0; s < nr_stops; s++) {
+        path_stop* s_ptr = stops[s];
+        if(s_ptr->links.size() != 2 || nr_incoming_links[s] != 2) continue;
+        size_t n1_idx = s_ptr->links[0]->end_idx;
+        size_t n2_idx = s_ptr->links[1]->end_idx;
+        if(n1_idx == n2_idx || n1_idx == s || n2_idx == s) continue;
+        if(!stops[n1_idx]->get_link(s_ptr)) continue;
+        if(!stops[n2_idx]->get_link(s_ptr)) continue;
+        is_junction[s] = false;
+    }
+    
+    //Create the shortcuts from each junction.
+    for(size_t s = 0; s < nr_stops; s++) {
+        if(!is_junction[s]) continue;
+        for(size_t l = 0; l < stops[s]->links.size(); l++) {
+            add_shortcut(s, stops[s]->links[l]);
+        }
+    }
+    
+    //Skipped stops that are in a loop with no junctions weren't reached.
+    //Turn one stop of each such loop into a junction.
+    for(size_t s = 0; s < nr_stops; s++) {
+        if(is_junction[s]) continue;
+        if(stop_places[s].shortcut_idxs[0] != INVALID) continue;
+        is_junction[s] = true;
+        for(size_t l = 0; l < stops[s]->links.size(); l++) {
+            add_shortcut(s, stops[s]->links[l]);
+        }
+    }
+    
+    built = true;
+}
+
+
+/**
+ * @brief Returns whether a part of a shortcut can be traversed given
+ * some constraints.
+ *
+ * @param shortcut Shortcut to check.
+ * @param from_pos Position in the list of stops to start at.
+ * @param to_pos Position in the list of stops to end at.
+ * @param settings Settings about how the path should be followed.
+ * @return Whether it can be traversed.
+ */
+bool contracted_path_graph::can_traverse_shortcut(
+    const path_shortcut &shortcut, size_t from_pos, size_t to_pos,
+    const path_follow_settings &settings
+) const {
+    if(shortcut.needs_full_check) {
+        for(size_t l = from_pos; l < to_pos; l++) {
+            if(!can_traverse_path_link(shortcut.links[l], settings)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    //None of the stops have labels, so a path that only wants stops
+    //with a certain label can't go here.
+    if(!settings.label.empty()) return false;
+    
+    if(
+        shortcut.nr_blocked_links == 0 ||
+        has_flag(settings.flags, PATH_FOLLOW_FLAG_IGNORE_OBSTACLES)
+    ) {
+        return true;
+    }
+    for(size_t l = from_pos; l < to_pos; l++) {
+        if(shortcut.links[l]->blocked_by_obstacle) return false;
+    }
+    return true;
+}
+
+
+/**
+ * @brief Clears the contracted graph.
+ */
+void contracted_path_graph::clear() {
+    built = false;
+    nr_stops = 0;
+    is_junction.clear();
+    junction_shortcuts.clear();
+    stop_places.clear();
+    shortcuts.clear();
+    link_shortcut_idxs.clear();
+}
+
+
+/**
+ * @brief Returns the position of a skipped stop in a shortcut's
+ * list of stops.
+ *
+ * @param stop_idx Index of the stop.
+ * @param shortcut_idx Index of the shortcut.
+ * @return The position, or INVALID if the stop is not in the middle
+ * of that shortcut.
+ */
+size_t contracted_path_graph::get_stop_pos(
+    size_t stop_idx, size_t shortcut_idx
+) const {
+    const stop_place &place = stop_places[stop_idx];
+    for(unsigned char side = 0; side < 2; side++) {
+        if(place.shortcut_idxs[side] == shortcut_idx) {
+            return place.positions[side];
+        }
+    }
+    return INVALID;
+}
+
+
+/**
+ * @brief Returns whether the contracted graph can be used for the
+ * current area's path stops.
+ *
+ * @return Whether it can be used.
+ */
+bool contracted_path_graph::is_usable() const {
+    return
+        built && game.cur_area_data &&
+        game.cur_area_data->path_stops.size() == nr_stops;
+}
+
+
+/**
+ * @brief Updates the shortcut a link belongs to, after the link
+ * got blocked or unblocked.
+ *
+ * @param link_ptr Link that changed.
+ */
+void contracted_path_graph::refresh_link(const path_link* link_ptr) {
+    auto it = link_shortcut_idxs.find(link_ptr);
+    if(it == link_shortcut_idxs.end()) return;
+    refresh_shortcut(it->second);
+}
+
+
+/**
+ * @brief Updates the shortcuts that go through stops in a sector,
+ * after the sector's hazards changed.
+ *
+ * @param sector_ptr Sector that changed.
+ */
+void contracted_path_graph::refresh_sector(const sector* sector_ptr) {
+    const vector<path_stop*> &stops = game.cur_area_data->path_stops;
+    for(size_t s = 0; s < shortcuts.size(); s++) {
+        const path_shortcut &s_ref = shortcuts[s];
+        for(size_t p = 1; p < s_ref.stop_idxs.size(); p++) {
+            if(stops[s_ref.stop_idxs[p]]->sector_ptr == sector_ptr) {
+                refresh_shortcut(s);
+                break;
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief Updates a shortcut's information about its restrictions and
+ * blocked links.
+ *
+ * @param shortcut_idx Index of the shortcut.
+ */
+void contracted_path_graph::refresh_shortcut(size_t shortcut_idx) {
+    path_shortcut &s_ref = shortcuts[shortcut_idx];
+    s_ref.needs_full_check = false;
+    s_ref.nr_blocked_links = 0;
+    
+    for(size_t l = 0; l < s_ref.links.size(); l++) {
+        path_link* l_ptr = s_ref.links[l];
+        if(l_ptr->blocked_by_obstacle) s_ref.nr_blocked_links++;
+        
+        //Anything that could stop some path from going through means
+        //checking link by link.
+        const path_stop* end_ptr = l_ptr->end_ptr;
+        if(
+            l_ptr->type != PATH_LINK_TYPE_NORMAL ||
+            end_ptr->flags != 0 ||
+            !end_ptr->label.empty() ||
+            !l_ptr->start_ptr->sector_ptr ||
+            !end_ptr->sector_ptr ||
+            !end_ptr->sector_ptr->hazards.empty()
+        ) {
+            s_ref.needs_full_check = true;
+        }
+    }
+}
+
+
+/**
+ * @brief Constructs a new path cache key object.
+ *
+ * @param start_idx Index of the start stop.
+ * @param end_idx Index of the end stop.
+ * @param settings Settings about how the path should be followed.
+ */
+path_cache_key::path_cache_key(
+    size_t start_idx, size_t end_idx,
+    const path_follow_settings &settings
+) :
+    start_idx(start_idx),
+    end_idx(end_idx),
+    flags(
+        settings.flags & (
+            PATH_FOLLOW_FLAG_IGNORE_OBSTACLES |
+            PATH_FOLLOW_FLAG_SCRIPT_USE |
+            PATH_FOLLOW_FLAG_LIGHT_LOAD |
+            PATH_FOLLOW_FLAG_AIRBORNE
+        )
+    ),
+    invulnerabilities(settings.invulnerabilities),
+    label(settings.label) {
+    
+    std::sort(invulnerabilities.begin(), invulnerabilities.end());
+}
+
+
+/**
+ * @brief Returns whether this key comes before another one.
+ *
+ * @param k2 Key to compare with.
+ * @return Whether it comes before.
+ */
+bool path_cache_key::operator<(const path_cache_key &k2) const {
+    if(start_idx != k2.start_idx) return start_idx < k2.start_idx;
+    if(end_idx != k2.end_idx) return end_idx < k2.end_idx;
+    if(flags != k2.flags) return flags < k2.flags;
+    if(invulnerabilities != k2.invulnerabilities) {
+        return invulnerabilities < k2.invulnerabilities;
+    }
+    return label < k2.label;
+}
+
+
+/**
+ * @brief Constructs a new path flow field object.
+ *
+ * @param key Key with the end stop and settings.
+ */
+path_flow_field::path_flow_field(const path_cache_key &key) :
+    key(key) {
+    
+    settings.flags = key.flags;
+    settings.invulnerabilities = key.invulnerabilities;
+    settings.label = key.label;
+}
+
+
+/**
+ * @brief Builds the flow field from scratch, by running Dijkstra's
+ * algorithm backwards from the end stop.
+ *
+ * @param workspace Workspace to use for the search.
+ * @param incoming_links Links that lead into each stop.
+ */
+void path_flow_field::build(
+    a_star_workspace &workspace,
+    const incoming_path_links_t &incoming_links
+) {
+    size_t nr_stops = incoming_links.size();
+    dists.assign(nr_stops, FLT_MAX);
+    next_idxs.assign(nr_stops, INVALID);
+    if(key.end_idx >= nr_stops) return;
+    
+    workspace.start_search(nr_stops);
+    dists[key.end_idx] = 0.0f;
+    workspace.get_info(key.end_idx).estimated = 0.0f;
+    workspace.push_or_update(key.end_idx);
+    propagate(workspace, incoming_links);
+}
+
+
+/**
+ * @brief Returns the shortest path from a stop to the end stop.
+ *
+ * @param start_idx Index of the start stop.
+ * @param out_path The stops to visit, in order, are returned here.
+ * @param out_total_dist If not nullptr, the total path distance is
+ * returned here.
+ * @return Whether there is a path.
+ */
+bool path_flow_field::get_path(
+    size_t start_idx, vector<path_stop*> &out_path,
+    float* out_total_dist
+) const {
+    out_path.clear();
+    if(start_idx >= dists.size() || dists[start_idx] == FLT_MAX) {
+        return false;
+    }
+    
+    const vector<path_stop*> &stops = game.cur_area_data->path_stops;
+    for(size_t s = start_idx; s != INVALID; s = next_idxs[s]) {
+        out_path.push_back(stops[s]);
+    }
+    if(out_total_dist) *out_total_dist = dists[start_idx];
+    return true;
+}
+
+
+/**
+ * @brief Continues Dijkstra's algorithm from the stops in the workspace's
+ * heap, lowering the distances of any stops that can get to the
+ * end stop through them.
+ *
+ * @param workspace Workspace with the stops whose distance got lowered.
+ * @param incoming_links Links that lead into each stop.
+ */
+void path_flow_field::propagate(
+    a_star_workspace &workspace,
+    const incoming_path_links_t &incoming_links
+) {
+    while(!workspace.is_heap_empty()) {
+        size_t cur_idx = workspace.pop();
+        for(size_t l = 0; l < incoming_links[cur_idx].size(); l++) {
+            size_t prev_idx = incoming_links[cur_idx][l].first;
+            path_link* l_ptr = incoming_links[cur_idx][l].second;
+            
+            float new_dist = dists[cur_idx] + l_ptr->distance;
+            if(new_dist >= dists[prev_idx]) continue;
+            if(!can_traverse_path_link(l_ptr, settings)) continue;
+            
+            dists[prev_idx] = new_dist;
+            next_idxs[prev_idx] = cur_idx;
+            workspace.get_info(prev_idx).estimated = new_dist;
+            workspace.push_or_update(prev_idx);
+        }
+    }
+}
+
+
+/**
+ * @brief Updates the flow field after some links got blocked or unblocked,
+ * or after their end stops changed. Only the stops whose distance
+ * is affected get recalculated.
+ *
+ * @param workspace Workspace to use for the search.
+ * @param links Links that changed.
+ * @param incoming_links Links that lead into each stop.
+ */
+void path_flow_field::refresh_links(
+    a_star_workspace &workspace, const vector<path_link*> &links,
+    const incoming_path_links_t &incoming_links
+) {
+    if(dists.size() != incoming_links.size()) return;
+    workspace.start_search(dists.size());
+    
+    //If a stop's way to the end went through a link that can't be used
+    //any more, that stop and every stop that relied on it need to find
+    //another way. Start with whatever neighbor they can still go to.
+    vector<size_t> start_idxs(links.size(), INVALID);
+    for(size_t l = 0; l < links.size(); l++) {
+        if(links[l]->end_idx >= dists.size()) continue;
+        const vector<std::pair<size_t, path_link*> > &end_links =
+            incoming_links[links[l]->end_idx];
+        for(size_t el = 0; el < end_links.size(); el++) {
+            if(end_links[el].second == links[l]) {
+                start_idxs[l] = end_links[el].first;
+                break;
+            }
+        }
+    }
+    
+    vector<size_t> reset_idxs;
+    for(size_t l = 0; l < links.size(); l++) {
+        size_t start_idx = start_idxs[l];
+        if(start_idx == INVALID) continue;
+        if(next_idxs[start_idx] != links[l]->end_idx) continue;
+        if(can_traverse_path_link(links[l], settings)) continue;
+        
+        reset_idxs.clear();
+        reset_subtree(start_idx, reset_idxs);
+        
+        for(size_t r = 0; r < reset_idxs.size(); r++) {
+            size_t r_idx = reset_idxs[r];
+            path_stop* r_ptr = game.cur_area_data->path_stops[r_idx];
+            for(size_t rl = 0; rl < r_ptr->links.size(); rl++) {
+                path_link* rl_ptr = r_ptr->links[rl];
+                if(rl_ptr->end_idx >= dists.size()) continue;
+                if(dists[rl_ptr->end_idx] == FLT_MAX) continue;
+                
+                float new_dist = dists[rl_ptr->end_idx] + rl_ptr->distance;
+                if(new_dist >= dists[r_idx]) continue;
+                if(!can_traverse_path_link(rl_ptr, settings)) continue;
+                
+                dists[r_idx] = new_dist;
+                next_idxs[r_idx] = rl_ptr->end_idx;
+            }
+            if(dists[r_idx] != FLT_MAX) {
+                workspace.get_info(r_idx).estimated = dists[r_idx];
+                workspace.push_or_update(r_idx);
+            }
+        }
+        propagate(workspace, incoming_links);
+    }
+    
+    //If a link can be used now, and it gives its start stop a shorter
+    //way to the end, spread that around.
+    for(size_t l = 0; l < links.size(); l++) {
+        size_t start_idx = start_idxs[l];
+        size_t end_idx = links[l]->end_idx;
+        if(start_idx == INVALID || dists[end_idx] == FLT_MAX) continue;
+        
+        float new_dist = dists[end_idx] + links[l]->distance;
+        if(new_dist >= dists[start_idx]) continue;
+        if(!can_traverse_path_link(links[l], settings)) continue;
+        
+        dists[start_idx] = new_dist;
+        next_idxs[start_idx] = end_idx;
+        workspace.get_info(start_idx).estimated = new_dist;
+        workspace.push_or_update(start_idx);
+    }
+    propagate(workspace, incoming_links);
+}
+
+
+/**
+ * @brief Forgets the distance of a stop, and of every stop whose way
+ * to the end goes through it.
+ *
+ * @param stop_idx Index of the stop.
+ * @param out_reset_idxs The indexes of the stops that got reset are
+ * added here.
+ */
+void path_flow_field::reset_subtree(
+    size_t stop_idx, vector<size_t> &out_reset_idxs
+) {
+    //0 = not known yet, 1 = goes through the stop, 2 = doesn't.
+    vector<unsigned char> states(dists.size(), 0);
+    states[stop_idx] = 1;
+    vector<size_t> chain;
+    
+    for(size_t s = 0; s < dists.size(); s++) {
+        //Follow the way to the end until we find out where it goes.
+        size_t cur_idx = s;
+        while(cur_idx != INVALID && states[cur_idx] == 0) {
+            chain.push_back(cur_idx);
+            cur_idx = next_idxs[cur_idx];
+        }
+        unsigned char state = cur_idx == INVALID ? 2 : states[cur_idx];
+        for(size_t c = 0; c < chain.size(); c++) {
+            states[chain[c]] = state;
+        }
+        chain.clear();
+    }
+    
+    for(size_t s = 0; s < dists.size(); s++) {
+        if(states[s] != 1) continue;
+        dists[s] = FLT_MAX;
+        next_idxs[s] = INVALID;
+        out_reset_idxs.push_back(s);
+    }
+}
+
+
+/**
+ * @brief Copies the current state of the area's paths.
+ *
+ * @param obstructions The path manager's known obstructions.
+ */
+void path_graph_snapshot::take(
+    const map<path_link*, unordered_set<mob*> > &obstructions
+) {
+    blocked_links.clear();
+    for(auto &o : obstructions) {
+        blocked_links.insert(o.first);
+    }
+    
+    sector_hazards.clear();
+    for(size_t s = 0; s < game.cur_area_data->sectors.size(); s++) {
+        sector* s_ptr = game.cur_area_data->sectors[s];
+        if(s_ptr->hazards.empty()) continue;
+        sector_hazards[s_ptr] = s_ptr->hazards;
+    }
+}
+
+
+/**
+ * @brief Picks the landmarks for the current area's path stops, and
+ * calculates their distances.
+ *
+ * The landmarks are picked one by one, each one being the stop that's the
+ * farthest away from the landmarks picked so far. Stops that no landmark
+ * can reach yet are picked first, so every part of the graph gets one.
+ *
+ * @param incoming_links Links that lead into each stop.
+ */
+void path_landmarks::build(const incoming_path_links_t &incoming_links) {
+    clear();
+    
+    nr_stops = incoming_links.size();
+    built = true;
+    size_t nr_landmarks = std::min(PATHS::NR_LANDMARKS, nr_stops);
+    if(nr_landmarks == 0) return;
+    
+    dists_from.assign(nr_stops * nr_landmarks, FLT_MAX);
+    dists_to.assign(nr_stops * nr_landmarks, FLT_MAX);
+    landmark_idxs.assign(nr_landmarks, INVALID);
+    a_star_workspace workspace;
+    
+    //Start with the stop farthest from the first one.
+    landmark_idxs[0] = 0;
+    calculate_dists(workspace, 0, false, incoming_links);
+    vector<float> min_dists(nr_stops, FLT_MAX);
+    for(size_t s = 0; s < nr_stops; s++) {
+        min_dists[s] = dists_from[s * nr_landmarks];
+    }
+    
+    size_t nr_picked = 0;
+    while(nr_picked < nr_landmarks) {
+        size_t farthest_idx = 0;
+        for(size_t s = 1; s < nr_stops; s++) {
+            if(min_dists[s] > min_dists[farthest_idx]) farthest_idx = s;
+        }
+        if(nr_picked > 0 && min_dists[farthest_idx] == 0.0f) {
+            //Every stop is a landmark already.
+            break;
+        }
+        
+        landmark_idxs[nr_picked] = farthest_idx;
+        calculate_dists(workspace, nr_picked, false, incoming_links);
+        calculate_dists(workspace, nr_picked, true, incoming_links);
+        
+        if(nr_picked == 0) min_dists.assign(nr_stops, FLT_MAX);
+        for(size_t s = 0; s < nr_stops; s++) {
+            size_t d_idx = s * nr_landmarks + nr_picked;
+            min_dists[s] =
+                std::min(
+                    min_dists[s],
+                    std::min(dists_from[d_idx], dists_to[d_idx])
+                );
+        }
+        nr_picked++;
+    }
+    
+    if(nr_picked < nr_landmarks) {
+        //Trim the unused landmarks.
+        vector<float> old_dists_from = dists_from;
+        vector<float> old_dists_to = dists_to;
+        dists_from.resize(nr_stops * nr_picked);
+        dists_to.resize(nr_stops * nr_picked);
+        for(size_t s = 0; s < nr_stops; s++) {
+            for(size_t l = 0; l < nr_picked; l++) {
+                dists_from[s * nr_picked + l] =
+                    old_dists_from[s * nr_landmarks + l];
+                dists_to[s * nr_picked + l] =
+                    old_dists_to[s * nr_landmarks + l];
+            }
+        }
+        landmark_idxs.resize(nr_picked);
+    }
+}
+
+
+/**
+ * @brief Calculates the shortest distance between a landmark and every
+ * stop, with Dijkstra's algorithm, ignoring any restrictions.
+ *
+ * @param workspace Workspace to use for the search.
+ * @param landmark_nr Number of the landmark.
+ * @param to_landmark If true, the distances from every stop to the landmark
+ * are calculated. If false, from the landmark to every stop.
+ * @param incoming_links Links that lead into each stop.
+ */
+void path_landmarks::calculate_dists(
+    a_star_workspace &workspace, size_t landmark_nr, bool to_landmark,
+    const incoming_path_links_t &incoming_links
+) {
+    const vector<path_stop*> &stops = game.cur_area_data->path_stops;
+    size_t nr_landmarks = landmark_idxs.size();
+    vector<float> &dists = to_landmark ? dists_to : dists_from;
+    for(size_t s = 0; s < nr_stops; s++) {
+        dists[s * nr_landmarks + landmark_nr] = FLT_MAX;
+    }
+    
+    workspace.start_search(nr_stops);
+    a_star_workspace::stop_info &start_info =
+        workspace.get_info(landmark_idxs[landmark_nr]);
+    start_info.since_start = 0.0f;
+    start_info.estimated = 0.0f;
+    workspace.push_or_update(landmark_idxs[landmark_nr]);
+    
+    auto relax =
+    [&workspace] (size_t stop_idx, float since_start) {
+        a_star_workspace::stop_info &info = workspace.get_info(stop_idx);
+        if(since_start >= info.since_start) return;
+        info.since_start = since_start;
+        info.estimated = since_start;
+        workspace.push_or_update(stop_idx);
+    };
+    
+    while(!workspace.is_heap_empty()) {
+        size_t cur_idx = workspace.pop();
+        float cur_dist = workspace.get_info(cur_idx).since_start;
+        dists[cur_idx * nr_landmarks + landmark_nr] = cur_dist;
+        
+        if(to_landmark) {
+            for(size_t l = 0; l < incoming_links[cur_idx].size(); l++) {
+                relax(
+                    incoming_links[cur_idx][l].first,
+                    cur_dist + incoming_links[cur_idx][l].second->distance
+                );
+            }
+        } else {
+            path_stop* cur_ptr = stops[cur_idx];
+            for(size_t l = 0; l < cur_ptr->links.size(); l++) {
+                path_link* l_ptr = cur_ptr->links[l];
+                if(l_ptr->end_idx >= nr_stops) continue;
+                relax(l_ptr->end_idx, cur_dist + l_ptr->distance);
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief Clears all info.
+ */
+void path_landmarks::clear() {
+    built = false;
+    nr_stops = 0;
+    landmark_idxs.clear();
+    dists_from.clear();
+    dists_to.clear();
+}
+
+
+/**
+ * @brief Returns the minimum distance that a path between two stops
+ * can have, according to the landmarks.
+ *
+ * @param stop_idx Index of the stop the path starts from.
+ * @param end_idx Index of the stop the path ends at.
+ * @return The minimum distance.
+ */
+float path_landmarks::get_min_dist(size_t stop_idx, size_t end_idx) const {
+    size_t nr_landmarks = landmark_idxs.size();
+    const float* stop_from = &dists_from[stop_idx * nr_landmarks];
+    const float* stop_to = &dists_to[stop_idx * nr_landmarks];
+    const float* end_from = &dists_from[end_idx * nr_landmarks];
+    const float* end_to = &dists_to[end_idx * nr_landmarks];
+    float min_dist = 0.0f;
+    
+    for(size_t l = 0; l < nr_landmarks; l++) {
+        //Going from the landmark to the end can't be shorter than going
+        //from the landmark to the stop, and then from the stop to the end.
+        if(stop_from[l] != FLT_MAX && end_from[l] != FLT_MAX) {
+            min_dist = std::max(min_dist, end_from[l] - stop_from[l]);
+        }
+        //Likewise, going from the stop to the landmark can't be shorter
+        //than going from the stop to the end, and then to the landmark.
+        if(stop_to[l] != FLT_MAX && end_to[l] != FLT_MAX) {
+            min_dist = std::max(min_dist, stop_to[l] - end_to[l]);
+        }
+    }
+    
+    return min_dist;
+}
+
+
+/**
+ * @brief Returns whether the landmarks can be used for the current area's
+ * path stops.
+ *
+ * @return Whether they can be used.
+ */
+bool path_landmarks::is_usable() const {
+    return
+        built && game.cur_area_data &&
+        game.cur_area_data->path_stops.size() == nr_stops;
 }
 
 
@@ -84,10 +1183,44 @@ bool path_link::is_one_way() const {
 }
 
 
+/**
+ * @brief Adds the result of a path search to the cache.
+ * If the cache is full, it's emptied first.
+ *
+ * @param key Key of the search.
+ * @param entry Result of the search.
+ */
+void path_manager::add_cached_path(
+    const path_cache_key &key, const path_cache_entry &entry
+) {
+    if(cached_paths.size() >= PATHS::MAX_CACHED_PATHS) {
+        cached_paths.clear();
+    }
+    cached_paths[key] = entry;
+}
+
+
 /**
  * @brief Clears all info.
  */
 void path_manager::clear() {
+    //The background thread reads some of what's cleared here.
+    path_worker.stop();
+    
+    contracted_graph.clear();
+    cached_paths.clear();
+    stop_grid.clear();
+    replan_queue.clear();
+    queued_replans.clear();
+    flow_fields.clear();
+    flow_field_requests.clear();
+    flow_field_use_nr = 0;
+    incoming_links.clear();
+    landmarks.clear();
+    path_requests.clear();
+    graph_version = 0;
+    graph_snapshot.reset();
+    graph_snapshot_version = 0;
     if(!game.cur_area_data) return;
     
     obstructions.clear();
@@ -102,137 +1235,563 @@ void path_manager::clear() {
 }
 
 
+/**
+ * @brief Returns the cached result of a path search, if any.
+ *
+ * @param key Key of the search.
+ * @return The result, or nullptr if it's not cached.
+ */
+const path_cache_entry* path_manager::get_cached_path(
+    const path_cache_key &key
+) const {
+    auto it = cached_paths.find(key);
+    if(it == cached_paths.end()) return nullptr;
+    return &it->second;
+}
+
+
 /**
  * @brief Handles the area having been loaded. It checks all path stops
- * and saves any sector hazards found.
+ * and saves any sector hazards found, and builds the contracted graph,
+ * the stop grid, the list of links that lead into each stop,
+ * and the landmarks.
+ * It also starts the background thread for path requests.
+ */
+void path_manager::handle_area_load() {
+    //Go through all path stops and check if they're on hazardous sectors.
+    for(size_t s = 0; s < game.cur_area_data->path_stops.size(); s++) {
+        path_stop* s_ptr = game.cur_area_data->path_stops[s];
+        if(!s_ptr->sector_ptr) continue;
+        if(s_ptr->sector_ptr->hazards.empty()) continue;
+        hazardous_stops.insert(s_ptr);
+    }
+    
+    contracted_graph.build();
+    cached_paths.clear();
+    stop_grid.build();
+    
+    //Save which links lead into each stop, for the flow fields.
+    const vector<path_stop*> &stops = game.cur_area_data->path_stops;
+    incoming_links.assign(
+        stops.size(), vector<std::pair<size_t, path_link*> >()
+    );
+    for(size_t s = 0; s < stops.size(); s++) {
+        for(size_t l = 0; l < stops[s]->links.size(); l++) {
+            path_link* l_ptr = stops[s]->links[l];
+            if(l_ptr->end_idx >= stops.size()) continue;
+            incoming_links[l_ptr->end_idx].push_back(
+                std::make_pair(s, l_ptr)
+            );
+        }
+    }
+    
+    landmarks.build(incoming_links);
+    path_worker.start();
+}
+
+
+/**
+ * @brief Handles a mob being deleted, so it doesn't stay in the
+ * replan queue, and doesn't get told about its path request.
+ *
+ * @param m Pointer to the mob being deleted.
+ */
+void path_manager::handle_mob_deletion(const mob* m) {
+    for(size_t r = 0; r < path_requests.size(); r++) {
+        if(path_requests[r].m == m) path_requests[r].m = nullptr;
+    }
+    
+    if(queued_replans.erase((mob*) m) == 0) return;
+    replan_queue.erase(
+        std::find(replan_queue.begin(), replan_queue.end(), m)
+    );
+}
+
+
+/**
+ * @brief Handles an obstacle having been placed. This way, any link with that
+ * obstruction can get updated.
+ *
+ * @param m Pointer to the obstacle mob that got added.
+ */
+void path_manager::handle_obstacle_add(mob* m) {
+    //Add the obstacle to our list, if needed.
+    vector<path_link*> changed_links;
+    
+    //Go through all path links and check if they have obstacles.
+    for(size_t s = 0; s < game.cur_area_data->path_stops.size(); s++) {
+        path_stop* s_ptr = game.cur_area_data->path_stops[s];
+        
+        for(size_t l = 0; l < s_ptr->links.size(); l++) {
+            path_link* l_ptr = game.cur_area_data->path_stops[s]->links[l];
+            
+            if(
+                circle_intersects_line_seg(
+                    m->pos, m->radius,
+                    s_ptr->pos, l_ptr->end_ptr->pos
+                )
+            ) {
+                obstructions[l_ptr].insert(m);
+                if(!l_ptr->blocked_by_obstacle) {
+                    l_ptr->blocked_by_obstacle = true;
+                    contracted_graph.refresh_link(l_ptr);
+                    changed_links.push_back(l_ptr);
+                }
+            }
+        }
+    }
+    
+    if(!changed_links.empty()) {
+        //Any cached path could be different now.
+        cached_paths.clear();
+        refresh_flow_fields(changed_links);
+        graph_version++;
+        
+        //Re-calculate the paths of mobs that went through these links.
+        queue_link_replans(changed_links, false);
+    }
+}
+
+
+/**
+ * @brief Handles an obstacle having been cleared. This way, any link with that
+ * obstruction can get updated.
+ *
+ * @param m Pointer to the obstacle mob that got cleared.
+ */
+void path_manager::handle_obstacle_remove(mob* m) {
+    //Remove the obstacle from our list, if it's there.
+    vector<path_link*> changed_links;
+    
+    for(auto o = obstructions.begin(); o != obstructions.end();) {
+        bool to_delete = false;
+        if(o->second.erase(m) > 0) {
+            if(o->second.empty()) {
+                o->first->blocked_by_obstacle = false;
+                contracted_graph.refresh_link(o->first);
+                to_delete = true;
+                changed_links.push_back(o->first);
+            }
+        }
+        if(to_delete) {
+            o = obstructions.erase(o);
+        } else {
+            ++o;
+        }
+    }
+    
+    if(!changed_links.empty()) {
+        //Any cached path could be different now.
+        cached_paths.clear();
+        refresh_flow_fields(changed_links);
+        graph_version++;
+        
+        //Re-calculate the paths of mobs that could use these links.
+        queue_link_replans(changed_links, true);
+    }
+}
+
+
+/**
+ * @brief Handles a sector having changed its hazards.
+ * This way, any stop on that sector can be updated.
+ *
+ * @param sector_ptr Pointer to the sector whose hazards got updated.
+ */
+void path_manager::handle_sector_hazard_change(sector* sector_ptr) {
+    //Remove relevant stops from our list.
+    bool paths_changed = false;
+    
+    for(auto s = hazardous_stops.begin(); s != hazardous_stops.end();) {
+        bool to_delete = false;
+        if((*s)->sector_ptr == sector_ptr) {
+            paths_changed = true;
+            if(sector_ptr->hazards.empty()) {
+                //We only want to delete it if it became hazardless.
+                to_delete = true;
+            }
+        }
+        
+        if(to_delete) {
+            s = hazardous_stops.erase(s);
+        } else {
+            ++s;
+        }
+    }
+    
+    contracted_graph.refresh_sector(sector_ptr);
+    
+    //The sector may have gained hazards, so this needs to be cleared
+    //even if no stop was known to be hazardous before.
+    cached_paths.clear();
+    graph_version++;
+    
+    //Whether the sector's stops can be reached could've changed.
+    if(!flow_fields.empty()) {
+        vector<path_link*> changed_links;
+        const vector<path_stop*> &stops = game.cur_area_data->path_stops;
+        for(size_t s = 0; s < stops.size() && s < incoming_links.size(); s++) {
+            if(stops[s]->sector_ptr != sector_ptr) continue;
+            for(size_t l = 0; l < incoming_links[s].size(); l++) {
+                changed_links.push_back(incoming_links[s][l].second);
+            }
+        }
+        refresh_flow_fields(changed_links);
+    }
+    
+    if(paths_changed) {
+        //Re-calculate the paths of mobs taking paths.
+        for(size_t m = 0; m < game.states.gameplay->mobs.all.size(); m++) {
+            mob* m_ptr = game.states.gameplay->mobs.all[m];
+            if(!m_ptr->path_info) continue;
+            
+            queue_replan(m_ptr);
+        }
+    }
+}
+
+
+/**
+ * @brief Handles the path requests from the last frame, and makes
+ * new ones for the next mobs in the replan queue.
+ *
+ * The requests from the last frame are waited for, if they're not done
+ * yet, so that each mob always gets its new path on the frame after
+ * the request, no matter how fast the background thread is. Each mob is
+ * handed its request via its path info, and then told to recalculate,
+ * so get_path() uses the result directly. It doesn't depend on the path
+ * cache, which may have been emptied in the meantime. If the mob moved on
+ * to a later stop of the path, it gets the rest of the path from there.
+ */
+void path_manager::process_replan_queue() {
+    path_worker.wait();
+    
+    for(size_t r = 0; r < path_requests.size(); r++) {
+        path_request &req = path_requests[r];
+        
+        //It may have been deleted, or stopped following a path,
+        //in the meantime.
+        if(!req.m || !req.m->path_info) continue;
+        
+        if(req.needs_search) {
+            if(req.graph_version != graph_version) {
+                //The paths changed since then. Try again.
+                queue_replan(req.m);
+                continue;
+            }
+            add_cached_path(req.key, req.entry);
+        }
+        
+        req.m->path_info->replan_request = &req;
+        req.m->fsm.run_event(MOB_EV_PATHS_CHANGED);
+        if(req.m->path_info) req.m->path_info->replan_request = nullptr;
+    }
+    path_requests.clear();
+    
+    for(
+        size_t r = 0;
+        r < PATHS::MAX_REPLANS_PER_FRAME && !replan_queue.empty(); r++
+    ) {
+        mob* m_ptr = replan_queue.front();
+        replan_queue.pop_front();
+        queued_replans.erase(m_ptr);
+        
+        //It may have stopped following a path in the meantime.
+        if(!m_ptr->path_info) continue;
+        
+        request_path(m_ptr);
+    }
+}
+
+
+/**
+ * @brief Adds the mobs that are affected by some links getting blocked
+ * or unblocked to the replan queue.
+ *
+ * If the links got blocked, only mobs whose path goes through
+ * them are affected. If the links got freed, mobs that couldn't find
+ * a clear path are affected, and so are mobs that could have a shorter
+ * path with the links. A path through a link can never be shorter than
+ * the straight line distances from the mob to the link, plus the link,
+ * plus from the link to the mob's final stop, so that's what gets
+ * compared against the rest of the mob's current path.
+ *
+ * @param links Links that got blocked or unblocked.
+ * @param links_freed True if the links got unblocked, false if blocked.
+ */
+void path_manager::queue_link_replans(
+    const vector<path_link*> &links, bool links_freed
+) {
+    for(size_t m = 0; m < game.states.gameplay->mobs.all.size(); m++) {
+        mob* m_ptr = game.states.gameplay->mobs.all[m];
+        path_t* path_ptr = m_ptr->path_info;
+        if(!path_ptr) continue;
+        if(
+            has_flag(
+                path_ptr->settings.flags, PATH_FOLLOW_FLAG_IGNORE_OBSTACLES
+            )
+        ) {
+            continue;
+        }
+        
+        bool affected = false;
+        const vector<path_stop*> &path = path_ptr->path;
+        size_t first_idx =
+            path_ptr->cur_path_stop_idx > 0 ?
+            path_ptr->cur_path_stop_idx - 1 :
+            0;
+            
+        if(!links_freed) {
+            //Check if it's going through any of the links.
+            for(size_t s = first_idx; s + 1 < path.size() && !affected; s++) {
+                for(size_t l = 0; l < links.size(); l++) {
+                    if(
+                        links[l]->start_ptr == path[s] &&
+                        links[l]->end_ptr == path[s + 1]
+                    ) {
+                        affected = true;
+                        break;
+                    }
+                }
+            }
+            
+        } else if(
+            path_ptr->result != PATH_RESULT_NORMAL_PATH ||
+            path_ptr->cur_path_stop_idx >= path.size()
+        ) {
+            //It couldn't find a clear path before, or it's already past
+            //its last stop. Only the first case benefits from a new path.
+            affected =
+                path_ptr->result == PATH_RESULT_PATH_WITH_OBSTACLES ||
+                path_ptr->result < 0;
+                
+        } else {
+            //Check if any of the links could make for a shorter path.
+            float remaining_dist =
+                dist(m_ptr->pos, path[path_ptr->cur_path_stop_idx]->pos).
+                to_float();
+            for(
+                size_t s = path_ptr->cur_path_stop_idx;
+                s + 1 < path.size(); s++
+            ) {
+                remaining_dist +=
+                    dist(path[s]->pos, path[s + 1]->pos).to_float();
+            }
+            const point &final_stop_pos = path.back()->pos;
+            for(size_t l = 0; l < links.size(); l++) {
+                float min_dist =
+                    dist(m_ptr->pos, links[l]->start_ptr->pos).to_float() +
+                    links[l]->distance +
+                    dist(links[l]->end_ptr->pos, final_stop_pos).to_float();
+                if(min_dist < remaining_dist) {
+                    affected = true;
+                    break;
+                }
+            }
+        }
+        
+        if(affected) queue_replan(m_ptr);
+    }
+}
+
+
+/**
+ * @brief Adds a mob to the end of the replan queue, if it's not there yet.
+ *
+ * @param m Pointer to the mob.
+ */
+void path_manager::queue_replan(mob* m) {
+    if(!queued_replans.insert(m).second) return;
+    replan_queue.push_back(m);
+}
+
+
+/**
+ * @brief Updates all flow fields after some links got blocked or
+ * unblocked, or after their end stops changed.
+ *
+ * @param links Links that changed.
  */
-void path_manager::handle_area_load() {
-    //Go through all path stops and check if they're on hazardous sectors.
-    for(size_t s = 0; s < game.cur_area_data->path_stops.size(); s++) {
-        path_stop* s_ptr = game.cur_area_data->path_stops[s];
-        if(!s_ptr->sector_ptr) continue;
-        if(s_ptr->sector_ptr->hazards.empty()) continue;
-        hazardous_stops.insert(s_ptr);
+void path_manager::refresh_flow_fields(const vector<path_link*> &links) {
+    for(size_t f = 0; f < flow_fields.size(); f++) {
+        flow_fields[f].refresh_links(
+            flow_field_workspace, links, incoming_links
+        );
     }
 }
 
 
 /**
- * @brief Handles an obstacle having been placed. This way, any link with that
- * obstruction can get updated.
+ * @brief Returns the flow field for an end stop and settings combination.
+ * If there is none yet, this counts as a request for one, and once it's
+ * been requested enough times, it gets made. If there are too many flow
+ * fields, the one that went unused the longest makes way for it.
  *
- * @param m Pointer to the obstacle mob that got added.
+ * @param key Key with the end stop and settings. The start stop
+ * is not used.
+ * @return The flow field, or nullptr if there isn't one.
  */
-void path_manager::handle_obstacle_add(mob* m) {
-    //Add the obstacle to our list, if needed.
-    bool paths_changed = false;
+path_flow_field* path_manager::request_flow_field(const path_cache_key &key) {
+    path_cache_key field_key = key;
+    field_key.start_idx = INVALID;
+    flow_field_use_nr++;
     
-    //Go through all path links and check if they have obstacles.
-    for(size_t s = 0; s < game.cur_area_data->path_stops.size(); s++) {
-        path_stop* s_ptr = game.cur_area_data->path_stops[s];
-        
-        for(size_t l = 0; l < s_ptr->links.size(); l++) {
-            path_link* l_ptr = game.cur_area_data->path_stops[s]->links[l];
-            
+    for(size_t f = 0; f < flow_fields.size(); f++) {
+        if(
+            !(flow_fields[f].key < field_key) &&
+            !(field_key < flow_fields[f].key)
+        ) {
+            flow_fields[f].last_use_nr = flow_field_use_nr;
+            return &flow_fields[f];
+        }
+    }
+    
+    size_t &nr_requests = flow_field_requests[field_key];
+    nr_requests++;
+    if(nr_requests < PATHS::FLOW_FIELD_MIN_REQUESTS) return nullptr;
+    
+    path_flow_field* field_ptr = nullptr;
+    if(flow_fields.size() < PATHS::MAX_FLOW_FIELDS) {
+        flow_fields.push_back(path_flow_field(field_key));
+        field_ptr = &flow_fields.back();
+    } else {
+        size_t oldest_idx = 0;
+        for(size_t f = 1; f < flow_fields.size(); f++) {
             if(
-                circle_intersects_line_seg(
-                    m->pos, m->radius,
-                    s_ptr->pos, l_ptr->end_ptr->pos
-                )
+                flow_fields[f].last_use_nr <
+                flow_fields[oldest_idx].last_use_nr
             ) {
-                obstructions[l_ptr].insert(m);
-                l_ptr->blocked_by_obstacle = true;
-                paths_changed = true;
+                oldest_idx = f;
             }
         }
+        flow_fields[oldest_idx] = path_flow_field(field_key);
+        field_ptr = &flow_fields[oldest_idx];
     }
     
-    if(paths_changed) {
-        //Re-calculate the paths of mobs taking paths.
-        for(size_t m2 = 0; m2 < game.states.gameplay->mobs.all.size(); m2++) {
-            mob* m2_ptr = game.states.gameplay->mobs.all[m2];
-            if(!m2_ptr->path_info) continue;
-            
-            m2_ptr->fsm.run_event(MOB_EV_PATHS_CHANGED);
-        }
-    }
+    field_ptr->last_use_nr = flow_field_use_nr;
+    field_ptr->build(flow_field_workspace, incoming_links);
+    return field_ptr;
 }
 
 
 /**
- * @brief Handles an obstacle having been cleared. This way, any link with that
- * obstruction can get updated.
+ * @brief Makes a request for a mob's path, according to its current
+ * path settings. The search runs in the background, and the mob gets
+ * told about it on the next call to process_replan_queue().
+ * In the meantime, the mob carries on with its current path.
  *
- * @param m Pointer to the obstacle mob that got cleared.
+ * @param m Pointer to the mob. It must be following a path.
  */
-void path_manager::handle_obstacle_remove(mob* m) {
-    //Remove the obstacle from our list, if it's there.
-    bool paths_changed = false;
+void path_manager::request_path(mob* m) {
+    const path_follow_settings &settings = m->path_info->settings;
     
-    for(auto o = obstructions.begin(); o != obstructions.end();) {
-        bool to_delete = false;
-        if(o->second.erase(m) > 0) {
-            if(o->second.empty()) {
-                o->first->blocked_by_obstacle = false;
-                to_delete = true;
-                paths_changed = true;
-            }
-        }
-        if(to_delete) {
-            o = obstructions.erase(o);
-        } else {
-            ++o;
-        }
+    point start_to_use =
+        has_flag(settings.flags, PATH_FOLLOW_FLAG_FAKED_START) ?
+        settings.faked_start :
+        m->pos;
+    point end_to_use =
+        has_flag(settings.flags, PATH_FOLLOW_FLAG_FAKED_END) ?
+        settings.faked_end :
+        settings.target_point;
+        
+    //Find the start and end stops now, like get_path() will.
+    size_t start_idx = INVALID;
+    size_t end_idx = INVALID;
+    if(stop_grid.is_usable()) {
+        auto filter = [&settings] (path_stop* s_ptr) -> bool {
+            return can_take_path_stop(s_ptr, settings);
+        };
+        start_idx = stop_grid.get_closest_stop(start_to_use, filter, nullptr);
+        end_idx = stop_grid.get_closest_stop(end_to_use, filter, nullptr);
     }
     
-    if(paths_changed) {
-        //Re-calculate the paths of mobs taking paths.
-        for(size_t m2 = 0; m2 < game.states.gameplay->mobs.all.size(); m2++) {
-            mob* m2_ptr = game.states.gameplay->mobs.all[m2];
-            if(!m2_ptr->path_info) continue;
-            
-            m2_ptr->fsm.run_event(MOB_EV_PATHS_CHANGED);
-        }
+    path_requests.push_back(
+        path_request(m, path_cache_key(start_idx, end_idx, settings))
+    );
+    path_request &req = path_requests.back();
+    req.settings = settings;
+    
+    //If there's no need for a search, the mob can find its path without
+    //help. If the result is cached already, keep a copy, since the cache
+    //could be emptied before the mob gets to use it.
+    if(
+        start_idx == INVALID || end_idx == INVALID ||
+        start_idx == end_idx
+    ) {
+        return;
+    }
+    const path_cache_entry* cached_entry = get_cached_path(req.key);
+    if(cached_entry) {
+        req.entry = *cached_entry;
+        return;
+    }
+    req.needs_search = true;
+    
+    if(!graph_snapshot || graph_snapshot_version != graph_version) {
+        path_graph_snapshot* new_snapshot = new path_graph_snapshot();
+        new_snapshot->take(obstructions);
+        graph_snapshot.reset(new_snapshot);
+        graph_snapshot_version = graph_version;
     }
+    req.snapshot = graph_snapshot;
+    req.graph_version = graph_version;
+    
+    path_request* req_ptr = &req;
+    path_worker.add_task([req_ptr] () { req_ptr->run(); });
 }
 
 
 /**
- * @brief Handles a sector having changed its hazards.
- * This way, any stop on that sector can be updated.
+ * @brief Constructs a new path request object.
  *
- * @param sector_ptr Pointer to the sector whose hazards got updated.
+ * @param m Mob that wants the path.
+ * @param key Key with the start stop, end stop, and settings.
  */
-void path_manager::handle_sector_hazard_change(sector* sector_ptr) {
-    //Remove relevant stops from our list.
-    bool paths_changed = false;
+path_request::path_request(mob* m, const path_cache_key &key) :
+    m(m),
+    key(key) {
     
-    for(auto s = hazardous_stops.begin(); s != hazardous_stops.end();) {
-        bool to_delete = false;
-        if((*s)->sector_ptr == sector_ptr) {
-            paths_changed = true;
-            if(sector_ptr->hazards.empty()) {
-                //We only want to delete it if it became hazardless.
-                to_delete = true;
-            }
-        }
-        
-        if(to_delete) {
-            s = hazardous_stops.erase(s);
-        } else {
-            ++s;
-        }
+}
+
+
+/**
+ * @brief Runs the search, with the same outcomes as a_star(), but using
+ * the snapshot of the area's paths. This is meant to run on the
+ * background thread, so it must not touch anything else that
+ * can change.
+ */
+void path_request::run() {
+    //Each thread gets its own workspace. Cache for performance.
+    static thread_local a_star_workspace workspace;
+    
+    bool found =
+        a_star_full_graph(
+            workspace, entry.path, key.start_idx, key.end_idx,
+            settings, &entry.total_dist, snapshot.get()
+        );
+    if(found) {
+        entry.result = PATH_RESULT_NORMAL_PATH;
+        return;
     }
     
-    if(paths_changed) {
-        //Re-calculate the paths of mobs taking paths.
-        for(size_t m = 0; m < game.states.gameplay->mobs.all.size(); m++) {
-            mob* m_ptr = game.states.gameplay->mobs.all[m];
-            if(!m_ptr->path_info) continue;
-            
-            m_ptr->fsm.run_event(MOB_EV_PATHS_CHANGED);
+    if(!has_flag(settings.flags, PATH_FOLLOW_FLAG_IGNORE_OBSTACLES)) {
+        //Try again, this time ignoring obstacles.
+        path_follow_settings new_settings = settings;
+        enable_flag(new_settings.flags, PATH_FOLLOW_FLAG_IGNORE_OBSTACLES);
+        found =
+            a_star_full_graph(
+                workspace, entry.path, key.start_idx, key.end_idx,
+                new_settings, &entry.total_dist, snapshot.get()
+            );
+        if(found) {
+            entry.result = PATH_RESULT_PATH_WITH_OBSTACLES;
+            return;
         }
     }
+    
+    entry.path.clear();
+    entry.total_dist = 0.0f;
+    entry.result = PATH_RESULT_END_STOP_UNREACHABLE;
 }
 
 
@@ -387,6 +1946,219 @@ void path_stop::remove_link(const path_stop* other_stop) {
 }
 
 
+/**
+ * @brief Builds the grid for the current area's path stops.
+ */
+void path_stop_grid::build() {
+    clear();
+    
+    const vector<path_stop*> &stops = game.cur_area_data->path_stops;
+    nr_stops = stops.size();
+    built = true;
+    if(stops.empty()) return;
+    
+    //Find the limits.
+    point bottom_right_corner = stops[0]->pos;
+    top_left_corner = stops[0]->pos;
+    for(size_t s = 0; s < stops.size(); s++) {
+        path_stop* s_ptr = stops[s];
+        top_left_corner.x = std::min(top_left_corner.x, s_ptr->pos.x);
+        top_left_corner.y = std::min(top_left_corner.y, s_ptr->pos.y);
+        bottom_right_corner.x = std::max(bottom_right_corner.x, s_ptr->pos.x);
+        bottom_right_corner.y = std::max(bottom_right_corner.y, s_ptr->pos.y);
+        max_stop_radius = std::max(max_stop_radius, s_ptr->radius);
+    }
+    n_cols =
+        floor(
+            (bottom_right_corner.x - top_left_corner.x) /
+            PATHS::STOP_GRID_CELL_SIZE
+        ) + 1;
+    n_rows =
+        floor(
+            (bottom_right_corner.y - top_left_corner.y) /
+            PATHS::STOP_GRID_CELL_SIZE
+        ) + 1;
+        
+    //Count the stops in each cell, and figure out where each cell
+    //starts in the list.
+    vector<size_t> stop_cells(stops.size());
+    cell_starts.assign(n_cols * n_rows + 1, 0);
+    for(size_t s = 0; s < stops.size(); s++) {
+        size_t col =
+            get_cell_coord(stops[s]->pos.x, top_left_corner.x, n_cols);
+        size_t row =
+            get_cell_coord(stops[s]->pos.y, top_left_corner.y, n_rows);
+        stop_cells[s] = row * n_cols + col;
+        cell_starts[stop_cells[s] + 1]++;
+    }
+    for(size_t c = 0; c < n_cols * n_rows; c++) {
+        cell_starts[c + 1] += cell_starts[c];
+    }
+    
+    //Fill in the cells. The stops in each cell end up sorted by index.
+    vector<size_t> cell_fill = cell_starts;
+    cell_stop_idxs.assign(stops.size(), INVALID);
+    for(size_t s = 0; s < stops.size(); s++) {
+        cell_stop_idxs[cell_fill[stop_cells[s]]] = s;
+        cell_fill[stop_cells[s]]++;
+    }
+}
+
+
+/**
+ * @brief Clears all info.
+ */
+void path_stop_grid::clear() {
+    built = false;
+    nr_stops = 0;
+    top_left_corner = point();
+    n_cols = 0;
+    n_rows = 0;
+    max_stop_radius = 0.0f;
+    cell_starts.clear();
+    cell_stop_idxs.clear();
+}
+
+
+/**
+ * @brief Returns the column or row of the cell that a coordinate
+ * belongs to. Coordinates outside the grid get the closest
+ * column or row.
+ *
+ * @param coord The X or Y coordinate.
+ * @param top_left_coord The grid's top-left corner's X or Y coordinate.
+ * @param n Number of columns or rows.
+ * @return The column or row.
+ */
+size_t path_stop_grid::get_cell_coord(
+    float coord, float top_left_coord, size_t n
+) const {
+    float cell = floor((coord - top_left_coord) / PATHS::STOP_GRID_CELL_SIZE);
+    if(cell < 0.0f) return 0;
+    if(cell >= (float) n) return n - 1;
+    return cell;
+}
+
+
+/**
+ * @brief Returns the stop closest to a point, out of the stops that
+ * pass a filter. The distance to a stop is measured from its edge, not its
+ * center, and is 0 if the point is inside the stop. In case of a tie, the
+ * stop with the lowest index is returned.
+ *
+ * @param p Point to check.
+ * @param filter Function that returns whether a stop can be returned.
+ * It is only called for stops that are the closest found so far.
+ * @param out_dist If not nullptr, the distance to the stop is returned here.
+ * If no stop was found, 0 is returned.
+ * @return The stop's index, or INVALID if none.
+ */
+size_t path_stop_grid::get_closest_stop(
+    const point &p, const std::function<bool(path_stop*)> &filter,
+    float* out_dist
+) const {
+    const vector<path_stop*> &stops = game.cur_area_data->path_stops;
+    size_t best_idx = INVALID;
+    float best_dist = 0.0f;
+    if(out_dist) *out_dist = 0.0f;
+    if(n_cols == 0 || n_rows == 0) return INVALID;
+    
+    //Check cells in rings around the point's cell, going outward.
+    int center_col = get_cell_coord(p.x, top_left_corner.x, n_cols);
+    int center_row = get_cell_coord(p.y, top_left_corner.y, n_rows);
+    for(int r = 0; ; r++) {
+        int min_col = std::max(center_col - r, 0);
+        int max_col = std::min(center_col + r, (int) n_cols - 1);
+        int min_row = std::max(center_row - r, 0);
+        int max_row = std::min(center_row + r, (int) n_rows - 1);
+        
+        for(int row = min_row; row <= max_row; row++) {
+            bool full_row = abs(row - center_row) == r;
+            for(int col = min_col; col <= max_col; col++) {
+                if(!full_row && abs(col - center_col) != r) {
+                    //Only the ring's edges need checking. Skip to the end.
+                    col = std::max(col, center_col + r - 1);
+                    continue;
+                }
+                
+                size_t cell = row * n_cols + col;
+                for(
+                    size_t c = cell_starts[cell];
+                    c < cell_starts[cell + 1]; c++
+                ) {
+                    size_t s = cell_stop_idxs[c];
+                    path_stop* s_ptr = stops[s];
+                    float d =
+                        std::max(
+                            0.0f,
+                            dist(p, s_ptr->pos).to_float() - s_ptr->radius
+                        );
+                    bool is_better =
+                        best_idx == INVALID || d < best_dist ||
+                        (d == best_dist && s < best_idx);
+                    if(!is_better) continue;
+                    if(!filter(s_ptr)) continue;
+                    best_idx = s;
+                    best_dist = d;
+                }
+            }
+        }
+        
+        //Figure out how close any cell not checked yet could be.
+        bool checked_all = true;
+        float unchecked_dist = FLT_MAX;
+        if(min_col > 0) {
+            checked_all = false;
+            float edge_x =
+                top_left_corner.x + min_col * PATHS::STOP_GRID_CELL_SIZE;
+            unchecked_dist = std::min(unchecked_dist, p.x - edge_x);
+        }
+        if(max_col < (int) n_cols - 1) {
+            checked_all = false;
+            float edge_x =
+                top_left_corner.x + (max_col + 1) * PATHS::STOP_GRID_CELL_SIZE;
+            unchecked_dist = std::min(unchecked_dist, edge_x - p.x);
+        }
+        if(min_row > 0) {
+            checked_all = false;
+            float edge_y =
+                top_left_corner.y + min_row * PATHS::STOP_GRID_CELL_SIZE;
+            unchecked_dist = std::min(unchecked_dist, p.y - edge_y);
+        }
+        if(max_row < (int) n_rows - 1) {
+            checked_all = false;
+            float edge_y =
+                top_left_corner.y + (max_row + 1) * PATHS::STOP_GRID_CELL_SIZE;
+            unchecked_dist = std::min(unchecked_dist, edge_y - p.y);
+        }
+        if(checked_all) break;
+        if(
+            best_idx != INVALID &&
+            unchecked_dist - max_stop_radius > best_dist
+        ) {
+            //No stop in the remaining cells can be closer.
+            break;
+        }
+    }
+    
+    if(out_dist) *out_dist = best_dist;
+    return best_idx;
+}
+
+
+/**
+ * @brief Returns whether the grid can be used for the current area's
+ * path stops.
+ *
+ * @return Whether it can be used.
+ */
+bool path_stop_grid::is_usable() const {
+    return
+        built && game.cur_area_data &&
+        game.cur_area_data->path_stops.size() == nr_stops;
+}
+
+
 /**
  * @brief Checks if a path stop can be taken given some contraints.
  *
@@ -423,11 +2195,14 @@ bool can_take_path_stop(
  * @param settings Settings about how the path should be followed.
  * @param sector_ptr Pointer to the sector this stop is on.
  * @param out_reason If not nullptr, the reason is returned here.
+ * @param snapshot If not nullptr, the sector's hazards are read from this
+ * snapshot of the area's paths instead.
  * @return Whether it can take it.
  */
 bool can_take_path_stop(
     const path_stop* stop_ptr, const path_follow_settings &settings,
-    sector* sector_ptr, PATH_BLOCK_REASON* out_reason
+    sector* sector_ptr, PATH_BLOCK_REASON* out_reason,
+    const path_graph_snapshot* snapshot
 ) {
     //Check if the end stop has limitations based on the stop flags.
     if(
@@ -464,20 +2239,24 @@ bool can_take_path_stop(
             !sector_ptr->hazard_floor ||
             !has_flag(settings.flags, PATH_FOLLOW_FLAG_AIRBORNE)
         );
-        
+    const vector<hazard*>* hazards =
+        sector_ptr ? &sector_ptr->hazards : nullptr;
+    if(snapshot && sector_ptr) {
+        auto h_it = snapshot->sector_hazards.find(sector_ptr);
+        hazards =
+            h_it == snapshot->sector_hazards.end() ? nullptr : &h_it->second;
+    }
+    
     if(
         !has_flag(settings.flags, PATH_FOLLOW_FLAG_IGNORE_OBSTACLES) &&
         touching_hazard &&
-        sector_ptr &&
-        !sector_ptr->hazards.empty()
+        hazards &&
+        !hazards->empty()
     ) {
-        for(size_t sh = 0; sh < sector_ptr->hazards.size(); sh++) {
+        for(size_t sh = 0; sh < hazards->size(); sh++) {
             bool invulnerable = false;
             for(size_t ih = 0; ih < settings.invulnerabilities.size(); ih++) {
-                if(
-                    settings.invulnerabilities[ih] ==
-                    sector_ptr->hazards[sh]
-                ) {
+                if(settings.invulnerabilities[ih] == (*hazards)[sh]) {
                     invulnerable = true;
                     break;
                 }
@@ -500,18 +2279,25 @@ bool can_take_path_stop(
  * @param link_ptr Link to check.
  * @param settings Settings about how the path should be followed.
  * @param out_reason If not nullptr, the reason is returned here.
+ * @param snapshot If not nullptr, obstacles and hazards are read from this
+ * snapshot of the area's paths instead.
  * @return Whether it can traverse it.
  */
 bool can_traverse_path_link(
     path_link* link_ptr, const path_follow_settings &settings,
-    PATH_BLOCK_REASON* out_reason
+    PATH_BLOCK_REASON* out_reason, const path_graph_snapshot* snapshot
 ) {
     if(out_reason) *out_reason = PATH_BLOCK_REASON_NONE;
     
     //Check if there's an obstacle in the way.
+    bool blocked =
+        snapshot ?
+        snapshot->blocked_links.find(link_ptr) !=
+        snapshot->blocked_links.end() :
+        link_ptr->blocked_by_obstacle;
     if(
         !has_flag(settings.flags, PATH_FOLLOW_FLAG_IGNORE_OBSTACLES) &&
-        link_ptr->blocked_by_obstacle
+        blocked
     ) {
         if(out_reason) *out_reason = PATH_BLOCK_REASON_OBSTACLE;
         return false;
@@ -557,7 +2343,11 @@ bool can_traverse_path_link(
     }
     
     //Check if there's any problem with the stop.
-    if(!can_take_path_stop(link_ptr->end_ptr, settings, end_sector, out_reason)) {
+    if(
+        !can_take_path_stop(
+            link_ptr->end_ptr, settings, end_sector, out_reason, snapshot
+        )
+    ) {
         return false;
     }
     
@@ -602,10 +2392,13 @@ void depth_first_search(
 
 /**
  * @brief Uses A* to get the shortest path between two nodes.
+ * The links' end stop indexes must be up to date.
+ * During gameplay, recent results are reused from the path manager's cache,
+ * and common end stops use the path manager's flow fields.
  *
  * @param out_path The stops to visit, in order, are returned here.
- * @param start_node Start node.
- * @param end_node End node.
+ * @param start_idx Index of the start node.
+ * @param end_idx Index of the end node.
  * @param settings Settings about how the path should be followed.
  * @param out_total_dist If not nullptr, the total path distance is
  * returned here.
@@ -613,130 +2406,199 @@ void depth_first_search(
  */
 PATH_RESULT a_star(
     vector<path_stop*> &out_path,
-    path_stop* start_node, path_stop* end_node,
+    size_t start_idx, size_t end_idx,
     const path_follow_settings &settings,
     float* out_total_dist
 ) {
-    //https://en.wikipedia.org/wiki/A*_search_algorithm
+    //Each thread gets its own workspace. Cache for performance.
+    static thread_local a_star_workspace workspace;
     
-    /**
-     * @brief Represents a node's data in the algorithm.
-     */
-    struct node_t {
-        //In the best known path to this node, this is the known
-        //distance from the start node to this one.
-        float since_start = FLT_MAX;
+    //If the area is loaded for gameplay, the path manager can help out,
+    //with its contracted graph and its cache of recent results.
+    path_manager* path_mgr =
+        game.states.gameplay &&
+        game.states.gameplay->path_mgr.contracted_graph.is_usable() ?
+        &game.states.gameplay->path_mgr :
+        nullptr;
         
-        //In the best known path to this node, this is the node that
-        //came before this one.
-        path_stop* prev = nullptr;
+    path_cache_key key(start_idx, end_idx, settings);
+    if(path_mgr) {
+        const path_cache_entry* entry = path_mgr->get_cached_path(key);
+        if(entry) {
+            out_path = entry->path;
+            if(out_total_dist) *out_total_dist = entry->total_dist;
+            return entry->result;
+        }
+    }
+    
+    //If lots of mobs go to this end stop, a flow field already knows the
+    //way from every stop. Otherwise, the contracted graph has far fewer
+    //stops to go through.
+    float total_dist = 0.0f;
+    bool found = false;
+    path_flow_field* flow_field =
+        path_mgr ? path_mgr->request_flow_field(key) : nullptr;
+    if(flow_field) {
+        found = flow_field->get_path(start_idx, out_path, &total_dist);
+    } else if(path_mgr) {
+        found =
+            path_mgr->contracted_graph.a_star(
+                workspace, out_path, start_idx, end_idx,
+                settings, &total_dist
+            );
+    } else {
+        found =
+            a_star_full_graph(
+                workspace, out_path, start_idx, end_idx,
+                settings, &total_dist
+            );
+    }
+    
+    PATH_RESULT result = PATH_RESULT_NORMAL_PATH;
+    if(!found) {
+        //If we got to this point, there means that there is
+        //no available path!
         
-        //Estimated distance if the final path takes this node.
-        float estimated = FLT_MAX;
-    };
+        if(!has_flag(settings.flags, PATH_FOLLOW_FLAG_IGNORE_OBSTACLES)) {
+            //Let's try again, this time ignoring obstacles.
+            path_follow_settings new_settings = settings;
+            enable_flag(new_settings.flags, PATH_FOLLOW_FLAG_IGNORE_OBSTACLES);
+            result =
+                a_star(
+                    out_path,
+                    start_idx, end_idx,
+                    new_settings,
+                    &total_dist
+                );
+            if(result == PATH_RESULT_NORMAL_PATH) {
+                //If we only managed to succeed with this ignore-obstacle
+                //attempt, then that means a path exists,
+                //but there are obstacles.
+                result = PATH_RESULT_PATH_WITH_OBSTACLES;
+            }
+        } else {
+            //Nothing that can be done. No path.
+            out_path.clear();
+            total_dist = 0.0f;
+            result = PATH_RESULT_END_STOP_UNREACHABLE;
+        }
+    }
+    
+    if(path_mgr) {
+        path_cache_entry entry;
+        entry.path = out_path;
+        entry.total_dist = total_dist;
+        entry.result = result;
+        path_mgr->add_cached_path(key, entry);
+    }
+    
+    if(out_total_dist) *out_total_dist = total_dist;
+    return result;
+}
+
+
+/**
+ * @brief Uses A* to get the shortest path between two nodes, going through
+ * every stop of the area's path graph.
+ * The links' end stop indexes must be up to date.
+ *
+ * @param workspace Workspace to use for the search.
+ * @param out_path The stops to visit, in order, are returned here.
+ * @param start_idx Index of the start node.
+ * @param end_idx Index of the end node.
+ * @param settings Settings about how the path should be followed.
+ * @param out_total_dist If not nullptr, the total path distance is
+ * returned here.
+ * @param snapshot If not nullptr, obstacles and hazards are read from this
+ * snapshot of the area's paths instead.
+ * @return Whether a path was found.
+ */
+bool a_star_full_graph(
+    a_star_workspace &workspace, vector<path_stop*> &out_path,
+    size_t start_idx, size_t end_idx,
+    const path_follow_settings &settings, float* out_total_dist,
+    const path_graph_snapshot* snapshot
+) {
+    //https://en.wikipedia.org/wiki/A*_search_algorithm
     
-    //All nodes that we want to visit.
-    unordered_set<path_stop*> to_visit;
-    //Data for all the nodes.
-    map<path_stop*, node_t> data;
+    const vector<path_stop*> &stops = game.cur_area_data->path_stops;
+    const point &end_pos = stops[end_idx]->pos;
     
+    //The landmarks give a better estimate than a straight line, if ready.
+    const path_landmarks* landmarks =
+        game.states.gameplay &&
+        game.states.gameplay->path_mgr.landmarks.is_usable() ?
+        &game.states.gameplay->path_mgr.landmarks :
+        nullptr;
+        
     //Part 1: Initialize the algorithm.
-    to_visit.insert(start_node);
-    data[start_node].since_start = 0.0f;
-    data[start_node].estimated = 0.0f;
+    workspace.start_search(stops.size());
+    a_star_workspace::stop_info &start_info = workspace.get_info(start_idx);
+    start_info.since_start = 0.0f;
+    start_info.estimated = 0.0f;
+    workspace.push_or_update(start_idx);
     
     //Start iterating.
-    while(!to_visit.empty()) {
+    while(!workspace.is_heap_empty()) {
     
         //Part 2: Figure out what node to work on in this iteration.
-        path_stop* cur_node = nullptr;
-        float cur_node_dist = 0.0f;
-        node_t cur_node_data;
-        
-        for(auto u = to_visit.begin(); u != to_visit.end(); u++) {
-            node_t n = data[*u];
-            float est_dist = n.estimated;
-            
-            if(!cur_node || est_dist < cur_node_dist) {
-                cur_node = *u;
-                cur_node_dist = est_dist;
-                cur_node_data = n;
-            }
-        }
+        size_t cur_idx = workspace.pop();
+        path_stop* cur_node = stops[cur_idx];
+        float cur_since_start = workspace.get_info(cur_idx).since_start;
         
         //Part 3: If the node we're processing is the end node, then
         //that's it, best path found!
-        if(cur_node == end_node) {
+        if(cur_idx == end_idx) {
         
             //Construct the path.
-            float td = data[end_node].since_start;
             out_path.clear();
-            out_path.push_back(end_node);
-            path_stop* next = data[end_node].prev;
-            while(next) {
-                out_path.insert(out_path.begin(), next);
-                next = data[next].prev;
+            size_t next_idx = end_idx;
+            while(next_idx != INVALID) {
+                out_path.push_back(stops[next_idx]);
+                next_idx = workspace.get_info(next_idx).prev_idx;
             }
+            std::reverse(out_path.begin(), out_path.end());
             
-            if(out_total_dist) *out_total_dist = td;
-            return PATH_RESULT_NORMAL_PATH;
+            if(out_total_dist) *out_total_dist = cur_since_start;
+            return true;
             
         }
         
-        //This node's been visited.
-        to_visit.erase(cur_node);
-        
         //Part 4: Check the neighbors.
         for(size_t l = 0; l < cur_node->links.size(); l++) {
             path_link* l_ptr = cur_node->links[l];
-            path_stop* neighbor = l_ptr->end_ptr;
+            size_t neighbor_idx = l_ptr->end_idx;
+            if(neighbor_idx >= stops.size()) continue;
             
             //Can this link be traversed?
-            if(!can_traverse_path_link(l_ptr, settings)) {
+            if(!can_traverse_path_link(l_ptr, settings, nullptr, snapshot)) {
                 continue;
             }
             
-            float tentative_score =
-                data[cur_node].since_start + l_ptr->distance;
+            float tentative_score = cur_since_start + l_ptr->distance;
+            a_star_workspace::stop_info &neighbor_info =
+                workspace.get_info(neighbor_idx);
                 
-            if(tentative_score < data[neighbor].since_start) {
+            if(tentative_score < neighbor_info.since_start) {
                 //Found a better path from the start to this neighbor.
-                data[neighbor].since_start = tentative_score;
-                data[neighbor].prev = cur_node;
-                data[neighbor].estimated =
-                    tentative_score +
-                    dist(neighbor->pos, end_node->pos).to_float();
-                to_visit.insert(neighbor);
+                neighbor_info.since_start = tentative_score;
+                neighbor_info.prev_idx = cur_idx;
+                float min_dist_left =
+                    dist(stops[neighbor_idx]->pos, end_pos).to_float();
+                if(landmarks) {
+                    min_dist_left =
+                        std::max(
+                            min_dist_left,
+                            landmarks->get_min_dist(neighbor_idx, end_idx)
+                        );
+                }
+                neighbor_info.estimated = tentative_score + min_dist_left;
+                workspace.push_or_update(neighbor_idx);
             }
         }
     }
     
-    //If we got to this point, there means that there is no available path!
-    
-    if(!has_flag(settings.flags, PATH_FOLLOW_FLAG_IGNORE_OBSTACLES)) {
-        //Let's try again, this time ignoring obstacles.
-        path_follow_settings new_settings = settings;
-        enable_flag(new_settings.flags, PATH_FOLLOW_FLAG_IGNORE_OBSTACLES);
-        PATH_RESULT new_result =
-            a_star(
-                out_path,
-                start_node, end_node,
-                new_settings,
-                out_total_dist
-            );
-        if(new_result == PATH_RESULT_NORMAL_PATH) {
-            //If we only managed to succeed with this ignore-obstacle attempt,
-            //then that means a path exists, but there are obstacles.
-            return PATH_RESULT_PATH_WITH_OBSTACLES;
-        } else {
-            return new_result;
-        }
-    }
-    
-    //Nothing that can be done. No path.
-    out_path.clear();
-    if(out_total_dist) *out_total_dist = 0;
-    return PATH_RESULT_END_STOP_UNREACHABLE;
+    return false;
 }
 
 
@@ -754,13 +2616,19 @@ PATH_RESULT a_star(
  * returned here.
  * @param out_end_stop If not nullptr, the closest stop to the end is
  * returned here.
+ * @param known_search If not nullptr, this is a path request that was
+ * made for this path a moment ago. If it has a result with the same end
+ * stop and settings, and the closest stop to the start is still on that
+ * result's path, the path from that stop onward is used instead of
+ * searching again.
  * @return The operation's result.
  */
 PATH_RESULT get_path(
     const point &start, const point &end,
     const path_follow_settings &settings,
     vector<path_stop*> &full_path, float* out_total_dist,
-    path_stop** out_start_stop, path_stop** out_end_stop
+    path_stop** out_start_stop, path_stop** out_end_stop,
+    const path_request* known_search
 ) {
 
     full_path.clear();
@@ -783,44 +2651,79 @@ PATH_RESULT get_path(
     //Start by finding the closest stops to the start and finish.
     path_stop* closest_to_start = nullptr;
     path_stop* closest_to_end = nullptr;
+    size_t closest_to_start_idx = INVALID;
+    size_t closest_to_end_idx = INVALID;
     float closest_to_start_dist = 0.0f;
     float closest_to_end_dist = 0.0f;
     
-    for(size_t s = 0; s < game.cur_area_data->path_stops.size(); s++) {
-        path_stop* s_ptr = game.cur_area_data->path_stops[s];
+    const path_stop_grid* stop_grid =
+        game.states.gameplay &&
+        game.states.gameplay->path_mgr.stop_grid.is_usable() ?
+        &game.states.gameplay->path_mgr.stop_grid :
+        nullptr;
+        
+    if(stop_grid) {
+        //The path manager's grid can find them without checking every stop.
+        auto filter = [&settings] (path_stop* s_ptr) -> bool {
+            return can_take_path_stop(s_ptr, settings);
+        };
+        closest_to_start_idx =
+            stop_grid->get_closest_stop(
+                start_to_use, filter, &closest_to_start_dist
+            );
+        closest_to_end_idx =
+            stop_grid->get_closest_stop(
+                end_to_use, filter, &closest_to_end_dist
+            );
+        if(closest_to_start_idx != INVALID) {
+            closest_to_start =
+                game.cur_area_data->path_stops[closest_to_start_idx];
+        }
+        if(closest_to_end_idx != INVALID) {
+            closest_to_end =
+                game.cur_area_data->path_stops[closest_to_end_idx];
+        }
         
-        float dist_to_start =
-            dist(start_to_use, s_ptr->pos).to_float() - s_ptr->radius;
-        float dist_to_end =
-            dist(end_to_use, s_ptr->pos).to_float() - s_ptr->radius;
-        dist_to_start = std::max(0.0f, dist_to_start);
-        dist_to_end = std::max(0.0f, dist_to_end);
-        
-        bool is_new_start =
-            !closest_to_start || dist_to_start < closest_to_start_dist;
-        bool is_new_end =
-            !closest_to_end || dist_to_end < closest_to_end_dist;
+    } else {
+        for(size_t s = 0; s < game.cur_area_data->path_stops.size(); s++) {
+            path_stop* s_ptr = game.cur_area_data->path_stops[s];
             
-        if(is_new_start || is_new_end) {
-            //We actually want this stop. Check now if it can be used.
-            //We're not checking this earlier due to performance.
-            if(!can_take_path_stop(s_ptr, settings)) {
-                //Can't be taken. Skip.
+            float dist_to_start =
+                dist(start_to_use, s_ptr->pos).to_float() - s_ptr->radius;
+            float dist_to_end =
+                dist(end_to_use, s_ptr->pos).to_float() - s_ptr->radius;
+            dist_to_start = std::max(0.0f, dist_to_start);
+            dist_to_end = std::max(0.0f, dist_to_end);
+            
+            bool is_new_start =
+                !closest_to_start || dist_to_start < closest_to_start_dist;
+            bool is_new_end =
+                !closest_to_end || dist_to_end < closest_to_end_dist;
+            
+            if(is_new_start || is_new_end) {
+                //We actually want this stop. Check now if it can be used.
+                //We're not checking this earlier due to performance.
+                if(!can_take_path_stop(s_ptr, settings)) {
+                    //Can't be taken. Skip.
+                    continue;
+                }
+            } else {
+                //Not the closest so far. Skip.
                 continue;
             }
-        } else {
-            //Not the closest so far. Skip.
-            continue;
+            
+            if(is_new_start) {
+                closest_to_start_dist = dist_to_start;
+                closest_to_start = s_ptr;
+                closest_to_start_idx = s;
+            }
+            if(is_new_end) {
+                closest_to_end_dist = dist_to_end;
+                closest_to_end = s_ptr;
+                closest_to_end_idx = s;
+            }
         }
         
-        if(is_new_start) {
-            closest_to_start_dist = dist_to_start;
-            closest_to_start = s_ptr;
-        }
-        if(is_new_end) {
-            closest_to_end_dist = dist_to_end;
-            closest_to_end = s_ptr;
-        }
     }
     
     if(out_start_stop) *out_start_stop = closest_to_start;
@@ -848,18 +2751,56 @@ PATH_RESULT get_path(
         return PATH_RESULT_PATH_WITH_SINGLE_STOP;
     }
     
-    //Potential optimization: instead of calculating with this graph, consult
-    //a different one where nodes that only have two links are removed.
-    //e.g. A -> B -> C becomes A -> C.
-    //This means traversing fewer nodes when figuring out the shortest path.
-    
-    //Calculate the path.
-    PATH_RESULT result =
-        a_star(
-            full_path,
-            closest_to_start, closest_to_end,
-            settings, out_total_dist
+    //Calculate the path, unless it was just calculated for this.
+    //The mob may have moved on since then, so that result can only be used
+    //if the stop it's closest to now is on that path, and only from there
+    //onward. Starting from an earlier stop would make it walk back.
+    PATH_RESULT result = PATH_RESULT_NOT_CALCULATED;
+    if(
+        known_search &&
+        known_search->entry.result != PATH_RESULT_NOT_CALCULATED &&
+        known_search->key.end_idx == closest_to_end_idx
+    ) {
+        const path_cache_entry &entry = known_search->entry;
+        path_cache_key key(
+            known_search->key.start_idx, closest_to_end_idx, settings
         );
+        size_t first_stop_idx = INVALID;
+        if(!(key < known_search->key) && !(known_search->key < key)) {
+            if(known_search->key.start_idx == closest_to_start_idx) {
+                first_stop_idx = 0;
+            } else {
+                for(size_t s = 0; s < entry.path.size(); s++) {
+                    if(entry.path[s] == closest_to_start) {
+                        first_stop_idx = s;
+                        break;
+                    }
+                }
+            }
+        }
+        if(first_stop_idx != INVALID) {
+            float skipped_dist = 0.0f;
+            for(size_t s = 0; s < first_stop_idx; s++) {
+                skipped_dist +=
+                    entry.path[s]->get_link(entry.path[s + 1])->distance;
+            }
+            full_path.assign(
+                entry.path.begin() + first_stop_idx, entry.path.end()
+            );
+            if(out_total_dist) {
+                *out_total_dist = entry.total_dist - skipped_dist;
+            }
+            result = entry.result;
+        }
+    }
+    if(result == PATH_RESULT_NOT_CALCULATED) {
+        result =
+            a_star(
+                full_path,
+                closest_to_start_idx, closest_to_end_idx,
+                settings, out_total_dist
+            );
+    }
         
     if(out_total_dist && !full_path.empty()) {
         *out_total_dist +=
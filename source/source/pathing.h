@@ -10,17 +10,26 @@
 
 #pragma once
 
+#include <cstdint>
+#include <deque>
+#include <float.h>
+#include <functional>
 #include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 #include "hazard.h"
 #include "utils/general_utils.h"
 #include "utils/geometry_utils.h"
+#include "utils/thread_utils.h"
 
+using std::deque;
 using std::map;
 using std::string;
+using std::unordered_map;
 using std::unordered_set;
 using std::vector;
 
@@ -30,6 +39,11 @@ struct sector;
 struct path_link;
 
 
+//For each path stop, the links that lead into it, along with the index
+//of the stop each link starts from.
+typedef vector<vector<std::pair<size_t, path_link*> > > incoming_path_links_t;
+
+
 //Types of path link.
 enum PATH_LINK_TYPE {
 
@@ -159,7 +173,13 @@ enum PATH_BLOCK_REASON {
 
 namespace PATHS {
 extern const float DEF_CHASE_TARGET_DISTANCE;
+extern const size_t FLOW_FIELD_MIN_REQUESTS;
+extern const size_t MAX_CACHED_PATHS;
+extern const size_t MAX_FLOW_FIELDS;
+extern const size_t MAX_REPLANS_PER_FRAME;
 extern const float MIN_STOP_RADIUS;
+extern const size_t NR_LANDMARKS;
+extern const float STOP_GRID_CELL_SIZE;
 }
 
 
@@ -285,6 +305,485 @@ struct path_link {
 };
 
 
+/**
+ * @brief Memory that the A* algorithm works with, indexed by path stop index.
+ *
+ * It's kept from one search to the next, so that searches don't need to
+ * allocate anything. Instead of clearing the data of every stop before
+ * a search, each search gets a new generation number, and the data of a
+ * stop only counts if it was written with the current generation.
+ */
+struct a_star_workspace {
+
+    public:
+    
+    //--- Misc. declarations ---
+    
+    /**
+     * @brief What the algorithm knows about a stop.
+     */
+    struct stop_info {
+    
+        public:
+        
+        //--- Members ---
+        
+        //Generation of the search that last wrote this info.
+        uint32_t generation = 0;
+        
+        //In the best known path to this stop, this is the known
+        //distance from the start stop to this one.
+        float since_start = FLT_MAX;
+        
+        //Estimated distance if the final path takes this stop.
+        float estimated = FLT_MAX;
+        
+        //In the best known path to this stop, this is the index of the stop
+        //that came before this one. INVALID if none.
+        size_t prev_idx = INVALID;
+        
+        //When searching a contracted graph, this is the index of the
+        //shortcut that led to this stop in the best known path.
+        //INVALID if none.
+        size_t prev_shortcut_idx = INVALID;
+        
+        //Position in the heap, or INVALID if it's not in the heap.
+        size_t heap_pos = INVALID;
+        
+    };
+    
+    
+    //--- Function declarations ---
+    
+    void start_search(size_t nr_stops);
+    stop_info &get_info(size_t stop_idx);
+    bool is_heap_empty() const;
+    void push_or_update(size_t stop_idx);
+    size_t pop();
+    
+    private:
+    
+    //--- Members ---
+    
+    //Generation number of the current search.
+    uint32_t generation = 0;
+    
+    //Info about each stop.
+    vector<stop_info> infos;
+    
+    //Indexes of the stops to visit, as a binary heap, ordered by
+    //their estimated distance, lowest first.
+    vector<size_t> heap;
+    
+    
+    //--- Function declarations ---
+    
+    void sift_down(size_t pos);
+    void sift_up(size_t pos);
+    void swap_heap_items(size_t pos1, size_t pos2);
+    
+};
+
+
+/**
+ * @brief A series of path links that goes from one junction stop to
+ * another, passing only through stops that have nowhere else to go.
+ * Like a corridor.
+ */
+struct path_shortcut {
+
+    //--- Members ---
+    
+    //Index of the stop at the start.
+    size_t start_idx = INVALID;
+    
+    //Index of the stop at the end.
+    size_t end_idx = INVALID;
+    
+    //Links to traverse, in order.
+    vector<path_link*> links;
+    
+    //Index of every stop in the shortcut, in order, including the
+    //start and end stops.
+    vector<size_t> stop_idxs;
+    
+    //For every stop in the shortcut, the distance from the start to it.
+    vector<float> dists;
+    
+    //Does any of its links or stops have some restriction that means
+    //the links need to be checked one by one?
+    bool needs_full_check = false;
+    
+    //How many of its links are blocked by obstacles.
+    size_t nr_blocked_links = 0;
+    
+};
+
+
+/**
+ * @brief A version of the area's path graph where stops that only lead
+ * from one stop to the next, like the ones in a corridor, are skipped over.
+ * Only the junction stops remain, connected by shortcuts. This means
+ * path-finding has far fewer stops to go through.
+ *
+ * A stop is skipped over if it has two-way links with exactly two
+ * other stops, and no other links.
+ */
+struct contracted_path_graph {
+
+    public:
+    
+    //--- Misc. declarations ---
+    
+    /**
+     * @brief Where a skipped stop is, in the two shortcuts that go
+     * through it, one per direction.
+     */
+    struct stop_place {
+    
+        public:
+        
+        //--- Members ---
+        
+        //Index of each shortcut.
+        size_t shortcut_idxs[2] = {INVALID, INVALID};
+        
+        //Position of the stop in each shortcut's list of stops.
+        size_t positions[2] = {0, 0};
+        
+    };
+    
+    
+    //--- Function declarations ---
+    
+    bool a_star(
+        a_star_workspace &workspace, vector<path_stop*> &out_path,
+        size_t start_idx, size_t end_idx,
+        const path_follow_settings &settings, float* out_total_dist
+    ) const;
+    void build();
+    void clear();
+    bool is_usable() const;
+    void refresh_link(const path_link* link_ptr);
+    void refresh_sector(const sector* sector_ptr);
+    
+    private:
+    
+    //--- Members ---
+    
+    //Was it built?
+    bool built = false;
+    
+    //Number of stops in the area when it was built.
+    size_t nr_stops = 0;
+    
+    //For every stop, whether it's a junction, i.e. not skipped over.
+    vector<bool> is_junction;
+    
+    //For every junction stop, the shortcuts that start on it.
+    vector<vector<size_t> > junction_shortcuts;
+    
+    //For every skipped stop, where it is in the shortcuts.
+    vector<stop_place> stop_places;
+    
+    //All shortcuts.
+    vector<path_shortcut> shortcuts;
+    
+    //Index of the shortcut that each link belongs to.
+    unordered_map<const path_link*, size_t> link_shortcut_idxs;
+    
+    
+    //--- Function declarations ---
+    
+    void add_shortcut(size_t start_idx, path_link* first_link_ptr);
+    bool can_traverse_shortcut(
+        const path_shortcut &shortcut, size_t from_pos, size_t to_pos,
+        const path_follow_settings &settings
+    ) const;
+    size_t get_stop_pos(size_t stop_idx, size_t shortcut_idx) const;
+    void refresh_shortcut(size_t shortcut_idx);
+    
+};
+
+
+/**
+ * @brief Everything that identifies a path search, for the purposes
+ * of caching its result. Only the settings that can change which stops
+ * and links are allowed are kept.
+ */
+struct path_cache_key {
+
+    //--- Members ---
+    
+    //Index of the start stop.
+    size_t start_idx = INVALID;
+    
+    //Index of the end stop.
+    size_t end_idx = INVALID;
+    
+    //Path follow flags that affect which stops and links can be taken.
+    bitmask_8_t flags = 0;
+    
+    //Hazards the mob is invulnerable to, sorted.
+    vector<hazard*> invulnerabilities;
+    
+    //Label the stops must have, if any.
+    string label;
+    
+    
+    //--- Function declarations ---
+    
+    path_cache_key(
+        size_t start_idx, size_t end_idx,
+        const path_follow_settings &settings
+    );
+    bool operator<(const path_cache_key &k2) const;
+    
+};
+
+
+/**
+ * @brief The result of a path search, kept in the path cache.
+ */
+struct path_cache_entry {
+
+    //--- Members ---
+    
+    //The stops to visit, in order.
+    vector<path_stop*> path;
+    
+    //Total distance of the path.
+    float total_dist = 0.0f;
+    
+    //Result of the search.
+    PATH_RESULT result = PATH_RESULT_NOT_CALCULATED;
+    
+};
+
+
+/**
+ * @brief A copy of everything about the area's paths that can change
+ * during gameplay. Path searches on other threads read from here instead,
+ * since the real data can change while they run.
+ */
+struct path_graph_snapshot {
+
+    //--- Members ---
+    
+    //Links that were blocked by obstacles.
+    unordered_set<const path_link*> blocked_links;
+    
+    //Hazards of every sector that had any.
+    unordered_map<const sector*, vector<hazard*> > sector_hazards;
+    
+    
+    //--- Function declarations ---
+    
+    void take(const map<path_link*, unordered_set<mob*> > &obstructions);
+    
+};
+
+
+/**
+ * @brief A few path stops spread around the area, along with the shortest
+ * distances between each of them and every other stop. Thanks to the
+ * triangle inequality, these give A* a minimum distance between any two
+ * stops that's a lot closer to the real one than a straight line is,
+ * like when there are walls or ledges in the way.
+ *
+ * The distances ignore obstacles, hazards, and any other restriction.
+ * Restrictions only ever make paths longer, so the minimum still holds.
+ */
+struct path_landmarks {
+
+    //--- Function declarations ---
+    
+    void build(const incoming_path_links_t &incoming_links);
+    void clear();
+    float get_min_dist(size_t stop_idx, size_t end_idx) const;
+    bool is_usable() const;
+    
+    private:
+    
+    //--- Members ---
+    
+    //Whether they've been built for the current area.
+    bool built = false;
+    
+    //Number of stops in the area, when they were built.
+    size_t nr_stops = 0;
+    
+    //Indexes of the landmark stops.
+    vector<size_t> landmark_idxs;
+    
+    //Shortest distance from each landmark to each stop. Each stop has
+    //one distance per landmark, one stop after the other.
+    //FLT_MAX if unreachable.
+    vector<float> dists_from;
+    
+    //Shortest distance from each stop to each landmark. Same layout.
+    vector<float> dists_to;
+    
+    
+    //--- Function declarations ---
+    
+    void calculate_dists(
+        a_star_workspace &workspace, size_t landmark_nr, bool to_landmark,
+        const incoming_path_links_t &incoming_links
+    );
+    
+};
+
+
+/**
+ * @brief A request for a path, to be calculated in the background.
+ */
+struct path_request {
+
+    //--- Members ---
+    
+    //Mob that wants the path. nullptr if it got deleted in the meantime.
+    mob* m = nullptr;
+    
+    //Key with the start stop, end stop, and settings.
+    path_cache_key key;
+    
+    //Settings about how the path should be followed.
+    path_follow_settings settings;
+    
+    //Whether a search is needed. If not, the result was either in the
+    //path cache already, or the path is easy to get right away.
+    bool needs_search = false;
+    
+    //Version of the area's paths that the search is for.
+    size_t graph_version = 0;
+    
+    //State of the area's paths when the request was made.
+    std::shared_ptr<const path_graph_snapshot> snapshot;
+    
+    //Result of the search, or of the cache. Its result is
+    //PATH_RESULT_NOT_CALCULATED if the path is easy to get right away.
+    path_cache_entry entry;
+    
+    
+    //--- Function declarations ---
+    
+    path_request(mob* m, const path_cache_key &key);
+    void run();
+    
+};
+
+
+/**
+ * @brief For a given end stop and settings, this holds the shortest
+ * distance from every stop to the end stop, and what stop to go to next.
+ * When lots of mobs go to the same place, like Pikmin carrying things to
+ * an Onion, they can get their paths from here without searching.
+ */
+struct path_flow_field {
+
+    //--- Members ---
+    
+    //Key with the end stop and settings. The start stop is not used.
+    path_cache_key key;
+    
+    //Settings to check stops and links with.
+    path_follow_settings settings;
+    
+    //Distance from each stop to the end stop. FLT_MAX if unreachable.
+    vector<float> dists;
+    
+    //Index of the stop to go to next, from each stop. INVALID if none.
+    vector<size_t> next_idxs;
+    
+    //Number of the last path search that used it.
+    size_t last_use_nr = 0;
+    
+    
+    //--- Function declarations ---
+    
+    explicit path_flow_field(const path_cache_key &key);
+    void build(
+        a_star_workspace &workspace,
+        const incoming_path_links_t &incoming_links
+    );
+    bool get_path(
+        size_t start_idx, vector<path_stop*> &out_path,
+        float* out_total_dist
+    ) const;
+    void refresh_links(
+        a_star_workspace &workspace, const vector<path_link*> &links,
+        const incoming_path_links_t &incoming_links
+    );
+    
+    private:
+    
+    //--- Function declarations ---
+    
+    void propagate(
+        a_star_workspace &workspace,
+        const incoming_path_links_t &incoming_links
+    );
+    void reset_subtree(size_t stop_idx, vector<size_t> &out_reset_idxs);
+    
+};
+
+
+/**
+ * @brief Divides the area into a grid of cells, each one with the list of
+ * path stops whose center is inside it. This makes it fast to find
+ * the stop closest to a point, without checking every stop in the area.
+ */
+struct path_stop_grid {
+
+    //--- Function declarations ---
+    
+    void build();
+    void clear();
+    size_t get_closest_stop(
+        const point &p, const std::function<bool(path_stop*)> &filter,
+        float* out_dist
+    ) const;
+    bool is_usable() const;
+    
+    private:
+    
+    //--- Members ---
+    
+    //Whether it's been built for the current area.
+    bool built = false;
+    
+    //Number of stops in the area, when it was built.
+    size_t nr_stops = 0;
+    
+    //Top-left corner of the grid.
+    point top_left_corner;
+    
+    //Number of columns.
+    size_t n_cols = 0;
+    
+    //Number of rows.
+    size_t n_rows = 0;
+    
+    //Largest radius out of all stops.
+    float max_stop_radius = 0.0f;
+    
+    //For each cell, index in cell_stop_idxs where its stops start.
+    //Its stops end where the next cell's start. There is one extra
+    //item at the end, for the last cell.
+    vector<size_t> cell_starts;
+    
+    //Indexes of the stops in each cell, one cell after the other.
+    vector<size_t> cell_stop_idxs;
+    
+    
+    //--- Function declarations ---
+    
+    size_t get_cell_coord(float coord, float top_left_coord, size_t n) const;
+    
+};
+
+
 /**
  * @brief Manages the paths in the area.
  *
@@ -293,9 +792,11 @@ struct path_link {
  * mobs. When these problems disappear, the manager is in charge of alerting
  * all mobs that were following paths, in order to get them recalculate
  * their paths if needed.
- * The reason we want them to recalculate regardless of whether the
- * obstacle affected them or not, is because this obstacle could've freed
- * a different route.
+ * Only mobs whose path is affected are told to recalculate, and
+ * they don't all do it in the same frame. They are queued up instead,
+ * and the queue is worked on a bit every frame. The searches run on a
+ * background thread, and on the next frame, each mob is handed its
+ * result and told to recalculate with it.
  */
 struct path_manager {
 
@@ -307,13 +808,77 @@ struct path_manager {
     //Stops known to have hazards.
     unordered_set<path_stop*> hazardous_stops;
     
+    //Contracted version of the area's path graph.
+    contracted_path_graph contracted_graph;
+    
+    //Results of recent path searches. Many mobs often need the same path,
+    //like a group of Pikmin carrying things to the same Onion.
+    map<path_cache_key, path_cache_entry> cached_paths;
+    
+    //Grid with the area's path stops, to quickly find the closest ones.
+    path_stop_grid stop_grid;
+    
+    //Mobs that need to recalculate their paths, in order.
+    deque<mob*> replan_queue;
+    
+    //Mobs in the replan queue, to avoid adding them twice.
+    unordered_set<mob*> queued_replans;
+    
+    //Flow fields for the most common destinations.
+    vector<path_flow_field> flow_fields;
+    
+    //How many path searches each end stop and settings combination had.
+    map<path_cache_key, size_t> flow_field_requests;
+    
+    //Number of path searches that used a flow field so far.
+    size_t flow_field_use_nr = 0;
+    
+    //Links that lead into each stop.
+    incoming_path_links_t incoming_links;
+    
+    //Workspace for building and updating flow fields.
+    a_star_workspace flow_field_workspace;
+    
+    //Version of the area's paths. It goes up whenever links get blocked
+    //or unblocked, or hazards change.
+    size_t graph_version = 0;
+    
+    //Latest snapshot of the area's paths, for path requests.
+    std::shared_ptr<const path_graph_snapshot> graph_snapshot;
+    
+    //Version of the area's paths that the latest snapshot is from.
+    size_t graph_snapshot_version = 0;
+    
+    //Path requests made on the last frame. Kept in a deque so the
+    //background thread's pointers to them stay valid as more get added.
+    deque<path_request> path_requests;
+    
+    //Background thread that runs the path requests' searches.
+    background_worker path_worker;
+    
+    //Landmarks, for better A* estimates.
+    path_landmarks landmarks;
+    
     
     //--- Function declarations ---
     
+    void add_cached_path(
+        const path_cache_key &key, const path_cache_entry &entry
+    );
+    const path_cache_entry* get_cached_path(const path_cache_key &key) const;
     void handle_area_load();
+    void handle_mob_deletion(const mob* m);
     void handle_obstacle_add(mob* m);
     void handle_obstacle_remove(mob* m);
     void handle_sector_hazard_change(sector* sector_ptr);
+    void process_replan_queue();
+    void queue_link_replans(
+        const vector<path_link*> &links, bool links_freed
+    );
+    void queue_replan(mob* m);
+    void request_path(mob* m);
+    void refresh_flow_fields(const vector<path_link*> &links);
+    path_flow_field* request_flow_field(const path_cache_key &key);
     void clear();
     
 };
@@ -325,11 +890,13 @@ bool can_take_path_stop(
 );
 bool can_take_path_stop(
     const path_stop* stop_ptr, const path_follow_settings &settings,
-    sector* sector_ptr, PATH_BLOCK_REASON* out_reason = nullptr
+    sector* sector_ptr, PATH_BLOCK_REASON* out_reason = nullptr,
+    const path_graph_snapshot* snapshot = nullptr
 );
 bool can_traverse_path_link(
     path_link* link_ptr, const path_follow_settings &settings,
-    PATH_BLOCK_REASON* out_reason = nullptr
+    PATH_BLOCK_REASON* out_reason = nullptr,
+    const path_graph_snapshot* snapshot = nullptr
 );
 void depth_first_search(
     vector<path_stop*> &nodes,
@@ -337,15 +904,22 @@ void depth_first_search(
 );
 PATH_RESULT a_star(
     vector<path_stop*> &out_path,
-    path_stop* start_node, path_stop* end_node,
+    size_t start_idx, size_t end_idx,
     const path_follow_settings &settings,
     float* out_total_dist
 );
+bool a_star_full_graph(
+    a_star_workspace &workspace, vector<path_stop*> &out_path,
+    size_t start_idx, size_t end_idx,
+    const path_follow_settings &settings, float* out_total_dist,
+    const path_graph_snapshot* snapshot = nullptr
+);
 PATH_RESULT get_path(
     const point &start, const point &end,
     const path_follow_settings &settings,
     vector<path_stop*> &full_path, float* out_total_dist,
-    path_stop** out_start_stop, path_stop** out_end_stop
+    path_stop** out_start_stop, path_stop** out_end_stop,
+    const path_request* known_search = nullptr
 );
 string path_block_reason_to_string(PATH_BLOCK_REASON reason);
 string path_result_to_string(PATH_RESULT result);
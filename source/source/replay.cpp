@@ -5,10 +5,11 @@
  * Pikmin is copyright (c) Nintendo.
  *
  * === FILE DESCRIPTION ===
- * Particle class and particle-related functions.
+ * Replay classes and related functions.
  */
 
 #include <algorithm>
+#include <cstring>
 
 #include "replay.h"
 
@@ -18,6 +19,361 @@ using std::string;
 using std::vector;
 
 
+namespace INPUT_REPLAY {
+
+//Version of the input replay file format.
+const int32_t FILE_VERSION = 2;
+
+}
+
+
+/**
+ * @brief Clears all data about this input replay.
+ */
+void input_replay::clear() {
+    mode = INPUT_REPLAY_MODE_NONE;
+    area_path.clear();
+    rng_seed = 0;
+    win_w = 0;
+    win_h = 0;
+    frames.clear();
+    pending_menu_mouse_events.clear();
+    restart_playback();
+}
+
+
+/**
+ * @brief Finishes the current frame. When recording, this saves the
+ * world hash. When playing, this checks it against the recorded one.
+ *
+ * @param world_hash Hash of the state of the world at the end of the frame.
+ */
+void input_replay::finish_frame(uint32_t world_hash) {
+    switch(mode) {
+    case INPUT_REPLAY_MODE_RECORDING: {
+        if(!frames.empty()) frames.back().world_hash = world_hash;
+        break;
+    } case INPUT_REPLAY_MODE_PLAYING: {
+        if(cur_frame_idx >= frames.size()) break;
+        if(frames[cur_frame_idx].world_hash != world_hash) {
+            if(nr_desyncs == 0) first_desync_frame_idx = cur_frame_idx;
+            nr_desyncs++;
+        }
+        cur_frame_idx++;
+        break;
+    } case INPUT_REPLAY_MODE_NONE: {
+        break;
+    }
+    }
+}
+
+
+/**
+ * @brief Returns whether every frame has been played back.
+ *
+ * @return Whether playback is over.
+ */
+bool input_replay::is_playback_over() const {
+    return
+        mode == INPUT_REPLAY_MODE_PLAYING &&
+        cur_frame_idx >= frames.size();
+}
+
+
+/**
+ * @brief Loads an input replay from a file in the disk,
+ * and gets it ready for playback.
+ *
+ * @param file_path Path to the file to load from.
+ * @return Whether it succeeded.
+ */
+bool input_replay::load_from_file(const string &file_path) {
+    clear();
+    ALLEGRO_FILE* file = al_fopen(file_path.c_str(), "rb");
+    if(!file) return false;
+    
+    //Smallest number of bytes each thing takes up in the file.
+    const uint64_t min_frame_size = 4 * 8;
+    const uint64_t action_size = 4 * 2;
+    const uint64_t mouse_event_size = 4 * 8;
+    
+    //The sizes of the lists come from the file, so check them against
+    //how many bytes are actually left before allocating anything.
+    int64_t file_size = al_fsize(file);
+    auto fits = [file, file_size] (uint64_t n_items, uint64_t item_size) {
+        int64_t bytes_left = file_size - al_ftell(file);
+        if(file_size < 0 || bytes_left < 0) return false;
+        return n_items <= (uint64_t) bytes_left / item_size;
+    };
+    
+    if(al_fread32be(file) != INPUT_REPLAY::FILE_VERSION) {
+        al_fclose(file);
+        return false;
+    }
+    
+    bool success = true;
+    uint32_t area_path_size = (uint32_t) al_fread32be(file);
+    if(!fits(area_path_size, 1)) {
+        success = false;
+    } else if(area_path_size > 0) {
+        area_path.resize(area_path_size);
+        al_fread(file, &area_path[0], area_path_size);
+    }
+    rng_seed = (unsigned int) al_fread32be(file);
+    win_w = (unsigned int) al_fread32be(file);
+    win_h = (unsigned int) al_fread32be(file);
+    
+    uint32_t n_frames = (uint32_t) al_fread32be(file);
+    if(!success || !fits(n_frames, min_frame_size)) {
+        success = false;
+        n_frames = 0;
+    }
+    frames.reserve(n_frames);
+    for(size_t f = 0; f < n_frames && success && !al_feof(file); f++) {
+        input_replay_frame frame;
+        frame.delta_t = read_replay_float(file);
+        frame.mouse_s_pos.x = read_replay_float(file);
+        frame.mouse_s_pos.y = read_replay_float(file);
+        frame.mouse_w_pos.x = read_replay_float(file);
+        frame.mouse_w_pos.y = read_replay_float(file);
+        
+        uint32_t n_actions = (uint32_t) al_fread32be(file);
+        if(!fits(n_actions, action_size)) {
+            success = false;
+            break;
+        }
+        frame.actions.reserve(n_actions);
+        for(size_t a = 0; a < n_actions; a++) {
+            player_action action;
+            action.action_type_id = al_fread32be(file);
+            action.value = read_replay_float(file);
+            frame.actions.push_back(action);
+        }
+        
+        uint32_t n_mouse_events = (uint32_t) al_fread32be(file);
+        if(!fits(n_mouse_events, mouse_event_size)) {
+            success = false;
+            break;
+        }
+        frame.menu_mouse_events.reserve(n_mouse_events);
+        for(size_t e = 0; e < n_mouse_events; e++) {
+            input_replay_mouse_event ev;
+            ev.type = al_fread32be(file);
+            ev.x = al_fread32be(file);
+            ev.y = al_fread32be(file);
+            ev.z = al_fread32be(file);
+            ev.dx = al_fread32be(file);
+            ev.dy = al_fread32be(file);
+            ev.dz = al_fread32be(file);
+            ev.button = al_fread32be(file);
+            frame.menu_mouse_events.push_back(ev);
+        }
+        
+        frame.world_hash = (uint32_t) al_fread32be(file);
+        frames.push_back(frame);
+    }
+    
+    success =
+        success && !al_ferror(file) && frames.size() == n_frames;
+    al_fclose(file);
+    
+    if(!success) {
+        clear();
+        return false;
+    }
+    mode = INPUT_REPLAY_MODE_PLAYING;
+    return true;
+}
+
+
+/**
+ * @brief Processes the inputs of a new frame. When recording, they get saved.
+ * When playing, they get replaced by the recorded ones. Once playback is over,
+ * the frames have no inputs.
+ *
+ * @param delta_t Time step of the frame.
+ * When recording, it is rounded to what the replay can save.
+ * @param mouse_s_pos Screen coordinates of the mouse cursor.
+ * @param mouse_w_pos World coordinates of the mouse cursor.
+ * @param actions Player actions of the frame.
+ * @param menu_mouse_events When playing, the mouse events the menus got
+ * before this frame are returned here, so they can be handled again.
+ * When recording, the ones passed to record_menu_mouse_event()
+ * are used instead, and this is left empty.
+ */
+void input_replay::process_frame(
+    double* delta_t, point* mouse_s_pos, point* mouse_w_pos,
+    vector<player_action>* actions,
+    vector<ALLEGRO_EVENT>* menu_mouse_events
+) {
+    menu_mouse_events->clear();
+    
+    switch(mode) {
+    case INPUT_REPLAY_MODE_RECORDING: {
+        //Playback has to use the exact same time step,
+        //so use the one that will get saved.
+        *delta_t = (float) *delta_t;
+        
+        input_replay_frame frame;
+        frame.delta_t = (float) *delta_t;
+        frame.mouse_s_pos = *mouse_s_pos;
+        frame.mouse_w_pos = *mouse_w_pos;
+        frame.actions = *actions;
+        frame.menu_mouse_events.swap(pending_menu_mouse_events);
+        frames.push_back(frame);
+        break;
+        
+    } case INPUT_REPLAY_MODE_PLAYING: {
+        if(cur_frame_idx >= frames.size()) {
+            actions->clear();
+            break;
+        }
+        const input_replay_frame &frame = frames[cur_frame_idx];
+        *delta_t = frame.delta_t;
+        *mouse_s_pos = frame.mouse_s_pos;
+        *mouse_w_pos = frame.mouse_w_pos;
+        *actions = frame.actions;
+        for(size_t e = 0; e < frame.menu_mouse_events.size(); e++) {
+            const input_replay_mouse_event &rec_ev =
+                frame.menu_mouse_events[e];
+            ALLEGRO_EVENT ev;
+            memset(&ev, 0, sizeof(ev));
+            ev.type = (ALLEGRO_EVENT_TYPE) rec_ev.type;
+            ev.mouse.x = rec_ev.x;
+            ev.mouse.y = rec_ev.y;
+            ev.mouse.z = rec_ev.z;
+            ev.mouse.dx = rec_ev.dx;
+            ev.mouse.dy = rec_ev.dy;
+            ev.mouse.dz = rec_ev.dz;
+            ev.mouse.button = (unsigned int) rec_ev.button;
+            menu_mouse_events->push_back(ev);
+        }
+        break;
+        
+    } case INPUT_REPLAY_MODE_NONE: {
+        break;
+        
+    }
+    }
+}
+
+
+/**
+ * @brief Records a mouse event that a menu got, if recording.
+ * It gets saved along with the next frame.
+ *
+ * @param ev Event to record. Events that aren't mouse movements or
+ * button presses are ignored.
+ */
+void input_replay::record_menu_mouse_event(const ALLEGRO_EVENT &ev) {
+    if(mode != INPUT_REPLAY_MODE_RECORDING) return;
+    if(
+        ev.type != ALLEGRO_EVENT_MOUSE_AXES &&
+        ev.type != ALLEGRO_EVENT_MOUSE_BUTTON_DOWN &&
+        ev.type != ALLEGRO_EVENT_MOUSE_BUTTON_UP
+    ) {
+        return;
+    }
+    
+    input_replay_mouse_event rec_ev;
+    rec_ev.type = (int32_t) ev.type;
+    rec_ev.x = ev.mouse.x;
+    rec_ev.y = ev.mouse.y;
+    rec_ev.z = ev.mouse.z;
+    rec_ev.dx = ev.mouse.dx;
+    rec_ev.dy = ev.mouse.dy;
+    rec_ev.dz = ev.mouse.dz;
+    rec_ev.button = (int32_t) ev.mouse.button;
+    pending_menu_mouse_events.push_back(rec_ev);
+}
+
+
+/**
+ * @brief Goes back to the first frame of playback, and forgets about
+ * any desyncs found so far.
+ */
+void input_replay::restart_playback() {
+    cur_frame_idx = 0;
+    nr_desyncs = 0;
+    first_desync_frame_idx = INVALID;
+}
+
+
+/**
+ * @brief Saves the input replay to a file in the disk.
+ *
+ * @param file_path Path to the file to save to.
+ * @return Whether it succeeded.
+ */
+bool input_replay::save_to_file(const string &file_path) const {
+    ALLEGRO_FILE* file = al_fopen(file_path.c_str(), "wb");
+    if(!file) return false;
+    
+    al_fwrite32be(file, INPUT_REPLAY::FILE_VERSION);
+    al_fwrite32be(file, (int32_t) area_path.size());
+    al_fwrite(file, area_path.c_str(), area_path.size());
+    al_fwrite32be(file, (int32_t) rng_seed);
+    al_fwrite32be(file, (int32_t) win_w);
+    al_fwrite32be(file, (int32_t) win_h);
+    
+    al_fwrite32be(file, (int32_t) frames.size());
+    for(size_t f = 0; f < frames.size(); f++) {
+        const input_replay_frame &frame = frames[f];
+        write_replay_float(file, frame.delta_t);
+        write_replay_float(file, frame.mouse_s_pos.x);
+        write_replay_float(file, frame.mouse_s_pos.y);
+        write_replay_float(file, frame.mouse_w_pos.x);
+        write_replay_float(file, frame.mouse_w_pos.y);
+        
+        al_fwrite32be(file, (int32_t) frame.actions.size());
+        for(size_t a = 0; a < frame.actions.size(); a++) {
+            al_fwrite32be(file, frame.actions[a].action_type_id);
+            write_replay_float(file, frame.actions[a].value);
+        }
+        
+        al_fwrite32be(file, (int32_t) frame.menu_mouse_events.size());
+        for(size_t e = 0; e < frame.menu_mouse_events.size(); e++) {
+            const input_replay_mouse_event &ev = frame.menu_mouse_events[e];
+            al_fwrite32be(file, ev.type);
+            al_fwrite32be(file, ev.x);
+            al_fwrite32be(file, ev.y);
+            al_fwrite32be(file, ev.z);
+            al_fwrite32be(file, ev.dx);
+            al_fwrite32be(file, ev.dy);
+            al_fwrite32be(file, ev.dz);
+            al_fwrite32be(file, ev.button);
+        }
+        
+        al_fwrite32be(file, (int32_t) frame.world_hash);
+    }
+    
+    bool success = !al_ferror(file);
+    al_fclose(file);
+    return success;
+}
+
+
+/**
+ * @brief Clears the input replay and starts recording a new one.
+ *
+ * @param area_path Path to the area being played.
+ * @param rng_seed Seed the random number generator is starting with.
+ * @param win_w Current window width.
+ * @param win_h Current window height.
+ */
+void input_replay::start_recording(
+    const string &area_path, unsigned int rng_seed,
+    unsigned int win_w, unsigned int win_h
+) {
+    clear();
+    mode = INPUT_REPLAY_MODE_RECORDING;
+    this->area_path = area_path;
+    this->rng_seed = rng_seed;
+    this->win_w = win_w;
+    this->win_h = win_h;
+}
+
+
 /**
  * @brief Construct a new replay object.
  */
@@ -271,3 +627,31 @@ replay_event::replay_event(
     data(data) {
     
 }
+
+
+/**
+ * @brief Reads a float from a file, written with write_replay_float().
+ *
+ * @param file File to read from.
+ * @return The float.
+ */
+float read_replay_float(ALLEGRO_FILE* file) {
+    int32_t bits = al_fread32be(file);
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+
+/**
+ * @brief Writes a float to a file, bit by bit, so that reading it back
+ * gives the exact same number.
+ *
+ * @param file File to write to.
+ * @param f Float to write.
+ */
+void write_replay_float(ALLEGRO_FILE* file, float f) {
+    int32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    al_fwrite32be(file, bits);
+}
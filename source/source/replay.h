@@ -5,15 +5,17 @@
  * Pikmin is copyright (c) Nintendo.
  *
  * === FILE DESCRIPTION ===
- * Header for the particle class and particle-related functions.
+ * Header for the replay classes and related functions.
  */
 
 #pragma once
 
+#include <cstdint>
 #include <vector>
 
 #include <allegro5/allegro.h>
 
+#include "libs/controls_manager.h"
 #include "mobs/enemy.h"
 #include "mobs/leader.h"
 #include "mobs/mob.h"
@@ -29,6 +31,26 @@ using std::string;
 using std::vector;
 
 
+namespace INPUT_REPLAY {
+extern const int32_t FILE_VERSION;
+}
+
+
+//Modes an input replay can be in.
+enum INPUT_REPLAY_MODE {
+
+    //Not recording nor playing.
+    INPUT_REPLAY_MODE_NONE,
+    
+    //Recording the player's inputs.
+    INPUT_REPLAY_MODE_RECORDING,
+    
+    //Playing back recorded inputs, instead of the player's.
+    INPUT_REPLAY_MODE_PLAYING,
+    
+};
+
+
 //Types of elements in a replay.
 enum REPLAY_ELEMENT {
 
@@ -68,6 +90,140 @@ enum REPLAY_EVENT {
 };
 
 
+/**
+ * @brief A mouse event that a menu got during an input replay's recording.
+ * Menus like the Onion menu read the mouse directly instead of going
+ * through player actions, so their events are recorded separately.
+ */
+struct input_replay_mouse_event {
+
+    //--- Members ---
+    
+    //Allegro event type.
+    int32_t type = 0;
+    
+    //Mouse X, in screen coordinates.
+    int32_t x = 0;
+    
+    //Mouse Y, in screen coordinates.
+    int32_t y = 0;
+    
+    //Mouse wheel position.
+    int32_t z = 0;
+    
+    //Change in mouse X.
+    int32_t dx = 0;
+    
+    //Change in mouse Y.
+    int32_t dy = 0;
+    
+    //Change in mouse wheel position.
+    int32_t dz = 0;
+    
+    //Mouse button, if any.
+    int32_t button = 0;
+    
+};
+
+
+/**
+ * @brief Everything that went into one frame of gameplay logic,
+ * in an input replay.
+ */
+struct input_replay_frame {
+
+    //--- Members ---
+    
+    //Time step of the frame.
+    float delta_t = 0.0f;
+    
+    //Screen coordinates of the mouse cursor.
+    point mouse_s_pos;
+    
+    //World coordinates of the mouse cursor.
+    point mouse_w_pos;
+    
+    //Player actions that happened.
+    vector<player_action> actions;
+    
+    //Mouse events that menus got before the frame.
+    vector<input_replay_mouse_event> menu_mouse_events;
+    
+    //Hash of the state of the world at the end of the frame.
+    uint32_t world_hash = 0;
+    
+};
+
+
+/**
+ * @brief An input replay contains everything needed to simulate a
+ * playthrough of an area again, exactly like it happened: the area,
+ * the random number generator's seed, and the inputs of every frame.
+ *
+ * Unlike the state-based replay, this is meant to be played back by the
+ * engine itself. A hash of the world is saved every frame, so that
+ * playback can tell if the simulation went down a different path.
+ */
+class input_replay {
+
+public:
+
+    //--- Members ---
+    
+    //Current mode.
+    INPUT_REPLAY_MODE mode = INPUT_REPLAY_MODE_NONE;
+    
+    //Path to the area that was played.
+    string area_path;
+    
+    //Seed the random number generator started with.
+    unsigned int rng_seed = 0;
+    
+    //Window width during the recording.
+    unsigned int win_w = 0;
+    
+    //Window height during the recording.
+    unsigned int win_h = 0;
+    
+    //Recorded frames.
+    vector<input_replay_frame> frames;
+    
+    //During playback, index of the frame to play next.
+    size_t cur_frame_idx = 0;
+    
+    //During playback, how many frames ended with a different world hash.
+    size_t nr_desyncs = 0;
+    
+    //During playback, index of the first frame that ended with a
+    //different world hash, if any.
+    size_t first_desync_frame_idx = INVALID;
+    
+    //During recording, menu mouse events that will go in the next frame.
+    vector<input_replay_mouse_event> pending_menu_mouse_events;
+    
+    
+    //--- Function declarations ---
+    
+    void clear();
+    void finish_frame(uint32_t world_hash);
+    bool is_playback_over() const;
+    bool load_from_file(const string &file_path);
+    void process_frame(
+        double* delta_t, point* mouse_s_pos, point* mouse_w_pos,
+        vector<player_action>* actions,
+        vector<ALLEGRO_EVENT>* menu_mouse_events
+    );
+    void record_menu_mouse_event(const ALLEGRO_EVENT &ev);
+    void restart_playback();
+    bool save_to_file(const string &file_path) const;
+    void start_recording(
+        const string &area_path, unsigned int rng_seed,
+        unsigned int win_w, unsigned int win_h
+    );
+    
+};
+
+
 /**
  * @brief Represents a Pikmin, a leader, or any other object we want to keep in
  * the replay.
@@ -181,3 +337,7 @@ private:
     size_t prev_leader_idx = INVALID;
     
 };
+
+
+float read_replay_float(ALLEGRO_FILE* file);
+void write_replay_float(ALLEGRO_FILE* file, float f);
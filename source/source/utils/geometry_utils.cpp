@@ -19,9 +19,49 @@
 #include "math_utils.h"
 #include "string_utils.h"
 
+//SSE2 is always there on x86-64, and it's what 32-bit x86 compilers
+//normally target nowadays too. On anything else, like ARM, the batched
+//checks just go through the scalar functions.
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GEOMETRY_UTILS_SSE2
+#include <emmintrin.h>
+#endif
+
+//AVX2 is only on some x86 CPUs, so the code for it is compiled in
+//regardless of the compiler flags, and only used if the CPU running the
+//game says it has it. Otherwise, the batched checks fall back to SSE2.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GEOMETRY_UTILS_AVX2
+#define GEOMETRY_UTILS_AVX2_FUNC __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define GEOMETRY_UTILS_AVX2
+#define GEOMETRY_UTILS_AVX2_FUNC
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
 using std::vector;
 
 
+#ifdef GEOMETRY_UTILS_AVX2
+static bool cpu_has_avx2();
+static size_t circle_intersects_line_segs_avx2(
+    const point &circle, float radius,
+    const float* line_p1_xs, const float* line_p1_ys,
+    const float* line_p2_xs, const float* line_p2_ys,
+    size_t n, unsigned char* out_results
+);
+static size_t line_seg_intersects_line_segs_avx2(
+    const point &l1p1, const point &l1p2,
+    const float* l2p1_xs, const float* l2p1_ys,
+    const float* l2p2_xs, const float* l2p2_ys,
+    size_t n, unsigned char* out_results
+);
+#endif
+
+
 /**
  * @brief Constructs a new dist object, given two points.
  *
@@ -657,6 +697,248 @@ bool circle_intersects_line_seg(
 }
 
 
+/**
+ * @brief Checks if a circle is touching each one of several line segments.
+ * The segments' coordinates are given one list per coordinate, so that
+ * several of them can be checked at once. The results are exactly
+ * the same as calling circle_intersects_line_seg() on each one.
+ *
+ * @param circle Coordinates of the circle.
+ * @param radius Radius of the circle.
+ * @param line_p1_xs X coordinates of the segments' starting points.
+ * @param line_p1_ys Y coordinates of the segments' starting points.
+ * @param line_p2_xs X coordinates of the segments' ending points.
+ * @param line_p2_ys Y coordinates of the segments' ending points.
+ * @param n Number of line segments.
+ * @param out_results For each segment, 1 is returned here if they touch,
+ * 0 if not.
+ */
+void circle_intersects_line_segs(
+    const point &circle, float radius,
+    const float* line_p1_xs, const float* line_p1_ys,
+    const float* line_p2_xs, const float* line_p2_ys,
+    size_t n, unsigned char* out_results
+) {
+    size_t s = 0;
+    
+#ifdef GEOMETRY_UTILS_AVX2
+    if(cpu_has_avx2()) {
+        s =
+            circle_intersects_line_segs_avx2(
+                circle, radius,
+                line_p1_xs, line_p1_ys, line_p2_xs, line_p2_ys,
+                n, out_results
+            );
+    }
+#endif
+
+#ifdef GEOMETRY_UTILS_SSE2
+    //Same math as circle_intersects_line_seg(), operation by operation,
+    //so that the rounding is the same too.
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 four = _mm_set1_ps(4.0f);
+    const __m128 sign_bit = _mm_set1_ps(-0.0f);
+    const __m128 cx = _mm_set1_ps(circle.x);
+    const __m128 cy = _mm_set1_ps(circle.y);
+    const __m128 radius_sq = _mm_set1_ps(radius * radius);
+    for(; s + 4 <= n; s += 4) {
+        __m128 x1 = _mm_loadu_ps(line_p1_xs + s);
+        __m128 y1 = _mm_loadu_ps(line_p1_ys + s);
+        __m128 x2 = _mm_loadu_ps(line_p2_xs + s);
+        __m128 y2 = _mm_loadu_ps(line_p2_ys + s);
+        __m128 vx = _mm_sub_ps(x2, x1);
+        __m128 vy = _mm_sub_ps(y2, y1);
+        __m128 xdiff = _mm_sub_ps(x1, cx);
+        __m128 ydiff = _mm_sub_ps(y1, cy);
+        __m128 a = _mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy));
+        __m128 b =
+            _mm_mul_ps(
+                two,
+                _mm_add_ps(_mm_mul_ps(vx, xdiff), _mm_mul_ps(vy, ydiff))
+            );
+        __m128 c =
+            _mm_sub_ps(
+                _mm_add_ps(_mm_mul_ps(xdiff, xdiff), _mm_mul_ps(ydiff, ydiff)),
+                radius_sq
+            );
+        __m128 quad =
+            _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(_mm_mul_ps(four, a), c));
+        __m128 quad_sqrt = _mm_sqrt_ps(quad);
+        __m128 two_a = _mm_mul_ps(two, a);
+        
+        //The two intersection points.
+        __m128 t1 = _mm_div_ps(_mm_add_ps(b, quad_sqrt), two_a);
+        __m128 t2 =
+            _mm_div_ps(_mm_add_ps(_mm_xor_ps(b, sign_bit), quad_sqrt), two_a);
+        __m128 ix1 = _mm_add_ps(x1, _mm_mul_ps(_mm_xor_ps(vx, sign_bit), t1));
+        __m128 iy1 = _mm_add_ps(y1, _mm_mul_ps(_mm_xor_ps(vy, sign_bit), t1));
+        __m128 ix2 = _mm_add_ps(x1, _mm_mul_ps(vx, t2));
+        __m128 iy2 = _mm_add_ps(y1, _mm_mul_ps(vy, t2));
+        
+        //Are they in the boundaries of the segment?
+        __m128 min_x = _mm_min_ps(x1, x2);
+        __m128 max_x = _mm_max_ps(x1, x2);
+        __m128 min_y = _mm_min_ps(y1, y2);
+        __m128 max_y = _mm_max_ps(y1, y2);
+        __m128 in1 =
+            _mm_and_ps(
+                _mm_and_ps(_mm_cmpge_ps(ix1, min_x), _mm_cmple_ps(ix1, max_x)),
+                _mm_and_ps(_mm_cmpge_ps(iy1, min_y), _mm_cmple_ps(iy1, max_y))
+            );
+        __m128 in2 =
+            _mm_and_ps(
+                _mm_and_ps(_mm_cmpge_ps(ix2, min_x), _mm_cmple_ps(ix2, max_x)),
+                _mm_and_ps(_mm_cmpge_ps(iy2, min_y), _mm_cmple_ps(iy2, max_y))
+            );
+        int mask =
+            _mm_movemask_ps(
+                _mm_and_ps(_mm_cmpge_ps(quad, zero), _mm_or_ps(in1, in2))
+            );
+        for(size_t l = 0; l < 4; l++) {
+            out_results[s + l] = (mask >> l) & 1;
+        }
+    }
+#endif
+
+    for(; s < n; s++) {
+        out_results[s] =
+            circle_intersects_line_seg(
+                circle, radius,
+                point(line_p1_xs[s], line_p1_ys[s]),
+                point(line_p2_xs[s], line_p2_ys[s])
+            ) ? 1 : 0;
+    }
+}
+
+
+#ifdef GEOMETRY_UTILS_AVX2
+/**
+ * @brief Does the work of circle_intersects_line_segs() with AVX2,
+ * eight segments at a time. Only call this if the CPU has AVX2.
+ *
+ * @param circle Coordinates of the circle.
+ * @param radius Radius of the circle.
+ * @param line_p1_xs X coordinates of the segments' starting points.
+ * @param line_p1_ys Y coordinates of the segments' starting points.
+ * @param line_p2_xs X coordinates of the segments' ending points.
+ * @param line_p2_ys Y coordinates of the segments' ending points.
+ * @param n Number of line segments.
+ * @param out_results For each segment, 1 is returned here if they touch,
+ * 0 if not.
+ * @return How many segments were checked. The rest, fewer than eight,
+ * still need to be checked some other way.
+ */
+GEOMETRY_UTILS_AVX2_FUNC
+static size_t circle_intersects_line_segs_avx2(
+    const point &circle, float radius,
+    const float* line_p1_xs, const float* line_p1_ys,
+    const float* line_p2_xs, const float* line_p2_ys,
+    size_t n, unsigned char* out_results
+) {
+    //Same math as circle_intersects_line_seg(), operation by operation,
+    //so that the rounding is the same too. No fused multiply-adds,
+    //since those round differently.
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 two = _mm256_set1_ps(2.0f);
+    const __m256 four = _mm256_set1_ps(4.0f);
+    const __m256 sign_bit = _mm256_set1_ps(-0.0f);
+    const __m256 cx = _mm256_set1_ps(circle.x);
+    const __m256 cy = _mm256_set1_ps(circle.y);
+    const __m256 radius_sq = _mm256_set1_ps(radius * radius);
+    size_t s = 0;
+    for(; s + 8 <= n; s += 8) {
+        __m256 x1 = _mm256_loadu_ps(line_p1_xs + s);
+        __m256 y1 = _mm256_loadu_ps(line_p1_ys + s);
+        __m256 x2 = _mm256_loadu_ps(line_p2_xs + s);
+        __m256 y2 = _mm256_loadu_ps(line_p2_ys + s);
+        __m256 vx = _mm256_sub_ps(x2, x1);
+        __m256 vy = _mm256_sub_ps(y2, y1);
+        __m256 xdiff = _mm256_sub_ps(x1, cx);
+        __m256 ydiff = _mm256_sub_ps(y1, cy);
+        __m256 a =
+            _mm256_add_ps(_mm256_mul_ps(vx, vx), _mm256_mul_ps(vy, vy));
+        __m256 b =
+            _mm256_mul_ps(
+                two,
+                _mm256_add_ps(
+                    _mm256_mul_ps(vx, xdiff), _mm256_mul_ps(vy, ydiff)
+                )
+            );
+        __m256 c =
+            _mm256_sub_ps(
+                _mm256_add_ps(
+                    _mm256_mul_ps(xdiff, xdiff), _mm256_mul_ps(ydiff, ydiff)
+                ),
+                radius_sq
+            );
+        __m256 quad =
+            _mm256_sub_ps(
+                _mm256_mul_ps(b, b), _mm256_mul_ps(_mm256_mul_ps(four, a), c)
+            );
+        __m256 quad_sqrt = _mm256_sqrt_ps(quad);
+        __m256 two_a = _mm256_mul_ps(two, a);
+        
+        //The two intersection points.
+        __m256 t1 = _mm256_div_ps(_mm256_add_ps(b, quad_sqrt), two_a);
+        __m256 t2 =
+            _mm256_div_ps(
+                _mm256_add_ps(_mm256_xor_ps(b, sign_bit), quad_sqrt), two_a
+            );
+        __m256 ix1 =
+            _mm256_add_ps(
+                x1, _mm256_mul_ps(_mm256_xor_ps(vx, sign_bit), t1)
+            );
+        __m256 iy1 =
+            _mm256_add_ps(
+                y1, _mm256_mul_ps(_mm256_xor_ps(vy, sign_bit), t1)
+            );
+        __m256 ix2 = _mm256_add_ps(x1, _mm256_mul_ps(vx, t2));
+        __m256 iy2 = _mm256_add_ps(y1, _mm256_mul_ps(vy, t2));
+        
+        //Are they in the boundaries of the segment?
+        __m256 min_x = _mm256_min_ps(x1, x2);
+        __m256 max_x = _mm256_max_ps(x1, x2);
+        __m256 min_y = _mm256_min_ps(y1, y2);
+        __m256 max_y = _mm256_max_ps(y1, y2);
+        __m256 in1 =
+            _mm256_and_ps(
+                _mm256_and_ps(
+                    _mm256_cmp_ps(ix1, min_x, _CMP_GE_OQ),
+                    _mm256_cmp_ps(ix1, max_x, _CMP_LE_OQ)
+                ),
+                _mm256_and_ps(
+                    _mm256_cmp_ps(iy1, min_y, _CMP_GE_OQ),
+                    _mm256_cmp_ps(iy1, max_y, _CMP_LE_OQ)
+                )
+            );
+        __m256 in2 =
+            _mm256_and_ps(
+                _mm256_and_ps(
+                    _mm256_cmp_ps(ix2, min_x, _CMP_GE_OQ),
+                    _mm256_cmp_ps(ix2, max_x, _CMP_LE_OQ)
+                ),
+                _mm256_and_ps(
+                    _mm256_cmp_ps(iy2, min_y, _CMP_GE_OQ),
+                    _mm256_cmp_ps(iy2, max_y, _CMP_LE_OQ)
+                )
+            );
+        int mask =
+            _mm256_movemask_ps(
+                _mm256_and_ps(
+                    _mm256_cmp_ps(quad, zero, _CMP_GE_OQ),
+                    _mm256_or_ps(in1, in2)
+                )
+            );
+        for(size_t l = 0; l < 8; l++) {
+            out_results[s + l] = (mask >> l) & 1;
+        }
+    }
+    return s;
+}
+#endif
+
+
 /**
  * @brief Returns whether a circle is touching a rotated rectangle or not.
  * This includes being completely inside the rectangle.
@@ -790,6 +1072,40 @@ bool collinear_line_segs_intersect(
 }
 
 
+#ifdef GEOMETRY_UTILS_AVX2
+/**
+ * @brief Returns whether the CPU running the game has AVX2,
+ * and the operating system lets it be used. This is only checked once.
+ *
+ * @return Whether it has it.
+ */
+static bool cpu_has_avx2() {
+    static const bool has_avx2 = [] () {
+#if defined(__GNUC__)
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+#else
+        int info[4];
+        __cpuid(info, 0);
+        if(info[0] < 7) return false;
+        
+        //The CPU needs AVX, and the OS needs to save the AVX registers
+        //when switching threads.
+        __cpuid(info, 1);
+        bool has_osxsave = (info[2] & (1 << 27)) != 0;
+        bool has_avx = (info[2] & (1 << 28)) != 0;
+        if(!has_osxsave || !has_avx) return false;
+        if((_xgetbv(0) & 6) != 6) return false;
+        
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#endif
+    }();
+    return has_avx2;
+}
+#endif
+
+
 /**
  * @brief Returns the angle and magnitude of vector coordinates.
  *
@@ -1332,6 +1648,176 @@ bool is_point_in_triangle(
 }
 
 
+/**
+ * @brief Checks if a line segment intersects with each one of several
+ * other line segments. The other segments' coordinates are given one list
+ * per coordinate, so that several of them can be checked at once.
+ * The results are exactly the same as calling line_segs_intersect()
+ * on each one.
+ *
+ * @param l1p1 Starting point of the line segment.
+ * @param l1p2 Ending point of the line segment.
+ * @param l2p1_xs X coordinates of the other segments' starting points.
+ * @param l2p1_ys Y coordinates of the other segments' starting points.
+ * @param l2p2_xs X coordinates of the other segments' ending points.
+ * @param l2p2_ys Y coordinates of the other segments' ending points.
+ * @param n Number of other line segments.
+ * @param out_results For each other segment, 1 is returned here if
+ * they intersect, 0 if not.
+ */
+void line_seg_intersects_line_segs(
+    const point &l1p1, const point &l1p2,
+    const float* l2p1_xs, const float* l2p1_ys,
+    const float* l2p2_xs, const float* l2p2_ys,
+    size_t n, unsigned char* out_results
+) {
+    size_t s = 0;
+    
+#ifdef GEOMETRY_UTILS_AVX2
+    if(cpu_has_avx2()) {
+        s =
+            line_seg_intersects_line_segs_avx2(
+                l1p1, l1p2, l2p1_xs, l2p1_ys, l2p2_xs, l2p2_ys,
+                n, out_results
+            );
+    }
+#endif
+
+#ifdef GEOMETRY_UTILS_SSE2
+    //Same math as lines_intersect(), operation by operation,
+    //so that the rounding is the same too.
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 l1x1 = _mm_set1_ps(l1p1.x);
+    const __m128 l1y1 = _mm_set1_ps(l1p1.y);
+    const __m128 l1dx = _mm_set1_ps(l1p2.x - l1p1.x);
+    const __m128 l1dy = _mm_set1_ps(l1p2.y - l1p1.y);
+    for(; s + 4 <= n; s += 4) {
+        __m128 x1 = _mm_loadu_ps(l2p1_xs + s);
+        __m128 y1 = _mm_loadu_ps(l2p1_ys + s);
+        __m128 l2dx = _mm_sub_ps(_mm_loadu_ps(l2p2_xs + s), x1);
+        __m128 l2dy = _mm_sub_ps(_mm_loadu_ps(l2p2_ys + s), y1);
+        __m128 ox = _mm_sub_ps(l1x1, x1);
+        __m128 oy = _mm_sub_ps(l1y1, y1);
+        __m128 div =
+            _mm_sub_ps(_mm_mul_ps(l2dy, l1dx), _mm_mul_ps(l2dx, l1dy));
+        __m128 l1r =
+            _mm_div_ps(
+                _mm_sub_ps(_mm_mul_ps(l2dx, oy), _mm_mul_ps(l2dy, ox)),
+                div
+            );
+        __m128 l2r =
+            _mm_div_ps(
+                _mm_sub_ps(_mm_mul_ps(l1dx, oy), _mm_mul_ps(l1dy, ox)),
+                div
+            );
+        __m128 hit =
+            _mm_and_ps(
+                _mm_and_ps(_mm_cmpge_ps(l1r, zero), _mm_cmple_ps(l1r, one)),
+                _mm_and_ps(_mm_cmpge_ps(l2r, zero), _mm_cmple_ps(l2r, one))
+            );
+        int mask = _mm_movemask_ps(_mm_and_ps(hit, _mm_cmpneq_ps(div, zero)));
+        for(size_t l = 0; l < 4; l++) {
+            out_results[s + l] = (mask >> l) & 1;
+        }
+    }
+#endif
+
+    for(; s < n; s++) {
+        out_results[s] =
+            line_segs_intersect(
+                l1p1, l1p2,
+                point(l2p1_xs[s], l2p1_ys[s]),
+                point(l2p2_xs[s], l2p2_ys[s]),
+                nullptr, nullptr
+            ) ? 1 : 0;
+    }
+}
+
+
+#ifdef GEOMETRY_UTILS_AVX2
+/**
+ * @brief Does the work of line_seg_intersects_line_segs() with AVX2,
+ * eight segments at a time. Only call this if the CPU has AVX2.
+ *
+ * @param l1p1 Starting point of the line segment.
+ * @param l1p2 Ending point of the line segment.
+ * @param l2p1_xs X coordinates of the other segments' starting points.
+ * @param l2p1_ys Y coordinates of the other segments' starting points.
+ * @param l2p2_xs X coordinates of the other segments' ending points.
+ * @param l2p2_ys Y coordinates of the other segments' ending points.
+ * @param n Number of other line segments.
+ * @param out_results For each other segment, 1 is returned here if
+ * they intersect, 0 if not.
+ * @return How many segments were checked. The rest, fewer than eight,
+ * still need to be checked some other way.
+ */
+GEOMETRY_UTILS_AVX2_FUNC
+static size_t line_seg_intersects_line_segs_avx2(
+    const point &l1p1, const point &l1p2,
+    const float* l2p1_xs, const float* l2p1_ys,
+    const float* l2p2_xs, const float* l2p2_ys,
+    size_t n, unsigned char* out_results
+) {
+    //Same math as lines_intersect(), operation by operation,
+    //so that the rounding is the same too. No fused multiply-adds,
+    //since those round differently.
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 l1x1 = _mm256_set1_ps(l1p1.x);
+    const __m256 l1y1 = _mm256_set1_ps(l1p1.y);
+    const __m256 l1dx = _mm256_set1_ps(l1p2.x - l1p1.x);
+    const __m256 l1dy = _mm256_set1_ps(l1p2.y - l1p1.y);
+    size_t s = 0;
+    for(; s + 8 <= n; s += 8) {
+        __m256 x1 = _mm256_loadu_ps(l2p1_xs + s);
+        __m256 y1 = _mm256_loadu_ps(l2p1_ys + s);
+        __m256 l2dx = _mm256_sub_ps(_mm256_loadu_ps(l2p2_xs + s), x1);
+        __m256 l2dy = _mm256_sub_ps(_mm256_loadu_ps(l2p2_ys + s), y1);
+        __m256 ox = _mm256_sub_ps(l1x1, x1);
+        __m256 oy = _mm256_sub_ps(l1y1, y1);
+        __m256 div =
+            _mm256_sub_ps(
+                _mm256_mul_ps(l2dy, l1dx), _mm256_mul_ps(l2dx, l1dy)
+            );
+        __m256 l1r =
+            _mm256_div_ps(
+                _mm256_sub_ps(
+                    _mm256_mul_ps(l2dx, oy), _mm256_mul_ps(l2dy, ox)
+                ),
+                div
+            );
+        __m256 l2r =
+            _mm256_div_ps(
+                _mm256_sub_ps(
+                    _mm256_mul_ps(l1dx, oy), _mm256_mul_ps(l1dy, ox)
+                ),
+                div
+            );
+        __m256 hit =
+            _mm256_and_ps(
+                _mm256_and_ps(
+                    _mm256_cmp_ps(l1r, zero, _CMP_GE_OQ),
+                    _mm256_cmp_ps(l1r, one, _CMP_LE_OQ)
+                ),
+                _mm256_and_ps(
+                    _mm256_cmp_ps(l2r, zero, _CMP_GE_OQ),
+                    _mm256_cmp_ps(l2r, one, _CMP_LE_OQ)
+                )
+            );
+        int mask =
+            _mm256_movemask_ps(
+                _mm256_and_ps(hit, _mm256_cmp_ps(div, zero, _CMP_NEQ_UQ))
+            );
+        for(size_t l = 0; l < 8; l++) {
+            out_results[s + l] = (mask >> l) & 1;
+        }
+    }
+    return s;
+}
+#endif
+
+
 /**
  * @brief Returns whether a line segment intersects with a rectangle.
  * Also returns true if the line is fully inside the rectangle.
@@ -1700,6 +2186,104 @@ void move_point(
 }
 
 
+/**
+ * @brief Returns whether a moving circle hits a line segment, and when.
+ * If the circle already touches the segment at the start, that only counts
+ * as a hit if the movement takes it all the way through to the other side,
+ * since otherwise it will still be touching the segment at the end.
+ *
+ * @param circle Coordinates of the circle at the start.
+ * @param radius Radius of the circle.
+ * @param movement How much the circle moves.
+ * @param line_p1 Starting point of the line segment.
+ * @param line_p2 Ending point of the line segment.
+ * @param out_time If not nullptr, how far along the movement the hit happens
+ * is returned here, from 0 (at the start) to 1 (at the end).
+ * @return Whether they hit.
+ */
+bool moving_circle_intersects_line_seg(
+    const point &circle, float radius, const point &movement,
+    const point &line_p1, const point &line_p2, float* out_time
+) {
+    point seg = line_p2 - line_p1;
+    float seg_len = dist(line_p1, line_p2).to_float();
+    point seg_dir = seg_len > 0.0f ? seg / seg_len : point(1.0f, 0.0f);
+    point normal(-seg_dir.y, seg_dir.x);
+    
+    //Distance to the segment's line, with a sign for each side,
+    //and how much the movement changes that.
+    float start_dist =
+        (circle.x - line_p1.x) * normal.x + (circle.y - line_p1.y) * normal.y;
+    float dist_change = movement.x * normal.x + movement.y * normal.y;
+    float start_along =
+        (circle.x - line_p1.x) * seg_dir.x + (circle.y - line_p1.y) * seg_dir.y;
+    float along_change = movement.x * seg_dir.x + movement.y * seg_dir.y;
+    
+    float closest_along = clamp(start_along, 0.0f, seg_len);
+    point closest = line_p1 + seg_dir * closest_along;
+    if(dist(circle, closest) <= radius) {
+        //Already touching. Check if it goes all the way through.
+        float end_dist = start_dist + dist_change;
+        point end_closest =
+            line_p1 +
+            seg_dir * clamp(start_along + along_change, 0.0f, seg_len);
+        if(
+            seg_len == 0.0f ||
+            start_dist * end_dist > 0.0f ||
+            dist(circle + movement, end_closest) <= radius
+        ) {
+            return false;
+        }
+        float cross_time =
+            dist_change == 0.0f ? 0.0f : -start_dist / dist_change;
+        float cross_along = start_along + along_change * cross_time;
+        if(cross_along < 0.0f || cross_along > seg_len) return false;
+        if(out_time) *out_time = 0.0f;
+        return true;
+    }
+    
+    //The circle hits the segment when its center enters the capsule
+    //around the segment, which is made of a rectangle along the segment,
+    //and one circle at each end. The hit is whichever part it enters first.
+    float hit_time = FLT_MAX;
+    
+    //The rectangle along the segment.
+    float t = -1.0f;
+    if(start_dist > radius && dist_change < 0.0f) {
+        t = (start_dist - radius) / -dist_change;
+    } else if(start_dist < -radius && dist_change > 0.0f) {
+        t = (-radius - start_dist) / dist_change;
+    }
+    if(t >= 0.0f && t <= 1.0f) {
+        float along = start_along + along_change * t;
+        if(along >= 0.0f && along <= seg_len) {
+            hit_time = t;
+        }
+    }
+    
+    //The circles at each end.
+    float a = movement.x * movement.x + movement.y * movement.y;
+    if(a > 0.0f) {
+        for(unsigned char e = 0; e < 2; e++) {
+            const point &end = e == 0 ? line_p1 : line_p2;
+            point diff = circle - end;
+            float b = 2.0f * (diff.x * movement.x + diff.y * movement.y);
+            float c = diff.x * diff.x + diff.y * diff.y - radius * radius;
+            float quad = b * b - 4.0f * a * c;
+            if(quad < 0.0f) continue;
+            t = (-b - (float) sqrt(quad)) / (2.0f * a);
+            if(t >= 0.0f && t <= 1.0f) {
+                hit_time = std::min(hit_time, t);
+            }
+        }
+    }
+    
+    if(hit_time == FLT_MAX) return false;
+    if(out_time) *out_time = hit_time;
+    return true;
+}
+
+
 /**
  * @brief Normalizes an angle so that it's between 0 and TAU (M_PI * 2).
  *
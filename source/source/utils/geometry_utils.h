@@ -149,6 +149,12 @@ bool circle_intersects_line_seg(
     const point &line_p1, const point &line_p2,
     float* out_lix = nullptr, float* out_liy = nullptr
 );
+void circle_intersects_line_segs(
+    const point &circle, float radius,
+    const float* line_p1_xs, const float* line_p1_ys,
+    const float* line_p2_xs, const float* line_p2_ys,
+    size_t n, unsigned char* out_results
+);
 bool circle_intersects_rectangle(
     const point &circle, float cr,
     const point &rectangle, const point &rect_dim,
@@ -214,6 +220,12 @@ float linear_dist_to_angular(float linear_dist, float radius);
 bool line_segs_are_collinear(
     const point &a, const point &b, const point &c, const point &d
 );
+void line_seg_intersects_line_segs(
+    const point &l1p1, const point &l1p2,
+    const float* l2p1_xs, const float* l2p1_ys,
+    const float* l2p2_xs, const float* l2p2_ys,
+    size_t n, unsigned char* out_results
+);
 bool line_seg_intersects_rectangle(
     const point &r1, const point &r2,
     const point &l1, const point &l2
@@ -245,6 +257,10 @@ void move_point(
     float speed, float reach_radius, point* mov,
     float* angle, bool* reached, float delta_t
 );
+bool moving_circle_intersects_line_seg(
+    const point &circle, float radius, const point &movement,
+    const point &line_p1, const point &line_p2, float* out_time
+);
 float normalize_angle(float a);
 point normalize_vector(const point &v);
 bool points_are_collinear(
@@ -201,17 +201,43 @@ float interpolate_number(
 }
 
 
+/**
+ * @brief Returns a random integer between 0 and RAND_MAX, inclusive.
+ *
+ * @param state If not nullptr, the number comes from a generator with this
+ * state, which gets advanced, instead of the global one. This lets a system
+ * have its own sequence of random numbers without disturbing anyone else's.
+ * @return The random number.
+ */
+int random_raw(uint32_t* state) {
+    if(!state) return rand();
+    
+    //Xorshift. It gets stuck on 0, so don't let it start there.
+    uint32_t x = *state;
+    if(x == 0) x = 0x9E3779B9;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return (int) (x % ((uint32_t) RAND_MAX + 1));
+}
+
+
 /**
  * @brief Returns a random float between the provided range, inclusive.
  *
  * @param minimum Minimum value that can be generated, inclusive.
  * @param maximum Maximum value that can be generated, inclusive.
+ * @param state If not nullptr, use a generator with this state instead of
+ * the global one. See random_raw().
  * @return The random number.
  */
-float randomf(float minimum, float maximum) {
+float randomf(float minimum, float maximum, uint32_t* state) {
     if(minimum == maximum) return minimum;
     if(minimum > maximum) std::swap(minimum, maximum);
-    return (float) rand() / ((float) RAND_MAX / (maximum - minimum)) + minimum;
+    return
+        (float) random_raw(state) /
+        ((float) RAND_MAX / (maximum - minimum)) + minimum;
 }
 
 
@@ -220,12 +246,14 @@ float randomf(float minimum, float maximum) {
  *
  * @param minimum Minimum value that can be generated, inclusive.
  * @param maximum Maximum value that can be generated, inclusive.
+ * @param state If not nullptr, use a generator with this state instead of
+ * the global one. See random_raw().
  * @return The random number.
  */
-int randomi(int minimum, int maximum) {
+int randomi(int minimum, int maximum, uint32_t* state) {
     if(minimum == maximum) return minimum;
     if(minimum > maximum) std::swap(minimum, maximum);
-    return ((rand()) % (maximum - minimum + 1)) + minimum;
+    return (random_raw(state) % (maximum - minimum + 1)) + minimum;
 }
 
 
@@ -13,6 +13,8 @@
 
 #include <algorithm>
 #include <assert.h>
+#include <cmath>
+#include <cstdio>
 #include <cstdlib>
 #include <iomanip>
 #include <sstream>
@@ -497,6 +499,64 @@ string time_to_str3(
 }
 
 
+/**
+ * @brief Converts a number into a JSON number. Values JSON has no way
+ * of representing, like infinity, become null.
+ *
+ * @param n Number to convert.
+ * @return The JSON text.
+ */
+string to_json_number(double n) {
+    if(std::isnan(n) || std::isinf(n)) return "null";
+    std::ostringstream s;
+    s << std::setprecision(9) << n;
+    return s.str();
+}
+
+
+/**
+ * @brief Converts a string into a quoted JSON string,
+ * escaping any characters that need it.
+ *
+ * @param s String to convert.
+ * @return The JSON text.
+ */
+string to_json_string(const string &s) {
+    string result = "\"";
+    for(size_t c = 0; c < s.size(); c++) {
+        unsigned char ch = s[c];
+        switch(ch) {
+        case '"': {
+            result += "\\\"";
+            break;
+        } case '\\': {
+            result += "\\\\";
+            break;
+        } case '\n': {
+            result += "\\n";
+            break;
+        } case '\r': {
+            result += "\\r";
+            break;
+        } case '\t': {
+            result += "\\t";
+            break;
+        } default: {
+            if(ch < 0x20) {
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\u%04x", ch);
+                result += buf;
+            } else {
+                result += (char) ch;
+            }
+            break;
+        }
+        }
+    }
+    return result + "\"";
+}
+
+
 /**
  * @brief Removes all trailing and preceding spaces.
  * This means space and tab characters before and after the 'middle' characters.
@@ -78,6 +78,8 @@ string time_to_str3(
     const string &suffix1, const string &suffix2, const string &suffix3,
     uint8_t flags = 0
 );
+string to_json_number(double n);
+string to_json_string(const string &s);
 string trim_spaces(const string &s, bool left_only = false);
 string trim_with_ellipsis(const string &s, size_t size);
 string word_wrap(const string &s, size_t n_chars_per_line);
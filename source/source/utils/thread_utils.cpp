@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) Andre 'Espyo' Silva 2013.
+ * The following source file belongs to the open-source project Pikifen.
+ * Please read the included README and LICENSE files for more information.
+ * Pikmin is copyright (c) Nintendo.
+ *
+ * === FILE DESCRIPTION ===
+ * Multithreading utility classes and functions.
+ */
+
+#include <algorithm>
+
+#include "thread_utils.h"
+
+
+namespace THREAD_UTILS {
+
+//How many items a thread takes from a job at a time.
+const size_t JOB_CHUNK_SIZE = 8;
+
+}
+
+
+/**
+ * @brief Destroys the background worker object.
+ */
+background_worker::~background_worker() {
+    stop();
+}
+
+
+/**
+ * @brief Adds a task to the end of the list. If the worker thread isn't
+ * running, the task runs right away, on the current thread.
+ *
+ * @param task Task to run.
+ */
+void background_worker::add_task(const std::function<void()> &task) {
+    if(!is_running()) {
+        task();
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex);
+        tasks.push_back(task);
+    }
+    task_added_cond.notify_one();
+}
+
+
+/**
+ * @brief Returns whether the worker thread is running.
+ *
+ * @return Whether it's running.
+ */
+bool background_worker::is_running() const {
+    return worker.joinable();
+}
+
+
+/**
+ * @brief Starts the worker thread. If it was already running,
+ * it is stopped first.
+ */
+void background_worker::start() {
+    stop();
+    stopping = false;
+    worker = std::thread(&background_worker::work, this);
+}
+
+
+/**
+ * @brief Stops the worker thread and waits for it to finish.
+ * Tasks that haven't started yet are dropped.
+ */
+void background_worker::stop() {
+    if(!is_running()) return;
+    
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex);
+        stopping = true;
+        tasks.clear();
+    }
+    task_added_cond.notify_one();
+    
+    worker.join();
+    busy = false;
+}
+
+
+/**
+ * @brief Waits until every task added so far is done.
+ */
+void background_worker::wait() {
+    if(!is_running()) return;
+    
+    std::unique_lock<std::mutex> lock(tasks_mutex);
+    idle_cond.wait(lock, [this] () { return tasks.empty() && !busy; });
+}
+
+
+/**
+ * @brief Main loop of the worker thread. It runs tasks as they come,
+ * until it's stopped.
+ */
+void background_worker::work() {
+    while(true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(tasks_mutex);
+            busy = false;
+            if(tasks.empty()) idle_cond.notify_all();
+            task_added_cond.wait(
+                lock,
+            [this] () {
+                return stopping || !tasks.empty();
+            }
+            );
+            if(stopping) return;
+            task = tasks.front();
+            tasks.pop_front();
+            busy = true;
+        }
+        
+        task();
+    }
+}
+
+
+/**
+ * @brief Destroys the worker pool object.
+ */
+worker_pool::~worker_pool() {
+    stop();
+}
+
+
+/**
+ * @brief Returns how many worker threads are running, not counting
+ * the thread that starts the jobs.
+ *
+ * @return The number of workers.
+ */
+size_t worker_pool::get_nr_workers() const {
+    return workers.size();
+}
+
+
+/**
+ * @brief Runs a function once for every item, splitting the items among
+ * the workers and the current thread. This only returns once every item
+ * is done. If there are no workers, everything runs on the current thread,
+ * in order.
+ *
+ * @param nr_items Number of items.
+ * @param func Function to run. It receives the index of the item.
+ */
+void worker_pool::parallel_for(
+    size_t nr_items, const std::function<void(size_t idx)> &func
+) {
+    if(nr_items == 0) return;
+    
+    if(workers.empty() || nr_items <= THREAD_UTILS::JOB_CHUNK_SIZE) {
+        for(size_t i = 0; i < nr_items; i++) {
+            func(i);
+        }
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(job_mutex);
+        job_func = &func;
+        job_nr_items = nr_items;
+        job_next_item = 0;
+        nr_busy_workers = workers.size();
+        job_nr++;
+    }
+    job_start_cond.notify_all();
+    
+    run_job_items();
+    
+    std::unique_lock<std::mutex> lock(job_mutex);
+    job_end_cond.wait(lock, [this] () { return nr_busy_workers == 0; });
+    job_func = nullptr;
+}
+
+
+/**
+ * @brief Takes items from the current job and runs them,
+ * until there are none left.
+ */
+void worker_pool::run_job_items() {
+    while(true) {
+        size_t first =
+            job_next_item.fetch_add(THREAD_UTILS::JOB_CHUNK_SIZE);
+        if(first >= job_nr_items) return;
+        size_t last =
+            std::min(first + THREAD_UTILS::JOB_CHUNK_SIZE, job_nr_items);
+        for(size_t i = first; i < last; i++) {
+            (*job_func)(i);
+        }
+    }
+}
+
+
+/**
+ * @brief Starts the worker threads. If they were already running,
+ * they are stopped first.
+ *
+ * @param nr_workers Number of worker threads to start. 0 means none,
+ * in which case every job runs on the thread that starts it.
+ */
+void worker_pool::start(size_t nr_workers) {
+    stop();
+    stopping = false;
+    for(size_t w = 0; w < nr_workers; w++) {
+        workers.push_back(std::thread(&worker_pool::work, this, job_nr));
+    }
+}
+
+
+/**
+ * @brief Stops the worker threads and waits for them to finish.
+ */
+void worker_pool::stop() {
+    if(workers.empty()) return;
+    
+    {
+        std::lock_guard<std::mutex> lock(job_mutex);
+        stopping = true;
+    }
+    job_start_cond.notify_all();
+    
+    for(size_t w = 0; w < workers.size(); w++) {
+        workers[w].join();
+    }
+    workers.clear();
+}
+
+
+/**
+ * @brief Main loop of a worker thread. It waits for jobs, and helps with
+ * them until the pool is stopped.
+ *
+ * @param last_job_nr Number of the last job that was started before
+ * this worker was.
+ */
+void worker_pool::work(size_t last_job_nr) {
+    while(true) {
+        {
+            std::unique_lock<std::mutex> lock(job_mutex);
+            job_start_cond.wait(
+                lock,
+            [this, last_job_nr] () {
+                return stopping || job_nr != last_job_nr;
+            }
+            );
+            if(stopping) return;
+            last_job_nr = job_nr;
+        }
+        
+        run_job_items();
+        
+        bool is_last;
+        {
+            std::lock_guard<std::mutex> lock(job_mutex);
+            nr_busy_workers--;
+            is_last = nr_busy_workers == 0;
+        }
+        if(is_last) job_end_cond.notify_one();
+    }
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) Andre 'Espyo' Silva 2013.
+ * The following source file belongs to the open-source project Pikifen.
+ * Please read the included README and LICENSE files for more information.
+ * Pikmin is copyright (c) Nintendo.
+ *
+ * === FILE DESCRIPTION ===
+ * Header for the multithreading utility classes and functions.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+using std::deque;
+using std::size_t;
+using std::vector;
+
+
+namespace THREAD_UTILS {
+extern const size_t JOB_CHUNK_SIZE;
+}
+
+
+/**
+ * @brief A single worker thread that runs tasks in the background,
+ * in the order they were added.
+ *
+ * While a task runs, nothing it reads may be changed by other threads.
+ * Whatever it writes may only be read by other threads after wait().
+ */
+class background_worker {
+
+public:
+
+    //--- Function declarations ---
+    
+    ~background_worker();
+    void add_task(const std::function<void()> &task);
+    bool is_running() const;
+    void start();
+    void stop();
+    void wait();
+    
+private:
+
+    //--- Members ---
+    
+    //Worker thread.
+    std::thread worker;
+    
+    //Protects the list of tasks and the worker's state.
+    std::mutex tasks_mutex;
+    
+    //Signals the worker that there is a new task, or that it must stop.
+    std::condition_variable task_added_cond;
+    
+    //Signals whoever is waiting that the worker ran out of tasks.
+    std::condition_variable idle_cond;
+    
+    //Tasks that haven't started yet, in order.
+    deque<std::function<void()> > tasks;
+    
+    //Is the worker running a task right now?
+    bool busy = false;
+    
+    //Is the worker meant to stop?
+    bool stopping = false;
+    
+    
+    //--- Function declarations ---
+    
+    void work();
+    
+};
+
+
+/**
+ * @brief A pool of worker threads that can split a loop among themselves.
+ *
+ * The thread that starts the loop also works on it, and only returns once
+ * every item is done. This means that whatever the loop writes is ready
+ * to be used right after, with no further synchronization needed.
+ * The loop's body must only write to data that belongs to its own item.
+ */
+class worker_pool {
+
+public:
+
+    //--- Function declarations ---
+    
+    ~worker_pool();
+    size_t get_nr_workers() const;
+    void parallel_for(
+        size_t nr_items, const std::function<void(size_t idx)> &func
+    );
+    void start(size_t nr_workers);
+    void stop();
+    
+private:
+
+    //--- Members ---
+    
+    //Worker threads.
+    vector<std::thread> workers;
+    
+    //Protects everything related to the current job.
+    std::mutex job_mutex;
+    
+    //Signals the workers that there is a new job, or that they must stop.
+    std::condition_variable job_start_cond;
+    
+    //Signals the thread that started the job that the workers are done.
+    std::condition_variable job_end_cond;
+    
+    //Function to run on each item of the current job.
+    const std::function<void(size_t idx)>* job_func = nullptr;
+    
+    //Number of items in the current job.
+    size_t job_nr_items = 0;
+    
+    //Index of the next item of the current job that nobody took yet.
+    std::atomic<size_t> job_next_item;
+    
+    //Number of the current job. Workers use it to know if there's a new one.
+    size_t job_nr = 0;
+    
+    //Number of workers still working on the current job.
+    size_t nr_busy_workers = 0;
+    
+    //Are the workers meant to stop?
+    bool stopping = false;
+    
+    
+    //--- Function declarations ---
+    
+    void run_job_items();
+    void work(size_t last_job_nr);
+    
+};
@@ -0,0 +1,1180 @@
+/*
+ * Copyright (c) Andre 'Espyo' Silva 2013.
+ * The following source file belongs to the open-source project Pikifen.
+ * Please read the included README and LICENSE files for more information.
+ * Pikmin is copyright (c) Nintendo.
+ *
+ * === FILE DESCRIPTION ===
+ * Verification suite class and related functions.
+ */
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <iostream>
+
+#include "verification.h"
+
+#include "area/geometry.h"
+#include "functions.h"
+#include "game.h"
+#include "mobs/mob_utils.h"
+#include "utils/math_utils.h"
+#include "utils/string_utils.h"
+
+
+namespace VERIFICATION {
+
+//Random points can be this far outside the area's blockmap.
+const float AREA_MARGIN = 256.0f;
+
+//Path distances can be this much off from the reference, in proportion,
+//since adding up the same links in a different order rounds differently.
+const float DIST_TOLERANCE = 0.0001f;
+
+//How many times the path checks move the obstacles around and start over.
+//The first round has no obstacles.
+const size_t NR_CHANGE_ROUNDS = 5;
+
+//How many flow fields the flow field check keeps.
+const size_t NR_FLOW_FIELDS = 8;
+
+//How many objects the path checks add to block path links.
+const size_t NR_OBSTACLES = 8;
+
+//How many random points the point checks try.
+const size_t NR_POINT_CHECKS = 2000;
+
+//Radius of the objects the path checks add to block path links.
+const float OBSTACLE_RADIUS = 16.0f;
+
+//How many end stops the path checks try for each start stop.
+const size_t PATH_ENDS_PER_START = 20;
+
+//How many start stops the path checks try in each round.
+const size_t PATH_STARTS_PER_ROUND = 20;
+
+//Seed for the random number generator, so every run is the same.
+const unsigned int RANDOM_SEED = 1;
+
+//How many steps a point takes in the sector check before it starts
+//somewhere else.
+const size_t SECTOR_WALK_STEPS = 50;
+
+//How many spots along a moving circle's way the swept circle check
+//looks at.
+const size_t SWEEP_SAMPLES = 1000;
+
+//Moving circle hits can be this far off from the reference,
+//in distance, due to rounding errors.
+const float SWEEP_TOLERANCE = 0.05f;
+
+}
+
+
+/**
+ * @brief Counts one answer towards a check's results.
+ *
+ * @param result Results of the check.
+ * @param ok Whether the answer matched the reference.
+ * @param description Description of what was asked, and what the answers
+ * were. Only used if it's the first mismatch.
+ */
+void verification_suite::add_check(
+    verification_result_t &result, bool ok, const string &description
+) {
+    result.nr_checks++;
+    if(ok) return;
+    if(result.nr_mismatches == 0) result.first_mismatch = description;
+    result.nr_mismatches++;
+}
+
+
+/**
+ * @brief Returns the distance between a point and the closest spot
+ * of a line segment.
+ *
+ * @param p The point.
+ * @param line_p1 Starting point of the line segment.
+ * @param line_p2 Ending point of the line segment.
+ * @return The distance.
+ */
+float verification_suite::get_dist_to_line_seg(
+    const point &p, const point &line_p1, const point &line_p2
+) const {
+    if(line_p1 == line_p2) return dist(p, line_p1).to_float();
+    float ratio = 0.0f;
+    point closest = get_closest_point_in_line_seg(line_p1, line_p2, p, &ratio);
+    if(ratio < 0.0f) closest = line_p1;
+    if(ratio > 1.0f) closest = line_p2;
+    return dist(p, closest).to_float();
+}
+
+
+/**
+ * @brief Returns random settings for following a path. These have random
+ * flags, and sometimes a label or invulnerabilities too, so that
+ * the paths have to deal with different restrictions.
+ *
+ * @return The settings.
+ */
+path_follow_settings verification_suite::get_random_path_settings() const {
+    path_follow_settings settings;
+    
+    const bitmask_8_t flags[] = {
+        PATH_FOLLOW_FLAG_IGNORE_OBSTACLES,
+        PATH_FOLLOW_FLAG_SCRIPT_USE,
+        PATH_FOLLOW_FLAG_LIGHT_LOAD,
+        PATH_FOLLOW_FLAG_AIRBORNE,
+    };
+    for(size_t f = 0; f < 4; f++) {
+        if(randomi(0, 3) == 0) enable_flag(settings.flags, flags[f]);
+    }
+    
+    const vector<path_stop*> &stops = game.cur_area_data->path_stops;
+    if(!stops.empty() && randomi(0, 3) == 0) {
+        settings.label = stops[randomi(0, (int) stops.size() - 1)]->label;
+    }
+    
+    for(auto &h : game.content.hazards.list) {
+        if(randomi(0, 3) == 0) settings.invulnerabilities.push_back(&h.second);
+    }
+    
+    return settings;
+}
+
+
+/**
+ * @brief Returns a random point in the area, or a bit outside of it.
+ *
+ * @return The point.
+ */
+point verification_suite::get_random_point() const {
+    const blockmap &bmap = game.cur_area_data->bmap;
+    point br(
+        bmap.top_left_corner.x +
+        bmap.n_cols * GEOMETRY::BLOCKMAP_BLOCK_SIZE,
+        bmap.top_left_corner.y +
+        bmap.n_rows * GEOMETRY::BLOCKMAP_BLOCK_SIZE
+    );
+    return
+        point(
+            randomf(
+                bmap.top_left_corner.x - VERIFICATION::AREA_MARGIN,
+                br.x + VERIFICATION::AREA_MARGIN
+            ),
+            randomf(
+                bmap.top_left_corner.y - VERIFICATION::AREA_MARGIN,
+                br.y + VERIFICATION::AREA_MARGIN
+            )
+        );
+}
+
+
+/**
+ * @brief Returns the shortest distance between a stop and every other stop,
+ * using Dijkstra's algorithm in its simplest form. It's slow, but
+ * there's little that can go wrong with it.
+ *
+ * @param stop_idx Index of the stop.
+ * @param to_stop If true, the distances are from every other stop to this
+ * one. If false, from this one to every other stop.
+ * @param settings Settings about how the path should be followed.
+ * @param out_dists The distance to or from each stop is returned here.
+ * FLT_MAX if there's no path.
+ */
+void verification_suite::get_reference_path_dists(
+    size_t stop_idx, bool to_stop,
+    const path_follow_settings &settings, vector<float> &out_dists
+) const {
+    const vector<path_stop*> &stops = game.cur_area_data->path_stops;
+    
+    //Index of the stop each link starts on, and the link, for every link
+    //that leads into each stop.
+    vector<vector<std::pair<size_t, path_link*> > > links_into;
+    if(to_stop) {
+        links_into.assign(
+            stops.size(), vector<std::pair<size_t, path_link*> >()
+        );
+        for(size_t s = 0; s < stops.size(); s++) {
+            for(size_t l = 0; l < stops[s]->links.size(); l++) {
+                path_link* l_ptr = stops[s]->links[l];
+                if(l_ptr->end_idx >= stops.size()) continue;
+                links_into[l_ptr->end_idx].push_back(std::make_pair(s, l_ptr));
+            }
+        }
+    }
+    
+    out_dists.assign(stops.size(), FLT_MAX);
+    vector<bool> done(stops.size(), false);
+    out_dists[stop_idx] = 0.0f;
+    
+    while(true) {
+        size_t cur_idx = INVALID;
+        for(size_t s = 0; s < stops.size(); s++) {
+            if(done[s] || out_dists[s] == FLT_MAX) continue;
+            if(cur_idx == INVALID || out_dists[s] < out_dists[cur_idx]) {
+                cur_idx = s;
+            }
+        }
+        if(cur_idx == INVALID) break;
+        done[cur_idx] = true;
+        
+        if(to_stop) {
+            for(size_t l = 0; l < links_into[cur_idx].size(); l++) {
+                size_t other_idx = links_into[cur_idx][l].first;
+                path_link* l_ptr = links_into[cur_idx][l].second;
+                if(!can_traverse_path_link(l_ptr, settings)) continue;
+                out_dists[other_idx] =
+                    std::min(
+                        out_dists[other_idx],
+                        out_dists[cur_idx] + l_ptr->distance
+                    );
+            }
+        } else {
+            for(size_t l = 0; l < stops[cur_idx]->links.size(); l++) {
+                path_link* l_ptr = stops[cur_idx]->links[l];
+                size_t other_idx = l_ptr->end_idx;
+                if(other_idx >= stops.size()) continue;
+                if(!can_traverse_path_link(l_ptr, settings)) continue;
+                out_dists[other_idx] =
+                    std::min(
+                        out_dists[other_idx],
+                        out_dists[cur_idx] + l_ptr->distance
+                    );
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief Returns what a_star() should return for a path search, using
+ * the reference search. Like a_star(), if there's no path, it tries again
+ * while ignoring obstacles.
+ *
+ * @param start_idx Index of the start stop.
+ * @param end_idx Index of the end stop.
+ * @param settings Settings about how the path should be followed.
+ * @param out_settings The settings the path was found with are
+ * returned here.
+ * @param out_dist The path's total distance is returned here. 0 if there's
+ * no path.
+ * @return The result.
+ */
+PATH_RESULT verification_suite::get_reference_path_result(
+    size_t start_idx, size_t end_idx, const path_follow_settings &settings,
+    path_follow_settings &out_settings, float &out_dist
+) const {
+    vector<float> dists;
+    out_settings = settings;
+    get_reference_path_dists(start_idx, false, out_settings, dists);
+    if(dists[end_idx] != FLT_MAX) {
+        out_dist = dists[end_idx];
+        return PATH_RESULT_NORMAL_PATH;
+    }
+    
+    if(!has_flag(settings.flags, PATH_FOLLOW_FLAG_IGNORE_OBSTACLES)) {
+        enable_flag(out_settings.flags, PATH_FOLLOW_FLAG_IGNORE_OBSTACLES);
+        get_reference_path_dists(start_idx, false, out_settings, dists);
+        if(dists[end_idx] != FLT_MAX) {
+            out_dist = dists[end_idx];
+            return PATH_RESULT_PATH_WITH_OBSTACLES;
+        }
+    }
+    
+    out_dist = 0.0f;
+    return PATH_RESULT_END_STOP_UNREACHABLE;
+}
+
+
+/**
+ * @brief Returns whether a list of edges given by a blockmap query is right.
+ * It can't have any edge more than once, and it must have the same edges
+ * as the reference list, in any order.
+ *
+ * @param edges The edges the query gave.
+ * @param reference_edges The edges it should have given.
+ * @param extra_ok If true, the query can also give edges that are not in
+ * the reference list, as long as they're part of the blockmap.
+ * @return Whether it's right.
+ */
+bool verification_suite::is_edge_list_right(
+    const vector<edge*> &edges, const vector<edge*> &reference_edges,
+    bool extra_ok
+) const {
+    vector<edge*> sorted_edges = edges;
+    vector<edge*> sorted_reference = reference_edges;
+    std::sort(sorted_edges.begin(), sorted_edges.end());
+    std::sort(sorted_reference.begin(), sorted_reference.end());
+    if(
+        std::adjacent_find(sorted_edges.begin(), sorted_edges.end()) !=
+        sorted_edges.end()
+    ) {
+        return false;
+    }
+    
+    if(!extra_ok) return sorted_edges == sorted_reference;
+    
+    vector<edge*> all_edges = game.cur_area_data->bmap.edges;
+    std::sort(all_edges.begin(), all_edges.end());
+    return
+        std::includes(
+            sorted_edges.begin(), sorted_edges.end(),
+            sorted_reference.begin(), sorted_reference.end()
+        ) &&
+        std::includes(
+            all_edges.begin(), all_edges.end(),
+            sorted_edges.begin(), sorted_edges.end()
+        );
+}
+
+
+/**
+ * @brief Returns whether a path distance is the same as the reference one,
+ * give or take rounding errors.
+ *
+ * @param dist The distance.
+ * @param reference_dist The reference distance.
+ * @return Whether it's the same.
+ */
+bool verification_suite::is_path_dist_right(
+    float dist, float reference_dist
+) const {
+    return
+        fabs(dist - reference_dist) <=
+        VERIFICATION::DIST_TOLERANCE * std::max(1.0f, reference_dist);
+}
+
+
+/**
+ * @brief Returns whether a path goes from the start stop to the end stop,
+ * only uses links that can be traversed, and is as long as it's
+ * meant to be.
+ *
+ * @param path The stops to visit, in order.
+ * @param start_idx Index of the start stop.
+ * @param end_idx Index of the end stop.
+ * @param settings Settings about how the path should be followed.
+ * @param total_dist Total distance the path is meant to have.
+ * @return Whether it's valid.
+ */
+bool verification_suite::is_path_valid(
+    const vector<path_stop*> &path, size_t start_idx, size_t end_idx,
+    const path_follow_settings &settings, float total_dist
+) const {
+    const vector<path_stop*> &stops = game.cur_area_data->path_stops;
+    if(path.empty()) return false;
+    if(path.front() != stops[start_idx] || path.back() != stops[end_idx]) {
+        return false;
+    }
+    
+    float links_dist = 0.0f;
+    for(size_t s = 0; s + 1 < path.size(); s++) {
+        path_link* l_ptr = path[s]->get_link(path[s + 1]);
+        if(!l_ptr) return false;
+        if(!can_traverse_path_link(l_ptr, settings)) return false;
+        links_dist += l_ptr->distance;
+    }
+    return is_path_dist_right(links_dist, total_dist);
+}
+
+
+/**
+ * @brief Moves the obstacles so that each one blocks a random path link.
+ * The first time, the obstacles are added to the area. They block and
+ * unblock the links through the same code as any other object in gameplay.
+ *
+ * @param out_changed_links If not nullptr, the links that went from blocked
+ * to unblocked, or the other way around, are returned here.
+ */
+void verification_suite::move_obstacles(
+    vector<path_link*>* out_changed_links
+) {
+    const vector<path_stop*> &stops = game.cur_area_data->path_stops;
+    if(out_changed_links) out_changed_links->clear();
+    if(stops.empty()) return;
+    
+    vector<bool> were_blocked;
+    for(size_t s = 0; s < stops.size(); s++) {
+        for(size_t l = 0; l < stops[s]->links.size(); l++) {
+            were_blocked.push_back(stops[s]->links[l]->blocked_by_obstacle);
+        }
+    }
+    
+    if(obstacles.empty()) {
+        auto &types = game.content.mob_types.list.decoration;
+        if(types.empty()) return;
+        for(size_t o = 0; o < VERIFICATION::NR_OBSTACLES; o++) {
+            mob* new_obstacle =
+                create_mob(
+                    game.mob_categories.get(MOB_CATEGORY_DECORATIONS),
+                    stops[0]->pos, types.begin()->second, 0.0f, ""
+                );
+            new_obstacle->radius = VERIFICATION::OBSTACLE_RADIUS;
+            obstacles.push_back(new_obstacle);
+        }
+    }
+    
+    for(size_t o = 0; o < obstacles.size(); o++) {
+        mob* o_ptr = obstacles[o];
+        o_ptr->set_can_block_paths(false);
+        
+        path_stop* s_ptr = stops[randomi(0, (int) stops.size() - 1)];
+        if(s_ptr->links.empty()) continue;
+        path_link* l_ptr =
+            s_ptr->links[randomi(0, (int) s_ptr->links.size() - 1)];
+        o_ptr->pos = (s_ptr->pos + l_ptr->end_ptr->pos) / 2.0f;
+        o_ptr->set_can_block_paths(true);
+    }
+    
+    if(!out_changed_links) return;
+    size_t link_nr = 0;
+    for(size_t s = 0; s < stops.size(); s++) {
+        for(size_t l = 0; l < stops[s]->links.size(); l++) {
+            path_link* l_ptr = stops[s]->links[l];
+            if(l_ptr->blocked_by_obstacle != were_blocked[link_nr]) {
+                out_changed_links->push_back(l_ptr);
+            }
+            link_nr++;
+        }
+    }
+}
+
+
+/**
+ * @brief Loads the area into gameplay, runs every check, and prints
+ * the results.
+ *
+ * @param area_path Path to the area to check.
+ * This is the same as the one used by the "play" auto-start maker tool.
+ * @return 0 if every answer matched, or an error number otherwise.
+ */
+int verification_suite::run(const string &area_path) {
+    results.clear();
+    obstacles.clear();
+    
+    game.states.gameplay->path_of_area_to_load = area_path;
+    game.change_state(game.states.gameplay);
+    if(game.get_cur_state_name() != game.states.gameplay->get_name()) {
+        std::cout <<
+                  "Could not load the area \"" << area_path << "\"!" <<
+                  std::endl;
+        return 1;
+    }
+    
+    verify_blockmap_edges();
+    verify_contracted_graph();
+    verify_flow_fields();
+    verify_landmarks();
+    verify_path_cache();
+    verify_sectors();
+    verify_stop_grid();
+    verify_swept_circles();
+    
+    bool all_ok = true;
+    for(size_t r = 0; r < results.size(); r++) {
+        const verification_result_t &res = results[r];
+        std::cout <<
+                  res.name << ": " << res.nr_checks << " checks, " <<
+                  res.nr_mismatches << " mismatches." << std::endl;
+        if(res.nr_mismatches > 0) {
+            std::cout <<
+                      "  First mismatch: " << res.first_mismatch <<
+                      std::endl;
+            all_ok = false;
+        }
+    }
+    
+    return all_ok ? 0 : 1;
+}
+
+
+/**
+ * @brief Checks that the blockmap's edge queries give the same edges
+ * as checking every edge in the area. Circle and line segment queries
+ * must give exactly the edges that touch the shape, and region queries
+ * must give at least the edges inside the region, since they give every
+ * edge in the blocks the region is in. Some line segments are horizontal,
+ * vertical, or go diagonally through block corners, since those are
+ * the hardest for the line segment query to walk through.
+ */
+void verification_suite::verify_blockmap_edges() {
+    srand(VERIFICATION::RANDOM_SEED);
+    
+    verification_result_t result;
+    result.name = "blockmap_edges";
+    
+    blockmap &bmap = game.cur_area_data->bmap;
+    if(bmap.n_cols == 0 || bmap.n_rows == 0) {
+        results.push_back(result);
+        return;
+    }
+    
+    vector<point> edge_p1s;
+    vector<point> edge_p2s;
+    for(size_t e = 0; e < bmap.edges.size(); e++) {
+        edge* e_ptr = bmap.edges[e];
+        edge_p1s.push_back(
+            point(e_ptr->vertexes[0]->x, e_ptr->vertexes[0]->y)
+        );
+        edge_p2s.push_back(
+            point(e_ptr->vertexes[1]->x, e_ptr->vertexes[1]->y)
+        );
+    }
+    
+    vector<edge*> edges;
+    vector<edge*> reference_edges;
+    for(size_t c = 0; c < VERIFICATION::NR_POINT_CHECKS; c++) {
+        point p = get_random_point();
+        
+        //Circle.
+        float radius = randomf(1.0f, GEOMETRY::BLOCKMAP_BLOCK_SIZE * 2.0f);
+        if(bmap.get_edges_touching_circle(p, radius, edges)) {
+            reference_edges.clear();
+            for(size_t e = 0; e < bmap.edges.size(); e++) {
+                edge* e_ptr = bmap.edges[e];
+                if(
+                    circle_intersects_line_seg(
+                        p, radius, edge_p1s[e], edge_p2s[e]
+                    )
+                ) {
+                    reference_edges.push_back(e_ptr);
+                }
+            }
+            add_check(
+                result, is_edge_list_right(edges, reference_edges, false),
+                "Circle at " + p2s(p) + " with radius " + f2s(radius) +
+                ": expected " + i2s(reference_edges.size()) +
+                " edges, got " + i2s(edges.size()) + "."
+            );
+        }
+        
+        //Line segment.
+        point p1 = p;
+        point p2;
+        float max_offset = GEOMETRY::BLOCKMAP_BLOCK_SIZE * 4.0f;
+        switch(randomi(0, 3)) {
+        case 0: {
+            p2.x = p1.x + randomf(-max_offset, max_offset);
+            p2.y = p1.y + randomf(-max_offset, max_offset);
+            break;
+        } case 1: {
+            p2.x = p1.x + randomf(-max_offset, max_offset);
+            p2.y = p1.y;
+            break;
+        } case 2: {
+            p2.x = p1.x;
+            p2.y = p1.y + randomf(-max_offset, max_offset);
+            break;
+        } case 3: {
+            p1 =
+                bmap.get_top_left_corner(
+                    randomi(0, (int) bmap.n_cols - 1),
+                    randomi(0, (int) bmap.n_rows - 1)
+                );
+            float offset = randomi(1, 4) * GEOMETRY::BLOCKMAP_BLOCK_SIZE;
+            p2 =
+                p1 + point(
+                    randomi(0, 1) == 0 ? offset : -offset,
+                    randomi(0, 1) == 0 ? offset : -offset
+                );
+            break;
+        }
+        }
+        if(bmap.get_edges_crossing_line_seg(p1, p2, edges)) {
+            reference_edges.clear();
+            for(size_t e = 0; e < bmap.edges.size(); e++) {
+                edge* e_ptr = bmap.edges[e];
+                if(
+                    line_segs_intersect(
+                        p1, p2, edge_p1s[e], edge_p2s[e], nullptr, nullptr
+                    )
+                ) {
+                    reference_edges.push_back(e_ptr);
+                }
+            }
+            add_check(
+                result, is_edge_list_right(edges, reference_edges, false),
+                "Line segment from " + p2s(p1) + " to " + p2s(p2) +
+                ": expected " + i2s(reference_edges.size()) +
+                " edges, got " + i2s(edges.size()) + "."
+            );
+        }
+        
+        //Region.
+        point br(
+            p.x + randomf(0.0f, GEOMETRY::BLOCKMAP_BLOCK_SIZE * 2.0f),
+            p.y + randomf(0.0f, GEOMETRY::BLOCKMAP_BLOCK_SIZE * 2.0f)
+        );
+        if(bmap.get_edges_in_region(p, br, edges)) {
+            reference_edges.clear();
+            for(size_t e = 0; e < bmap.edges.size(); e++) {
+                edge* e_ptr = bmap.edges[e];
+                if(
+                    line_seg_intersects_rectangle(
+                        p, br, edge_p1s[e], edge_p2s[e]
+                    )
+                ) {
+                    reference_edges.push_back(e_ptr);
+                }
+            }
+            add_check(
+                result, is_edge_list_right(edges, reference_edges, true),
+                "Region from " + p2s(p) + " to " + p2s(br) +
+                ": expected at least " + i2s(reference_edges.size()) +
+                " edges, got " + i2s(edges.size()) + "."
+            );
+        }
+    }
+    
+    results.push_back(result);
+}
+
+
+/**
+ * @brief Checks that searching for paths on the contracted graph gives
+ * paths as short as the ones on the full graph. The paths can be different,
+ * if there's more than one with the same length.
+ */
+void verification_suite::verify_contracted_graph() {
+    srand(VERIFICATION::RANDOM_SEED);
+    
+    verification_result_t result;
+    result.name = "contracted_graph_paths";
+    
+    const vector<path_stop*> &stops = game.cur_area_data->path_stops;
+    contracted_path_graph &graph =
+        game.states.gameplay->path_mgr.contracted_graph;
+    if(stops.empty() || !graph.is_usable()) {
+        results.push_back(result);
+        return;
+    }
+    
+    vector<float> reference_dists;
+    vector<path_stop*> path;
+    for(size_t r = 0; r < VERIFICATION::NR_CHANGE_ROUNDS; r++) {
+        if(r > 0) move_obstacles();
+        
+        for(size_t s = 0; s < VERIFICATION::PATH_STARTS_PER_ROUND; s++) {
+            size_t start_idx = randomi(0, (int) stops.size() - 1);
+            path_follow_settings settings = get_random_path_settings();
+            get_reference_path_dists(
+                start_idx, false, settings, reference_dists
+            );
+            
+            for(size_t e = 0; e < VERIFICATION::PATH_ENDS_PER_START; e++) {
+                size_t end_idx = randomi(0, (int) stops.size() - 1);
+                float total_dist = 0.0f;
+                bool found =
+                    graph.a_star(
+                        workspace, path, start_idx, end_idx,
+                        settings, &total_dist
+                    );
+                float reference_dist = reference_dists[end_idx];
+                
+                bool ok = found == (reference_dist != FLT_MAX);
+                if(ok && found) {
+                    ok =
+                        is_path_dist_right(total_dist, reference_dist) &&
+                        is_path_valid(
+                            path, start_idx, end_idx, settings, total_dist
+                        );
+                }
+                add_check(
+                    result, ok,
+                    "Stop " + i2s(start_idx) + " to stop " + i2s(end_idx) +
+                    ": expected " +
+                    (
+                        reference_dist == FLT_MAX ?
+                        "no path" : f2s(reference_dist)
+                    ) +
+                    ", got " + (found ? f2s(total_dist) : "no path") + "."
+                );
+            }
+        }
+    }
+    
+    results.push_back(result);
+}
+
+
+/**
+ * @brief Checks that flow fields have the same distances as searching
+ * backwards from their end stop. The check keeps a few flow fields of its
+ * own, built once and then only refreshed with the links that changed
+ * whenever the obstacles move. It also asks the path manager for the same
+ * flow fields, since the path manager refreshes its own after every
+ * single link change. Every stop's path must also be valid.
+ */
+void verification_suite::verify_flow_fields() {
+    srand(VERIFICATION::RANDOM_SEED);
+    
+    verification_result_t result;
+    result.name = "flow_fields";
+    
+    const vector<path_stop*> &stops = game.cur_area_data->path_stops;
+    path_manager &path_mgr = game.states.gameplay->path_mgr;
+    if(stops.empty() || path_mgr.incoming_links.size() != stops.size()) {
+        results.push_back(result);
+        return;
+    }
+    
+    vector<path_flow_field> own_fields;
+    for(size_t f = 0; f < VERIFICATION::NR_FLOW_FIELDS; f++) {
+        path_cache_key key(
+            INVALID, randomi(0, (int) stops.size() - 1),
+            get_random_path_settings()
+        );
+        own_fields.push_back(path_flow_field(key));
+        own_fields.back().build(workspace, path_mgr.incoming_links);
+    }
+    
+    vector<path_link*> changed_links;
+    vector<float> reference_dists;
+    vector<path_stop*> path;
+    for(size_t r = 0; r < VERIFICATION::NR_CHANGE_ROUNDS; r++) {
+        if(r > 0) {
+            move_obstacles(&changed_links);
+            for(size_t f = 0; f < own_fields.size(); f++) {
+                own_fields[f].refresh_links(
+                    workspace, changed_links, path_mgr.incoming_links
+                );
+            }
+        }
+        
+        for(size_t f = 0; f < own_fields.size(); f++) {
+            const path_flow_field &own_field = own_fields[f];
+            size_t end_idx = own_field.key.end_idx;
+            get_reference_path_dists(
+                end_idx, true, own_field.settings, reference_dists
+            );
+            
+            const path_flow_field* mgr_field = nullptr;
+            for(
+                size_t q = 0;
+                q < PATHS::FLOW_FIELD_MIN_REQUESTS && !mgr_field; q++
+            ) {
+                mgr_field = path_mgr.request_flow_field(own_field.key);
+            }
+            
+            for(size_t m = 0; m < 2; m++) {
+                const path_flow_field* field_ptr =
+                    m == 0 ? &own_field : mgr_field;
+                if(!field_ptr) continue;
+                
+                for(size_t s = 0; s < stops.size(); s++) {
+                    float total_dist = 0.0f;
+                    bool found = field_ptr->get_path(s, path, &total_dist);
+                    float reference_dist = reference_dists[s];
+                    
+                    bool ok = found == (reference_dist != FLT_MAX);
+                    if(ok && found) {
+                        ok =
+                            is_path_dist_right(total_dist, reference_dist) &&
+                            is_path_valid(
+                                path, s, end_idx, own_field.settings,
+                                total_dist
+                            );
+                    }
+                    add_check(
+                        result, ok,
+                        "Stop " + i2s(s) + " to stop " + i2s(end_idx) +
+                        ", round " + i2s(r) +
+                        (m == 0 ? "" : ", path manager's field") +
+                        ": expected " +
+                        (
+                            reference_dist == FLT_MAX ?
+                            "no path" : f2s(reference_dist)
+                        ) +
+                        ", got " + (found ? f2s(total_dist) : "no path") +
+                        "."
+                    );
+                }
+            }
+        }
+    }
+    
+    results.push_back(result);
+}
+
+
+/**
+ * @brief Checks that the landmarks never say that a path must be longer
+ * than it really is, since A* would then miss the shortest path, and that
+ * searching on the full graph with them still finds paths as short as
+ * the reference ones.
+ */
+void verification_suite::verify_landmarks() {
+    srand(VERIFICATION::RANDOM_SEED);
+    
+    verification_result_t result;
+    result.name = "landmarks";
+    
+    const vector<path_stop*> &stops = game.cur_area_data->path_stops;
+    const path_landmarks &landmarks =
+        game.states.gameplay->path_mgr.landmarks;
+    if(stops.empty() || !landmarks.is_usable()) {
+        results.push_back(result);
+        return;
+    }
+    
+    vector<float> reference_dists;
+    vector<path_stop*> path;
+    for(size_t r = 0; r < VERIFICATION::NR_CHANGE_ROUNDS; r++) {
+        if(r > 0) move_obstacles();
+        
+        for(size_t s = 0; s < VERIFICATION::PATH_STARTS_PER_ROUND; s++) {
+            size_t start_idx = randomi(0, (int) stops.size() - 1);
+            path_follow_settings settings = get_random_path_settings();
+            get_reference_path_dists(
+                start_idx, false, settings, reference_dists
+            );
+            
+            for(size_t e = 0; e < VERIFICATION::PATH_ENDS_PER_START; e++) {
+                size_t end_idx = randomi(0, (int) stops.size() - 1);
+                float reference_dist = reference_dists[end_idx];
+                
+                if(reference_dist != FLT_MAX) {
+                    float min_dist =
+                        landmarks.get_min_dist(start_idx, end_idx);
+                    add_check(
+                        result,
+                        min_dist <= reference_dist ||
+                        is_path_dist_right(min_dist, reference_dist),
+                        "Stop " + i2s(start_idx) + " to stop " +
+                        i2s(end_idx) + ": the landmarks' minimum is " +
+                        f2s(min_dist) + ", but there's a path with " +
+                        f2s(reference_dist) + "."
+                    );
+                }
+                
+                float total_dist = 0.0f;
+                bool found =
+                    a_star_full_graph(
+                        workspace, path, start_idx, end_idx,
+                        settings, &total_dist
+                    );
+                bool ok = found == (reference_dist != FLT_MAX);
+                if(ok && found) {
+                    ok =
+                        is_path_dist_right(total_dist, reference_dist) &&
+                        is_path_valid(
+                            path, start_idx, end_idx, settings, total_dist
+                        );
+                }
+                add_check(
+                    result, ok,
+                    "Stop " + i2s(start_idx) + " to stop " + i2s(end_idx) +
+                    " on the full graph: expected " +
+                    (
+                        reference_dist == FLT_MAX ?
+                        "no path" : f2s(reference_dist)
+                    ) +
+                    ", got " + (found ? f2s(total_dist) : "no path") + "."
+                );
+            }
+        }
+    }
+    
+    results.push_back(result);
+}
+
+
+/**
+ * @brief Checks that the path cache never hands out a path that's no longer
+ * right. The same searches are done every round, each one twice so that
+ * the second one comes from the cache, and the obstacles move between
+ * rounds, so any result left in the cache from before they moved
+ * gets compared too.
+ */
+void verification_suite::verify_path_cache() {
+    srand(VERIFICATION::RANDOM_SEED);
+    
+    verification_result_t result;
+    result.name = "path_cache";
+    
+    const vector<path_stop*> &stops = game.cur_area_data->path_stops;
+    if(
+        stops.empty() ||
+        !game.states.gameplay->path_mgr.contracted_graph.is_usable()
+    ) {
+        results.push_back(result);
+        return;
+    }
+    
+    vector<size_t> start_idxs;
+    vector<size_t> end_idxs;
+    vector<path_follow_settings> all_settings;
+    for(size_t s = 0; s < VERIFICATION::PATH_STARTS_PER_ROUND; s++) {
+        start_idxs.push_back(randomi(0, (int) stops.size() - 1));
+        end_idxs.push_back(randomi(0, (int) stops.size() - 1));
+        all_settings.push_back(get_random_path_settings());
+    }
+    
+    vector<path_stop*> path;
+    for(size_t r = 0; r < VERIFICATION::NR_CHANGE_ROUNDS; r++) {
+        if(r > 0) move_obstacles();
+        
+        for(size_t s = 0; s < start_idxs.size(); s++) {
+            path_follow_settings reference_settings;
+            float reference_dist = 0.0f;
+            PATH_RESULT reference_result =
+                get_reference_path_result(
+                    start_idxs[s], end_idxs[s], all_settings[s],
+                    reference_settings, reference_dist
+                );
+                
+            for(size_t a = 0; a < 2; a++) {
+                float total_dist = 0.0f;
+                PATH_RESULT res =
+                    a_star(
+                        path, start_idxs[s], end_idxs[s],
+                        all_settings[s], &total_dist
+                    );
+                    
+                bool ok = res == reference_result;
+                if(ok && res != PATH_RESULT_END_STOP_UNREACHABLE) {
+                    ok =
+                        is_path_dist_right(total_dist, reference_dist) &&
+                        is_path_valid(
+                            path, start_idxs[s], end_idxs[s],
+                            reference_settings, total_dist
+                        );
+                }
+                add_check(
+                    result, ok,
+                    "Stop " + i2s(start_idxs[s]) + " to stop " +
+                    i2s(end_idxs[s]) + ", round " + i2s(r) +
+                    (a == 0 ? "" : ", from the cache") + ": expected " +
+                    path_result_to_string(reference_result) + " (" +
+                    f2s(reference_dist) + "), got " +
+                    path_result_to_string(res) + " (" + f2s(total_dist) +
+                    ")."
+                );
+            }
+        }
+    }
+    
+    results.push_back(result);
+}
+
+
+/**
+ * @brief Checks that the blockmap finds the same sector with a triangle hint
+ * as without one, and the same sector as going through every sector in
+ * the area. The points move in small steps, like objects do, so the hint is
+ * usually the right triangle or one beside it, but sometimes they jump
+ * somewhere else, so the hint is far away.
+ */
+void verification_suite::verify_sectors() {
+    srand(VERIFICATION::RANDOM_SEED);
+    
+    verification_result_t result;
+    result.name = "sectors";
+    
+    const blockmap &bmap = game.cur_area_data->bmap;
+    if(bmap.n_cols == 0 || bmap.n_rows == 0) {
+        results.push_back(result);
+        return;
+    }
+    
+    point p;
+    size_t triangle_idx = INVALID;
+    for(size_t c = 0; c < VERIFICATION::NR_POINT_CHECKS; c++) {
+        if(c % VERIFICATION::SECTOR_WALK_STEPS == 0) {
+            p = get_random_point();
+            triangle_idx = INVALID;
+        } else if(randomi(0, 19) == 0) {
+            p = get_random_point();
+        } else {
+            p.x += randomf(-32.0f, 32.0f);
+            p.y += randomf(-32.0f, 32.0f);
+        }
+        
+        size_t hint_idx = triangle_idx;
+        sector* hinted_sector = bmap.get_sector(p, &triangle_idx);
+        sector* blockmap_sector = bmap.get_sector(p);
+        size_t reference_idx = INVALID;
+        sector* reference_sector = get_sector(p, &reference_idx, false);
+        
+        bool ok =
+            hinted_sector == blockmap_sector &&
+            blockmap_sector == reference_sector;
+        if(ok && triangle_idx != INVALID) {
+            ok =
+                triangle_idx < bmap.all_triangles.size() &&
+                bmap.all_triangles[triangle_idx].is_point_inside(p) &&
+                bmap.all_triangles[triangle_idx].sector_ptr == hinted_sector;
+        }
+        add_check(
+            result, ok,
+            "Point " + p2s(p) + ": expected sector " + i2s(reference_idx) +
+            ", got sector " +
+            i2s(game.cur_area_data->find_sector_idx(blockmap_sector)) +
+            " without a hint, and sector " +
+            i2s(game.cur_area_data->find_sector_idx(hinted_sector)) +
+            " with triangle " + i2s(hint_idx) + " as the hint."
+        );
+    }
+    
+    results.push_back(result);
+}
+
+
+/**
+ * @brief Checks that the stop grid finds the same closest stop as going
+ * through every stop, like get_path() used to. Some points are outside
+ * the area, and some checks only allow a few stops, so that the closest
+ * one can be several cells away.
+ */
+void verification_suite::verify_stop_grid() {
+    srand(VERIFICATION::RANDOM_SEED);
+    
+    verification_result_t result;
+    result.name = "stop_grid";
+    
+    const vector<path_stop*> &stops = game.cur_area_data->path_stops;
+    const path_stop_grid &grid = game.states.gameplay->path_mgr.stop_grid;
+    if(stops.empty() || !grid.is_usable()) {
+        results.push_back(result);
+        return;
+    }
+    
+    unordered_set<path_stop*> allowed_stops;
+    auto filter = [&allowed_stops] (path_stop* s_ptr) -> bool {
+        return allowed_stops.find(s_ptr) != allowed_stops.end();
+    };
+    
+    for(size_t c = 0; c < VERIFICATION::NR_POINT_CHECKS; c++) {
+        point p = get_random_point();
+        path_follow_settings settings = get_random_path_settings();
+        size_t stop_step = randomi(0, 1) == 0 ? 1 : randomi(2, 50);
+        allowed_stops.clear();
+        for(size_t s = 0; s < stops.size(); s += stop_step) {
+            if(!can_take_path_stop(stops[s], settings)) continue;
+            allowed_stops.insert(stops[s]);
+        }
+        
+        size_t reference_idx = INVALID;
+        float reference_dist = 0.0f;
+        for(size_t s = 0; s < stops.size(); s++) {
+            if(allowed_stops.find(stops[s]) == allowed_stops.end()) continue;
+            float d =
+                std::max(
+                    0.0f, dist(p, stops[s]->pos).to_float() - stops[s]->radius
+                );
+            if(reference_idx == INVALID || d < reference_dist) {
+                reference_idx = s;
+                reference_dist = d;
+            }
+        }
+        
+        float closest_dist = 0.0f;
+        size_t closest_idx = grid.get_closest_stop(p, filter, &closest_dist);
+        
+        add_check(
+            result,
+            closest_idx == reference_idx && closest_dist == reference_dist,
+            "Point " + p2s(p) + ": expected stop " + i2s(reference_idx) +
+            " (" + f2s(reference_dist) + "), got stop " + i2s(closest_idx) +
+            " (" + f2s(closest_dist) + ")."
+        );
+    }
+    
+    results.push_back(result);
+}
+
+
+/**
+ * @brief Checks that moving circles hit line segments when and only when
+ * a circle moved along the same way, bit by bit, would touch them.
+ * Circles that touch the segment before moving are skipped, since those
+ * follow different rules. Cases that graze the segment are allowed to go
+ * either way, and hits can be a bit earlier or later than the reference,
+ * since the reference only checks a number of spots along the way.
+ */
+void verification_suite::verify_swept_circles() {
+    srand(VERIFICATION::RANDOM_SEED);
+    
+    verification_result_t result;
+    result.name = "swept_circles";
+    
+    const float max_offset = GEOMETRY::BLOCKMAP_BLOCK_SIZE * 2.0f;
+    for(size_t c = 0; c < VERIFICATION::NR_POINT_CHECKS; c++) {
+        point line_p1 = get_random_point();
+        point line_p2 = line_p1;
+        if(randomi(0, 19) != 0) {
+            line_p2.x += randomf(-max_offset, max_offset);
+            line_p2.y += randomf(-max_offset, max_offset);
+        }
+        point circle(
+            line_p1.x + randomf(-max_offset, max_offset),
+            line_p1.y + randomf(-max_offset, max_offset)
+        );
+        float radius = randomf(4.0f, 64.0f);
+        point movement(
+            randomf(-max_offset, max_offset),
+            randomf(-max_offset, max_offset)
+        );
+        
+        if(
+            get_dist_to_line_seg(circle, line_p1, line_p2) <=
+            radius + VERIFICATION::SWEEP_TOLERANCE
+        ) {
+            continue;
+        }
+        
+        float hit_time = 0.0f;
+        bool hit =
+            moving_circle_intersects_line_seg(
+                circle, radius, movement, line_p1, line_p2, &hit_time
+            );
+            
+        //When the circle moved bit by bit first clearly touches.
+        float reference_time = FLT_MAX;
+        for(size_t s = 0; s <= VERIFICATION::SWEEP_SAMPLES; s++) {
+            float t = s / (float) VERIFICATION::SWEEP_SAMPLES;
+            if(
+                get_dist_to_line_seg(circle + movement * t, line_p1, line_p2) <=
+                radius - VERIFICATION::SWEEP_TOLERANCE
+            ) {
+                reference_time = t;
+                break;
+            }
+        }
+        
+        bool ok = false;
+        if(hit) {
+            //It must touch at the hit, and can't be later than the
+            //reference's hit.
+            float movement_dist = dist(point(), movement).to_float();
+            ok =
+                hit_time >= 0.0f && hit_time <= 1.0f &&
+                get_dist_to_line_seg(
+                    circle + movement * hit_time, line_p1, line_p2
+                ) <= radius + VERIFICATION::SWEEP_TOLERANCE &&
+                (
+                    reference_time == FLT_MAX ||
+                    (hit_time - reference_time) * movement_dist <=
+                    VERIFICATION::SWEEP_TOLERANCE
+                );
+        } else {
+            ok = reference_time == FLT_MAX;
+        }
+        
+        add_check(
+            result, ok,
+            "Circle at " + p2s(circle) + " with radius " + f2s(radius) +
+            ", moving " + p2s(movement) + ", against the line segment from " +
+            p2s(line_p1) + " to " + p2s(line_p2) + ": expected " +
+            (
+                reference_time == FLT_MAX ?
+                "no hit" : "a hit by " + f2s(reference_time)
+            ) +
+            ", got " + (hit ? "a hit at " + f2s(hit_time) : "no hit") + "."
+        );
+    }
+    
+    results.push_back(result);
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) Andre 'Espyo' Silva 2013.
+ * The following source file belongs to the open-source project Pikifen.
+ * Please read the included README and LICENSE files for more information.
+ * Pikmin is copyright (c) Nintendo.
+ *
+ * === FILE DESCRIPTION ===
+ * Header for the verification suite class and related functions.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "pathing.h"
+
+
+using std::size_t;
+using std::string;
+using std::vector;
+
+
+class mob;
+struct edge;
+
+
+namespace VERIFICATION {
+extern const float AREA_MARGIN;
+extern const float DIST_TOLERANCE;
+extern const size_t NR_CHANGE_ROUNDS;
+extern const size_t NR_FLOW_FIELDS;
+extern const size_t NR_OBSTACLES;
+extern const size_t NR_POINT_CHECKS;
+extern const float OBSTACLE_RADIUS;
+extern const size_t PATH_ENDS_PER_START;
+extern const size_t PATH_STARTS_PER_ROUND;
+extern const unsigned int RANDOM_SEED;
+extern const size_t SECTOR_WALK_STEPS;
+extern const size_t SWEEP_SAMPLES;
+extern const float SWEEP_TOLERANCE;
+}
+
+
+/**
+ * @brief Results of one of the verification suite's checks.
+ */
+struct verification_result_t {
+
+    //--- Members ---
+    
+    //Name of the check.
+    string name;
+    
+    //How many answers were compared.
+    size_t nr_checks = 0;
+    
+    //How many of those were different from the reference answer.
+    size_t nr_mismatches = 0;
+    
+    //Description of the first mismatch, if any.
+    string first_mismatch;
+    
+};
+
+
+/**
+ * @brief Checks that the engine's faster ways of answering common questions,
+ * like what the shortest path between two stops is, give the same answers
+ * as slow and straightforward ways of answering them. The questions are
+ * random, but the random number generator always starts from the same seed,
+ * so every run on the same area asks the same ones.
+ */
+class verification_suite {
+
+public:
+
+    //--- Function declarations ---
+    
+    int run(const string &area_path);
+    
+private:
+
+    //--- Members ---
+    
+    //Results of the checks that have run so far.
+    vector<verification_result_t> results;
+    
+    //Objects added to the area to block random path links.
+    vector<mob*> obstacles;
+    
+    //Workspace for the path searches.
+    a_star_workspace workspace;
+    
+    
+    //--- Function declarations ---
+    
+    void add_check(
+        verification_result_t &result, bool ok, const string &description
+    );
+    float get_dist_to_line_seg(
+        const point &p, const point &line_p1, const point &line_p2
+    ) const;
+    path_follow_settings get_random_path_settings() const;
+    point get_random_point() const;
+    void get_reference_path_dists(
+        size_t stop_idx, bool to_stop,
+        const path_follow_settings &settings, vector<float> &out_dists
+    ) const;
+    PATH_RESULT get_reference_path_result(
+        size_t start_idx, size_t end_idx,
+        const path_follow_settings &settings,
+        path_follow_settings &out_settings, float &out_dist
+    ) const;
+    bool is_edge_list_right(
+        const vector<edge*> &edges, const vector<edge*> &reference_edges,
+        bool extra_ok
+    ) const;
+    bool is_path_dist_right(float dist, float reference_dist) const;
+    bool is_path_valid(
+        const vector<path_stop*> &path, size_t start_idx, size_t end_idx,
+        const path_follow_settings &settings, float total_dist
+    ) const;
+    void move_obstacles(vector<path_link*>* out_changed_links = nullptr);
+    void verify_blockmap_edges();
+    void verify_contracted_graph();
+    void verify_flow_fields();
+    void verify_landmarks();
+    void verify_path_cache();
+    void verify_sectors();
+    void verify_stop_grid();
+    void verify_swept_circles();
+    
+};